@@ -0,0 +1,47 @@
+#ifndef ABSTRACTATTRACTORSEARCHMONITOR_HPP_
+#define ABSTRACTATTRACTORSEARCHMONITOR_HPP_
+
+/**
+ * The progress of RandomBooleanNetwork::findAttractors().
+ */
+struct AttractorSearchProgress
+{
+    /** The fraction of the state space known to reach the attractors found */
+    double exploredFraction;
+
+    /** The current step j: all the attractors of length < j have been found */
+    unsigned step;
+
+    /** The number of attractors found so far */
+    unsigned attractorsNumber;
+
+    /** The seconds elapsed since the beginning of the search */
+    double elapsedSeconds;
+};
+
+/**
+ * Observer of RandomBooleanNetwork::findAttractors(): it is called at every
+ * step of the search and it can stop it.
+ */
+class AbstractAttractorSearchMonitor
+{
+public:
+
+    /**
+     * Virtual destructor.
+     */
+    virtual ~AbstractAttractorSearchMonitor()
+    {
+    }
+
+    /**
+     * Called at the beginning of every step of the search.
+     *
+     * @param rProgress the progress of the search
+     *
+     * @return false to stop the search; the attractors found so far are kept.
+     */
+    virtual bool reportProgress(const AttractorSearchProgress& rProgress) = 0;
+};
+
+#endif /* ABSTRACTATTRACTORSEARCHMONITOR_HPP_ */
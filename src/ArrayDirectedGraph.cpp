@@ -3,6 +3,7 @@
 #include <cassert>
 #include <math.h>
 #include <iostream>
+#include <limits>
 
 ArrayDirectedGraph::ArrayDirectedGraph(unsigned size) :
 mSize (size)
@@ -328,3 +329,75 @@ void ArrayDirectedGraph::setIncomingVerticesById(
         EXCEPTION("Error, pointer is NULL.");
     mpVertices[node]->setIncomingVerticesId(p_inputs_array, vertices_number);
 }
+
+unsigned ArrayDirectedGraph::getStronglyConnectedComponents(std::vector<unsigned>& rComponents) const
+{
+    /* Tarjan's algorithm visiting the incoming edges: a component is closed
+     * only after all the components feeding it, so ids follow the
+     * topological order of the graph. The recursion is replaced by an
+     * explicit stack of (node, next input position). */
+    const unsigned not_visited = std::numeric_limits<unsigned>::max();
+    std::vector<std::vector<unsigned> > inputs(mSize);
+    for (unsigned node=0; node<mSize; node++)
+    {
+        inputs[node] = mpVertices[node]->getIncomingVerticesId();
+    }
+    std::vector<unsigned> index(mSize, not_visited);
+    std::vector<unsigned> lowlink(mSize, 0);
+    std::vector<bool> on_stack(mSize, false);
+    std::vector<unsigned> stack;
+    std::vector<std::pair<unsigned,unsigned> > call_stack;
+    rComponents.assign(mSize, 0);
+    unsigned time = 0;
+    unsigned components_number = 0;
+
+    for (unsigned root=0; root<mSize; root++)
+    {
+        if (index[root] != not_visited) continue;
+        index[root] = lowlink[root] = time++;
+        stack.push_back(root);
+        on_stack[root] = true;
+        call_stack.push_back(std::pair<unsigned,unsigned>(root, 0));
+        while (!call_stack.empty())
+        {
+            unsigned node = call_stack.back().first;
+            if (call_stack.back().second < inputs[node].size())
+            {
+                unsigned input = inputs[node][call_stack.back().second];
+                call_stack.back().second++;
+                if (index[input] == not_visited)
+                {
+                    index[input] = lowlink[input] = time++;
+                    stack.push_back(input);
+                    on_stack[input] = true;
+                    call_stack.push_back(std::pair<unsigned,unsigned>(input, 0));
+                }
+                else if (on_stack[input] && index[input] < lowlink[node])
+                {
+                    lowlink[node] = index[input];
+                }
+            }
+            else
+            {
+                call_stack.pop_back();
+                if (!call_stack.empty() && lowlink[node] < lowlink[call_stack.back().first])
+                {
+                    lowlink[call_stack.back().first] = lowlink[node];
+                }
+                if (lowlink[node] == index[node])
+                {
+                    unsigned member;
+                    do
+                    {
+                        member = stack.back();
+                        stack.pop_back();
+                        on_stack[member] = false;
+                        rComponents[member] = components_number;
+                    } while (member != node);
+                    components_number++;
+                }
+            }
+        }
+    }
+    return components_number;
+}
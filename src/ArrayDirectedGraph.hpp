@@ -115,6 +115,21 @@ public:
      */
     void setIncomingVerticesById(const unsigned* p_inputs_array,const unsigned vertices_number,const unsigned node);
 
+    /**
+     * Get the strongly connected components of the graph, using an
+     * iterative version of the Tarjan's algorithm (no recursion, so
+     * it does not overflow the stack on large graphs).
+     *
+     * Components are numbered in topological order: if an edge goes
+     * from a node of component a to a node of component b, then a <= b.
+     * So the upstream modules of the graph come first.
+     *
+     * @param rComponents vector filled with the component id of every node
+     *
+     * @return the number of components
+     */
+    unsigned getStronglyConnectedComponents(std::vector<unsigned>& rComponents) const;
+
     /**
      * Save graph in a .gml file.
      *
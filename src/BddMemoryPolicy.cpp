@@ -0,0 +1,223 @@
+#include "BddMemoryPolicy.hpp"
+#include "Exception.hpp"
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <ctime>
+#include <sys/time.h>
+
+/** The size of a node of the BuDDy table in bytes */
+static const double NODE_BYTES = 20.0;
+
+/** The operation caches of BuDDy (apply, ite, quantification, appex, replace, misc) */
+static const double CACHES_NUMBER = 6.0;
+
+/** The size of an entry of an operation cache in bytes */
+static const double CACHE_ENTRY_BYTES = 16.0;
+
+/** The nodes of the table for every node of the functions and of the network */
+static const unsigned long NODES_PER_FUNCTION_NODE = 32;
+
+/** Above this fraction of time in garbage collection the table grows faster */
+static const double HIGH_COLLECTION_FRACTION = 0.25;
+
+/** Below this fraction of time in garbage collection the defaults are restored */
+static const double LOW_COLLECTION_FRACTION = 0.05;
+
+/** The largest maximum increase set by the policy */
+static const int MAXIMUM_MAX_INCREASE = 1 << 24;
+
+/** The largest minimum percentage of free nodes set by the policy */
+static const int MAXIMUM_MIN_FREE_NODES = 60;
+
+/**
+ * @return the wall-clock time, in seconds.
+ */
+static inline double getPolicyClock()
+{
+    timeval time;
+    gettimeofday(&time, NULL);
+    return time.tv_sec + time.tv_usec * 1e-6;
+}
+
+size_t BddMemoryPolicy::mMemoryLimit = 0;
+int BddMemoryPolicy::mCacheRatio = 64;
+int BddMemoryPolicy::mMaxIncrease = BddMemoryPolicy::DEFAULT_MAX_INCREASE;
+int BddMemoryPolicy::mMinFreeNodes = BddMemoryPolicy::DEFAULT_MIN_FREE_NODES;
+unsigned BddMemoryPolicy::mReservedNodes = 0;
+bool BddMemoryPolicy::mNodesLimitReached = false;
+double BddMemoryPolicy::mLastCollectionTime = 0.0;
+bddinthandler BddMemoryPolicy::mpPreviousErrorHandler = NULL;
+
+unsigned BddMemoryPolicy::estimateNodesNumber(unsigned nodes_number, unsigned long function_nodes)
+{
+    unsigned long nodes = NODES_PER_FUNCTION_NODE * (function_nodes + 4ul * nodes_number);
+    nodes = std::min(nodes, (unsigned long) (INT_MAX / 2));
+    return std::max((unsigned) nodes, MINIMUM_NODES);
+}
+
+double BddMemoryPolicy::getBytesPerNode()
+{
+    return NODE_BYTES + CACHES_NUMBER * CACHE_ENTRY_BYTES / mCacheRatio;
+}
+
+unsigned BddMemoryPolicy::getNodesLimit()
+{
+    if (mMemoryLimit == 0)
+    {
+        return 0;
+    }
+    double nodes = mMemoryLimit / getBytesPerNode();
+    return nodes > INT_MAX ? INT_MAX : std::max(1u, (unsigned) nodes);
+}
+
+void BddMemoryPolicy::initialise(unsigned nodes_number)
+{
+    if (!bdd_isrunning())
+    {
+        unsigned nodes_limit = getNodesLimit();
+        if (nodes_limit > 0)
+        {
+            nodes_number = std::min(nodes_number, nodes_limit);
+        }
+        bdd_init(nodes_number, std::max(nodes_number / mCacheRatio, 1u));
+    }
+    apply();
+}
+
+void BddMemoryPolicy::apply()
+{
+    assert(bdd_isrunning());
+    bdd_setcacheratio(mCacheRatio);
+    unsigned nodes_limit = getNodesLimit();
+    if (nodes_limit > 0)
+    {
+        nodes_limit = std::max(nodes_limit, (unsigned) bdd_getallocnum());
+    }
+    bdd_setmaxnodenum(nodes_limit);
+    applyGrowth();
+
+    /* bdd_init() restores the handlers of BuDDy, so they are set again. */
+    bdd_gbc_hook(collectionHandler);
+    bddinthandler p_previous_handler = bdd_error_hook(errorHandler);
+    if (p_previous_handler != errorHandler)
+    {
+        mpPreviousErrorHandler = p_previous_handler;
+    }
+    mLastCollectionTime = getPolicyClock();
+}
+
+void BddMemoryPolicy::applyGrowth()
+{
+    int max_increase = mMaxIncrease;
+    int min_free_nodes = mMinFreeNodes;
+    unsigned allocated_nodes = bdd_getallocnum();
+    if (allocated_nodes < mReservedNodes)
+    {
+        /* Every collection resizes the table until the reserved size. */
+        max_increase = std::max(max_increase, (int) std::min(mReservedNodes - allocated_nodes,
+                (unsigned) MAXIMUM_MAX_INCREASE));
+        min_free_nodes = 100;
+    }
+    bdd_setmaxincrease(max_increase);
+    bdd_setminfreenodes(min_free_nodes);
+}
+
+void BddMemoryPolicy::reserveNodes(unsigned nodes_number)
+{
+    unsigned nodes_limit = getNodesLimit();
+    mReservedNodes = nodes_limit > 0 ? std::min(nodes_number, nodes_limit) : nodes_number;
+    if (bdd_isrunning())
+    {
+        applyGrowth();
+    }
+}
+
+void BddMemoryPolicy::setMemoryLimit(size_t bytes)
+{
+    mMemoryLimit = bytes;
+    if (bdd_isrunning())
+    {
+        apply();
+    }
+}
+
+size_t BddMemoryPolicy::getMemoryLimit()
+{
+    return mMemoryLimit;
+}
+
+void BddMemoryPolicy::setCacheRatio(int ratio)
+{
+    if (ratio <= 0)
+        EXCEPTION("The cache ratio must be > 0.");
+    mCacheRatio = ratio;
+    if (bdd_isrunning())
+    {
+        bdd_setcacheratio(mCacheRatio);
+    }
+}
+
+void BddMemoryPolicy::adaptGrowth(double collection_fraction)
+{
+    assert(collection_fraction >= 0.0 && collection_fraction <= 1.0);
+    if (collection_fraction > HIGH_COLLECTION_FRACTION)
+    {
+        mMaxIncrease = std::min(2 * mMaxIncrease, MAXIMUM_MAX_INCREASE);
+        mMinFreeNodes = std::min(mMinFreeNodes + 10, MAXIMUM_MIN_FREE_NODES);
+    }
+    else if (collection_fraction < LOW_COLLECTION_FRACTION)
+    {
+        mMaxIncrease = std::max(mMaxIncrease / 2, (int) DEFAULT_MAX_INCREASE);
+        mMinFreeNodes = std::max(mMinFreeNodes - 10, (int) DEFAULT_MIN_FREE_NODES);
+    }
+    if (bdd_isrunning())
+    {
+        applyGrowth();
+    }
+}
+
+int BddMemoryPolicy::getMaxIncrease()
+{
+    return mMaxIncrease;
+}
+
+int BddMemoryPolicy::getMinFreeNodes()
+{
+    return mMinFreeNodes;
+}
+
+bool BddMemoryPolicy::isNodesLimitReached()
+{
+    return mNodesLimitReached;
+}
+
+void BddMemoryPolicy::clearNodesLimitReached()
+{
+    mNodesLimitReached = false;
+}
+
+void BddMemoryPolicy::collectionHandler(int pre, bddGbcStat* p_statistics)
+{
+    if (pre)
+    {
+        return;
+    }
+    double now = getPolicyClock();
+    double collection_seconds = p_statistics->time / (double) CLOCKS_PER_SEC;
+    double elapsed_seconds = now - mLastCollectionTime;
+    mLastCollectionTime = now;
+    adaptGrowth(elapsed_seconds > 0.0 ? std::min(collection_seconds / elapsed_seconds, 1.0) : 0.0);
+}
+
+void BddMemoryPolicy::errorHandler(int error)
+{
+    if (error == BDD_NODENUM || error == BDD_MEMORY)
+    {
+        mNodesLimitReached = true;
+    }
+    else if (mpPreviousErrorHandler != NULL)
+    {
+        mpPreviousErrorHandler(error);
+    }
+}
@@ -0,0 +1,180 @@
+#ifndef BDDMEMORYPOLICY_HPP_
+#define BDDMEMORYPOLICY_HPP_
+
+#include <cstddef>
+#include <bdd.h>
+
+/**
+ * The sizing and growth policy of the BuDDy node table.
+ *
+ * The initial table is estimated from the number of nodes of the network
+ * and from the size of their functions, so bdd_init() does not have to be
+ * called by hand. The growth of the table (bdd_setmaxincrease() and
+ * bdd_setminfreenodes()) follows the fraction of time spent in garbage
+ * collection: when it is high the table grows faster, when it is low the
+ * BuDDy defaults are restored. A memory limit caps the table: when it is
+ * full BuDDy does not abort, isNodesLimitReached() becomes true and the
+ * searches of RandomBooleanNetwork stop as if they were cancelled.
+ *
+ * BuDDy is global, and so is the policy: all the members are static.
+ */
+class BddMemoryPolicy
+{
+private:
+
+    /** The memory limit of the node table in bytes (0 means no limit) */
+    static size_t mMemoryLimit;
+
+    /** The ratio between the size of the node table and of the operation caches */
+    static int mCacheRatio;
+
+    /** The current maximum increase of the node table in a resize */
+    static int mMaxIncrease;
+
+    /** The current minimum percentage of free nodes after a garbage collection */
+    static int mMinFreeNodes;
+
+    /** The size of the node table expected by the current network */
+    static unsigned mReservedNodes;
+
+    /** Whether an operation failed because the node table was full */
+    static bool mNodesLimitReached;
+
+    /** The wall-clock time at the end of the last garbage collection, in seconds */
+    static double mLastCollectionTime;
+
+    /** The error handler of BuDDy replaced by the policy */
+    static bddinthandler mpPreviousErrorHandler;
+
+    /**
+     * Garbage collection handler: it adapts the growth of the table.
+     *
+     * @param pre 1 before the collection, 0 after
+     * @param p_statistics the statistics of the collection
+     */
+    static void collectionHandler(int pre, bddGbcStat* p_statistics);
+
+    /**
+     * Error handler: a full node table is recorded, the other errors are
+     * passed to the previous handler.
+     *
+     * @param error the BuDDy error code
+     */
+    static void errorHandler(int error);
+
+    /**
+     * @return the node limit of the memory limit (0 if no limit).
+     */
+    static unsigned getNodesLimit();
+
+    /**
+     * Set the maximum increase and the minimum free nodes of the running
+     * BuDDy, growing the table quickly while it is smaller than the
+     * reserved size.
+     */
+    static void applyGrowth();
+
+public:
+
+    /** The smallest node table (the size used by the tests of this project) */
+    static const unsigned MINIMUM_NODES = 10000;
+
+    /** The maximum increase of BuDDy by default */
+    static const int DEFAULT_MAX_INCREASE = 50000;
+
+    /** The minimum percentage of free nodes of BuDDy by default */
+    static const int DEFAULT_MIN_FREE_NODES = 20;
+
+    /**
+     * Estimate the node table needed by the attractor search of a network:
+     * the transition relation and the sets of states are many times larger
+     * than the functions of the nodes.
+     *
+     * @param nodes_number the number of nodes of the network
+     * @param function_nodes the total number of BDD nodes of the functions
+     *
+     * @return the estimated number of nodes, at least MINIMUM_NODES.
+     */
+    static unsigned estimateNodesNumber(unsigned nodes_number, unsigned long function_nodes);
+
+    /**
+     * @return the memory used by a node of the table, including its share
+     * of the operation caches, in bytes.
+     */
+    static double getBytesPerNode();
+
+    /**
+     * Initialise BuDDy with a table of a given size (bounded by the memory
+     * limit), if it is not running, and apply the policy.
+     *
+     * @param nodes_number the number of nodes of the table
+     */
+    static void initialise(unsigned nodes_number);
+
+    /**
+     * Apply the cache ratio, the memory limit and the growth policy to the
+     * running BuDDy, and install the garbage collection and error handlers.
+     */
+    static void apply();
+
+    /**
+     * Let the table grow up to a given size at the next garbage
+     * collections, instead of collecting repeatedly a table too small.
+     *
+     * @param nodes_number the expected number of nodes
+     */
+    static void reserveNodes(unsigned nodes_number);
+
+    /**
+     * Set the memory limit of the node table. The table is never shrunk,
+     * so a limit smaller than the current table caps it at its size.
+     *
+     * @param bytes the limit in bytes, or 0 for no limit
+     */
+    static void setMemoryLimit(size_t bytes);
+
+    /**
+     * @return the memory limit in bytes (0 means no limit).
+     */
+    static size_t getMemoryLimit();
+
+    /**
+     * Set the ratio between the size of the node table and of the
+     * operation caches.
+     *
+     * @param ratio the ratio (> 0)
+     */
+    static void setCacheRatio(int ratio);
+
+    /**
+     * Adapt the growth of the table to the fraction of time spent in
+     * garbage collection since the previous one.
+     *
+     * @param collection_fraction the fraction, in [0,1]
+     */
+    static void adaptGrowth(double collection_fraction);
+
+    /**
+     * @return the current maximum increase of the table in a resize.
+     */
+    static int getMaxIncrease();
+
+    /**
+     * @return the current minimum percentage of free nodes.
+     */
+    static int getMinFreeNodes();
+
+    /**
+     * @return true if an operation failed because the node table was full
+     * since the last call to clearNodesLimitReached(). The results of the
+     * BDD operations after the failure are not valid.
+     */
+    static bool isNodesLimitReached();
+
+    /**
+     * Forget a failure because of the node table.
+     */
+    static void clearNodesLimitReached();
+};
+
+#endif /* BDDMEMORYPOLICY_HPP_ */
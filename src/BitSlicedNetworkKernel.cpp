@@ -0,0 +1,290 @@
+#include "BitSlicedNetworkKernel.hpp"
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define COGNAC_X86_SIMD
+/** 256-bit block of four words, compiled to AVX2 instructions in updateBlocksAvx2() */
+typedef uint64_t Avx2Block __attribute__((vector_size(32)));
+/** 512-bit block of eight words, compiled to AVX-512 instructions in updateBlocksAvx512() */
+typedef uint64_t Avx512Block __attribute__((vector_size(64)));
+#define COGNAC_ALWAYS_INLINE __attribute__((always_inline))
+#else
+#define COGNAC_ALWAYS_INLINE
+#endif
+
+/**
+ * Evaluate a function on a block of trajectories, expanding its truth
+ * table as a tree of multiplexers: the leaves are the rows of the table,
+ * and the level j selects between rows differing in the j-th input.
+ *
+ * @param p_values the values of the inputs in the block
+ * @param inputs_number the number of inputs (<= MAX_SLICED_INPUTS)
+ * @param p_table the truth table
+ * @param rResult the values of the function in the block
+ */
+template<typename Block>
+inline COGNAC_ALWAYS_INLINE void evaluateSlicedFunction(const Block* p_values, unsigned inputs_number,
+        const uint64_t* p_table, Block& rResult)
+{
+    Block zero;
+    memset(&zero, 0, sizeof(Block));
+    Block ones = ~zero;
+    if (inputs_number == 0)
+    {
+        rResult = (p_table[0] & 1u) ? ones : zero;
+        return;
+    }
+
+    /* The first level muxes two constants, so it is just 0, NOT x, x or 1. */
+    Block level[1u << (BitSlicedNetworkKernel::MAX_SLICED_INPUTS - 1)];
+    unsigned leaves_number = 1u << (inputs_number - 1);
+    for (unsigned i=0; i<leaves_number; i++)
+    {
+        /* bit 0 is the row with the first input off, bit 1 the row with it on */
+        unsigned pair = (unsigned) (p_table[i >> 5] >> ((2*i) & 63)) & 3u;
+        switch (pair)
+        {
+            case 0: level[i] = zero; break;
+            case 1: level[i] = ~p_values[0]; break;
+            case 2: level[i] = p_values[0]; break;
+            default: level[i] = ones;
+        }
+    }
+    for (unsigned j=1; j<inputs_number; j++)
+    {
+        leaves_number >>= 1;
+        for (unsigned i=0; i<leaves_number; i++)
+        {
+            level[i] = level[2*i] ^ (p_values[j] & (level[2*i] ^ level[2*i+1]));
+        }
+    }
+    rResult = level[0];
+}
+
+/**
+ * Apply all the node functions to all the blocks of trajectories. Nodes
+ * with more than MAX_SLICED_INPUTS inputs are skipped.
+ */
+template<typename Block>
+inline COGNAC_ALWAYS_INLINE void updateSlicedBlocks(unsigned nodes_number, const unsigned* p_inputs_offset,
+        const unsigned* p_inputs, const unsigned* p_tables_offset, const uint64_t* p_tables,
+        const uint64_t* p_current, uint64_t* p_next, unsigned words_per_node)
+{
+    const unsigned block_words = sizeof(Block) / sizeof(uint64_t);
+    Block values[BitSlicedNetworkKernel::MAX_SLICED_INPUTS];
+    for (unsigned word=0; word<words_per_node; word+=block_words)
+    {
+        for (unsigned node=0; node<nodes_number; node++)
+        {
+            unsigned inputs_number = p_inputs_offset[node+1] - p_inputs_offset[node];
+            if (inputs_number > BitSlicedNetworkKernel::MAX_SLICED_INPUTS) continue;
+            for (unsigned j=0; j<inputs_number; j++)
+            {
+                memcpy(&values[j], p_current + (size_t) p_inputs[p_inputs_offset[node] + j] * words_per_node + word, sizeof(Block));
+            }
+            Block result;
+            evaluateSlicedFunction<Block>(values, inputs_number, p_tables + p_tables_offset[node], result);
+            memcpy(p_next + (size_t) node * words_per_node + word, &result, sizeof(Block));
+        }
+    }
+}
+
+/** Scalar instantiation of the kernel, 64 trajectories per operation */
+static void updateBlocksScalar(unsigned nodes_number, const unsigned* p_inputs_offset,
+        const unsigned* p_inputs, const unsigned* p_tables_offset, const uint64_t* p_tables,
+        const uint64_t* p_current, uint64_t* p_next, unsigned words_per_node)
+{
+    updateSlicedBlocks<uint64_t>(nodes_number, p_inputs_offset, p_inputs, p_tables_offset, p_tables,
+            p_current, p_next, words_per_node);
+}
+
+#ifdef COGNAC_X86_SIMD
+/** AVX2 instantiation of the kernel, 256 trajectories per operation */
+__attribute__((target("avx2")))
+static void updateBlocksAvx2(unsigned nodes_number, const unsigned* p_inputs_offset,
+        const unsigned* p_inputs, const unsigned* p_tables_offset, const uint64_t* p_tables,
+        const uint64_t* p_current, uint64_t* p_next, unsigned words_per_node)
+{
+    updateSlicedBlocks<Avx2Block>(nodes_number, p_inputs_offset, p_inputs, p_tables_offset, p_tables,
+            p_current, p_next, words_per_node);
+}
+
+/** AVX-512 instantiation of the kernel, 512 trajectories per operation */
+__attribute__((target("avx512f")))
+static void updateBlocksAvx512(unsigned nodes_number, const unsigned* p_inputs_offset,
+        const unsigned* p_inputs, const unsigned* p_tables_offset, const uint64_t* p_tables,
+        const uint64_t* p_current, uint64_t* p_next, unsigned words_per_node)
+{
+    updateSlicedBlocks<Avx512Block>(nodes_number, p_inputs_offset, p_inputs, p_tables_offset, p_tables,
+            p_current, p_next, words_per_node);
+}
+#endif
+
+BitSlicedNetworkKernel::BitSlicedNetworkKernel(const TruthTableNetwork& network) :
+mNodesNumber(network.getNodesNumber()),
+mInstructionSet(getBestInstructionSet())
+{
+    mInputsOffset.push_back(0);
+    mTruthTablesOffset.push_back(0);
+    for (unsigned node=0; node<mNodesNumber; node++)
+    {
+        unsigned inputs_number = network.getInputsNumber(node);
+        mInputs.insert(mInputs.end(), network.getInputs(node), network.getInputs(node) + inputs_number);
+        mInputsOffset.push_back(mInputs.size());
+        unsigned table_words = inputs_number > TruthTableNetwork::MAX_SINGLE_WORD_INPUTS ? 1u << (inputs_number - 6) : 1u;
+        mTruthTables.insert(mTruthTables.end(), network.getTruthTable(node), network.getTruthTable(node) + table_words);
+        mTruthTablesOffset.push_back(mTruthTables.size());
+    }
+    /* Nodes without inputs read no words: keep the pointer valid. */
+    if (mInputs.empty()) mInputs.push_back(0);
+}
+
+void BitSlicedNetworkKernel::update(const uint64_t* p_current, uint64_t* p_next, unsigned words_per_node) const
+{
+    if (words_per_node % BLOCK_WORDS != 0)
+        EXCEPTION("The number of words per node must be a multiple of the block size.");
+    assert(p_current != p_next);
+
+    switch (mInstructionSet)
+    {
+#ifdef COGNAC_X86_SIMD
+        case AVX512:
+            updateBlocksAvx512(mNodesNumber, &mInputsOffset[0], &mInputs[0], &mTruthTablesOffset[0],
+                    &mTruthTables[0], p_current, p_next, words_per_node);
+            break;
+        case AVX2:
+            updateBlocksAvx2(mNodesNumber, &mInputsOffset[0], &mInputs[0], &mTruthTablesOffset[0],
+                    &mTruthTables[0], p_current, p_next, words_per_node);
+            break;
+#endif
+        default:
+            updateBlocksScalar(mNodesNumber, &mInputsOffset[0], &mInputs[0], &mTruthTablesOffset[0],
+                    &mTruthTables[0], p_current, p_next, words_per_node);
+    }
+    updateLargeNodes(p_current, p_next, words_per_node);
+}
+
+void BitSlicedNetworkKernel::updateLargeNodes(const uint64_t* p_current, uint64_t* p_next,
+        unsigned words_per_node) const
+{
+    for (unsigned node=0; node<mNodesNumber; node++)
+    {
+        unsigned inputs_number = mInputsOffset[node+1] - mInputsOffset[node];
+        if (inputs_number <= MAX_SLICED_INPUTS) continue;
+        const unsigned* p_inputs = &mInputs[mInputsOffset[node]];
+        const uint64_t* p_table = &mTruthTables[mTruthTablesOffset[node]];
+        for (unsigned word=0; word<words_per_node; word++)
+        {
+            uint64_t result = 0;
+            for (unsigned bit=0; bit<64; bit++)
+            {
+                unsigned row = 0;
+                for (unsigned j=0; j<inputs_number; j++)
+                {
+                    row |= ((unsigned) (p_current[(size_t) p_inputs[j] * words_per_node + word] >> bit) & 1u) << j;
+                }
+                result |= ((p_table[row >> 6] >> (row & 63)) & 1u) << bit;
+            }
+            p_next[(size_t) node * words_per_node + word] = result;
+        }
+    }
+}
+
+void BitSlicedNetworkKernel::setInstructionSet(InstructionSet instruction_set)
+{
+    if (!isInstructionSetSupported(instruction_set))
+        EXCEPTION("Instruction set " + getInstructionSetName(instruction_set) + " is not supported by this CPU.");
+    mInstructionSet = instruction_set;
+}
+
+BitSlicedNetworkKernel::InstructionSet BitSlicedNetworkKernel::getInstructionSet() const
+{
+    return mInstructionSet;
+}
+
+unsigned BitSlicedNetworkKernel::getNodesNumber() const
+{
+    return mNodesNumber;
+}
+
+bool BitSlicedNetworkKernel::isInstructionSetSupported(InstructionSet instruction_set)
+{
+    switch (instruction_set)
+    {
+        case SCALAR:
+            return true;
+#ifdef COGNAC_X86_SIMD
+        case AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+        case AVX512:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return false;
+    }
+}
+
+BitSlicedNetworkKernel::InstructionSet BitSlicedNetworkKernel::getBestInstructionSet()
+{
+    if (isInstructionSetSupported(AVX512)) return AVX512;
+    if (isInstructionSetSupported(AVX2)) return AVX2;
+    return SCALAR;
+}
+
+std::string BitSlicedNetworkKernel::getInstructionSetName(InstructionSet instruction_set)
+{
+    switch (instruction_set)
+    {
+        case AVX2: return "AVX2";
+        case AVX512: return "AVX-512";
+        default: return "scalar";
+    }
+}
+
+unsigned BitSlicedNetworkKernel::getWordsPerNode(unsigned trajectories_number)
+{
+    unsigned block_trajectories = BLOCK_WORDS * 64;
+    unsigned blocks = (trajectories_number + block_trajectories - 1) / block_trajectories;
+    return std::max(blocks, 1u) * BLOCK_WORDS;
+}
+
+void BitSlicedNetworkKernel::sliceStates(const uint64_t* p_states, unsigned states_number,
+        unsigned words_per_state, unsigned nodes_number, uint64_t* p_sliced, unsigned words_per_node)
+{
+    assert(states_number <= words_per_node * 64);
+    std::fill(p_sliced, p_sliced + (size_t) nodes_number * words_per_node, (uint64_t) 0);
+    for (unsigned state=0; state<states_number; state++)
+    {
+        const uint64_t* p_state = p_states + (size_t) state * words_per_state;
+        uint64_t lane_bit = ((uint64_t) 1) << (state & 63);
+        for (unsigned node=0; node<nodes_number; node++)
+        {
+            if ((p_state[node >> 6] >> (node & 63)) & 1u)
+            {
+                p_sliced[(size_t) node * words_per_node + (state >> 6)] |= lane_bit;
+            }
+        }
+    }
+}
+
+void BitSlicedNetworkKernel::unsliceStates(const uint64_t* p_sliced, unsigned words_per_node,
+        unsigned nodes_number, uint64_t* p_states, unsigned states_number, unsigned words_per_state)
+{
+    assert(states_number <= words_per_node * 64);
+    std::fill(p_states, p_states + (size_t) states_number * words_per_state, (uint64_t) 0);
+    for (unsigned state=0; state<states_number; state++)
+    {
+        uint64_t* p_state = p_states + (size_t) state * words_per_state;
+        for (unsigned node=0; node<nodes_number; node++)
+        {
+            if ((p_sliced[(size_t) node * words_per_node + (state >> 6)] >> (state & 63)) & 1u)
+            {
+                p_state[node >> 6] |= ((uint64_t) 1) << (node & 63);
+            }
+        }
+    }
+}
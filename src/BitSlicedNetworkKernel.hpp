@@ -0,0 +1,164 @@
+#ifndef BITSLICEDNETWORKKERNEL_HPP_
+#define BITSLICEDNETWORKKERNEL_HPP_
+
+#include "TruthTableNetwork.hpp"
+#include "Exception.hpp"
+#include <vector>
+#include <string>
+#include <stdint.h>
+
+/**
+ * Synchronous update of many trajectories of a network at once, using a
+ * bit-sliced layout: every node has words_per_node 64-bit words, and the
+ * bit b of the word w is the value of the node in the trajectory 64*w + b.
+ * So a sliced buffer stores node-major getNodesNumber() * words_per_node
+ * words, and words_per_node must be a multiple of BLOCK_WORDS.
+ *
+ * The function of a node is applied to a whole block of trajectories
+ * with bitwise operations, expanding its truth table as a tree of
+ * multiplexers on the inputs. Blocks are 64 (scalar), 256 (AVX2) or 512
+ * (AVX-512) trajectories wide: the instruction set is chosen at runtime
+ * from the ones supported by the CPU, with a scalar fallback.
+ */
+class BitSlicedNetworkKernel
+{
+public:
+
+    /** Instruction sets of the update kernel */
+    enum InstructionSet
+    {
+        SCALAR,
+        AVX2,
+        AVX512
+    };
+
+    /** Number of words of a block: words_per_node must be a multiple of it */
+    static const unsigned BLOCK_WORDS = 8;
+
+    /**
+     * Maximum number of inputs of a node evaluated with the multiplexer
+     * tree. Nodes with more inputs are evaluated trajectory by trajectory.
+     */
+    static const unsigned MAX_SLICED_INPUTS = 8;
+
+private:
+
+    /** The number of nodes in the network */
+    unsigned mNodesNumber;
+
+    /** Offsets of the inputs of every node in mInputs (size mNodesNumber + 1) */
+    std::vector<unsigned> mInputsOffset;
+
+    /** Inputs of all the nodes, stored contiguously */
+    std::vector<unsigned> mInputs;
+
+    /** Offsets of the truth table of every node in mTruthTables (size mNodesNumber + 1) */
+    std::vector<unsigned> mTruthTablesOffset;
+
+    /** Truth tables of all the nodes, stored contiguously */
+    std::vector<uint64_t> mTruthTables;
+
+    /** Instruction set used by update() */
+    InstructionSet mInstructionSet;
+
+    /**
+     * Update, trajectory by trajectory, the nodes having more than
+     * MAX_SLICED_INPUTS inputs.
+     *
+     * @param p_current the current sliced states
+     * @param p_next the next sliced states
+     * @param words_per_node number of words of every node
+     */
+    void updateLargeNodes(const uint64_t* p_current, uint64_t* p_next, unsigned words_per_node) const;
+
+public:
+
+    /**
+     * Constructor: it copies inputs and truth tables of the network, and
+     * selects the best instruction set supported by the CPU.
+     *
+     * @param network the network in truth-table representation
+     */
+    BitSlicedNetworkKernel(const TruthTableNetwork& network);
+
+    /**
+     * Compute the next state of every trajectory.
+     *
+     * @param p_current the current sliced states
+     * @param p_next the next sliced states (it must not overlap p_current)
+     * @param words_per_node number of words of every node, a multiple of BLOCK_WORDS
+     */
+    void update(const uint64_t* p_current, uint64_t* p_next, unsigned words_per_node) const;
+
+    /**
+     * Set the instruction set used by update().
+     *
+     * @param instruction_set the instruction set, it must be supported by the CPU
+     */
+    void setInstructionSet(InstructionSet instruction_set);
+
+    /**
+     * @return the instruction set used by update().
+     */
+    InstructionSet getInstructionSet() const;
+
+    /**
+     * @return the number of nodes of the network.
+     */
+    unsigned getNodesNumber() const;
+
+    /**
+     * @param instruction_set an instruction set
+     *
+     * @return true if the CPU supports the instruction set.
+     */
+    static bool isInstructionSetSupported(InstructionSet instruction_set);
+
+    /**
+     * @return the widest instruction set supported by the CPU.
+     */
+    static InstructionSet getBestInstructionSet();
+
+    /**
+     * @param instruction_set an instruction set
+     *
+     * @return the name of the instruction set.
+     */
+    static std::string getInstructionSetName(InstructionSet instruction_set);
+
+    /**
+     * @param trajectories_number number of trajectories
+     *
+     * @return the smallest valid words_per_node containing the trajectories.
+     */
+    static unsigned getWordsPerNode(unsigned trajectories_number);
+
+    /**
+     * Convert packed states (see TruthTableNetwork) in sliced states.
+     * Trajectories beyond states_number are set to zero.
+     *
+     * @param p_states states_number packed states of words_per_state words
+     * @param states_number number of states
+     * @param words_per_state number of words of a packed state
+     * @param nodes_number number of nodes of the network
+     * @param p_sliced the sliced states (nodes_number * words_per_node words)
+     * @param words_per_node number of words of every node
+     */
+    static void sliceStates(const uint64_t* p_states, unsigned states_number, unsigned words_per_state,
+            unsigned nodes_number, uint64_t* p_sliced, unsigned words_per_node);
+
+    /**
+     * Convert sliced states in packed states (see TruthTableNetwork).
+     *
+     * @param p_sliced the sliced states (nodes_number * words_per_node words)
+     * @param words_per_node number of words of every node
+     * @param nodes_number number of nodes of the network
+     * @param p_states states_number packed states of words_per_state words
+     * @param states_number number of states
+     * @param words_per_state number of words of a packed state
+     */
+    static void unsliceStates(const uint64_t* p_sliced, unsigned words_per_node, unsigned nodes_number,
+            uint64_t* p_states, unsigned states_number, unsigned words_per_state);
+};
+
+#endif /* BITSLICEDNETWORKKERNEL_HPP_ */
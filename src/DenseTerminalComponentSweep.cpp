@@ -0,0 +1,367 @@
+#include "DenseTerminalComponentSweep.hpp"
+#include <algorithm>
+#include <cstring>
+#include <map>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define COGNAC_X86_SIMD
+/** Four values of a row, compared in maskRowsAvx2() */
+typedef double Avx2Values __attribute__((vector_size(32)));
+/** The result of comparing four values */
+typedef int64_t Avx2Mask __attribute__((vector_size(32)));
+/** 256 bits of a row of a bit matrix, compiled to AVX2 instructions in closeRowsAvx2() */
+typedef uint64_t Avx2Words __attribute__((vector_size(32)));
+#define COGNAC_ALWAYS_INLINE __attribute__((always_inline))
+#else
+#define COGNAC_ALWAYS_INLINE
+#endif
+
+/**
+ * @param word a 64-bit word
+ *
+ * @return the number of bits set in the word.
+ */
+static inline unsigned countBits(uint64_t word)
+{
+#ifdef __GNUC__
+    return __builtin_popcountll(word);
+#else
+    unsigned count = 0;
+    for (; word; count++)
+    {
+        word &= word - 1;
+    }
+    return count;
+#endif
+}
+
+/**
+ * @param word a 64-bit word, not 0
+ *
+ * @return the position of the lowest bit set in the word.
+ */
+static inline unsigned lowestBit(uint64_t word)
+{
+#ifdef __GNUC__
+    return __builtin_ctzll(word);
+#else
+    unsigned position = 0;
+    for (; !(word & 1); position++)
+    {
+        word >>= 1;
+    }
+    return position;
+#endif
+}
+
+/**
+ * Warshall's algorithm: every row which reaches node k gets the row of k.
+ *
+ * @param p_bits the bit matrix, row_words words per row
+ * @param size the number of rows
+ * @param row_words the number of words of a row (a multiple of the block)
+ */
+template<typename Block>
+inline COGNAC_ALWAYS_INLINE void closeSlicedRows(uint64_t* p_bits, unsigned size, unsigned row_words)
+{
+    const unsigned block_words = sizeof(Block) / sizeof(uint64_t);
+    for (unsigned k=0; k<size; k++)
+    {
+        const uint64_t* p_row_k = p_bits + (size_t) k * row_words;
+        uint64_t k_bit = ((uint64_t) 1) << (k & 63);
+        for (unsigned i=0; i<size; i++)
+        {
+            uint64_t* p_row_i = p_bits + (size_t) i * row_words;
+            if (!(p_row_i[k >> 6] & k_bit)) continue;
+            for (unsigned w=0; w<row_words; w+=block_words)
+            {
+                Block row_i;
+                Block row_k;
+                memcpy(&row_i, p_row_i + w, sizeof(Block));
+                memcpy(&row_k, p_row_k + w, sizeof(Block));
+                row_i |= row_k;
+                memcpy(p_row_i + w, &row_i, sizeof(Block));
+            }
+        }
+    }
+}
+
+/** Scalar instantiation of the closure */
+static void closeRowsScalar(uint64_t* p_bits, unsigned size, unsigned row_words)
+{
+    closeSlicedRows<uint64_t>(p_bits, size, row_words);
+}
+
+/**
+ * The bit matrix of the entries > threshold.
+ *
+ * @param p_values the dense matrix, row_stride values per row
+ * @param size the number of rows
+ * @param row_stride the number of values of a row (a multiple of 4)
+ * @param threshold the threshold
+ * @param p_bits the bit matrix (set to 0), row_words words per row
+ * @param row_words the number of words of a row
+ */
+static void maskRowsScalar(const double* p_values, unsigned size, unsigned row_stride, double threshold,
+        uint64_t* p_bits, unsigned row_words)
+{
+    for (unsigned i=0; i<size; i++)
+    {
+        const double* p_row = p_values + (size_t) i * row_stride;
+        uint64_t* p_row_bits = p_bits + (size_t) i * row_words;
+        for (unsigned j=0; j<row_stride; j++)
+        {
+            p_row_bits[j >> 6] |= ((uint64_t) (p_row[j] > threshold)) << (j & 63);
+        }
+    }
+}
+
+#ifdef COGNAC_X86_SIMD
+/** AVX2 instantiation of the closure, 256 bits per operation */
+__attribute__((target("avx2")))
+static void closeRowsAvx2(uint64_t* p_bits, unsigned size, unsigned row_words)
+{
+    closeSlicedRows<Avx2Words>(p_bits, size, row_words);
+}
+
+/** AVX2 version of maskRowsScalar(), four values per comparison */
+__attribute__((target("avx2")))
+static void maskRowsAvx2(const double* p_values, unsigned size, unsigned row_stride, double threshold,
+        uint64_t* p_bits, unsigned row_words)
+{
+    Avx2Values thresholds = {threshold, threshold, threshold, threshold};
+    for (unsigned i=0; i<size; i++)
+    {
+        const double* p_row = p_values + (size_t) i * row_stride;
+        uint64_t* p_row_bits = p_bits + (size_t) i * row_words;
+        for (unsigned j=0; j<row_stride; j+=4)
+        {
+            Avx2Values values;
+            memcpy(&values, p_row + j, sizeof(values));
+            Avx2Mask mask = values > thresholds;
+            uint64_t bits = (uint64_t) ((mask[0] & 1) | (mask[1] & 2) | (mask[2] & 4) | (mask[3] & 8));
+            p_row_bits[j >> 6] |= bits << (j & 63);
+        }
+    }
+}
+
+#endif
+
+bool DenseTerminalComponentSweep::isSuitable(const StochasticMatrix& rMatrix)
+{
+    unsigned size = rMatrix.getSize();
+    return size <= SIZE_LIMIT && rMatrix.getNonZerosNumber() * DENSITY_LIMIT >= size * size;
+}
+
+DenseTerminalComponentSweep::DenseTerminalComponentSweep(const StochasticMatrix& rMatrix) :
+mSize(rMatrix.getSize()),
+mRowStride((mSize + 3) / 4 * 4),
+mRowWords((mSize + 255) / 256 * 4),
+mValues((size_t) mSize * mRowStride, -1.0),
+mThreshold(-1.0),
+mAvx2(false),
+mEdgesNumber(0),
+mEmptyRow(false),
+mGraph((size_t) mSize * mRowWords, 0),
+mReachable((size_t) mSize * mRowWords, 0),
+mReaching((size_t) mSize * mRowWords, 0),
+mTerminalComponentsNumber(0),
+mTerminalNodesNumber(0),
+mTerminalChangesNumber(0)
+{
+#ifdef COGNAC_X86_SIMD
+    __builtin_cpu_init();
+    mAvx2 = __builtin_cpu_supports("avx2");
+#endif
+    const unsigned* p_row_offsets = rMatrix.getRowOffsets();
+    const unsigned* p_columns = rMatrix.getColumns();
+    const double* p_values = rMatrix.getValues();
+    for (unsigned i=0; i<mSize; i++)
+    {
+        for (unsigned entry=p_row_offsets[i]; entry<p_row_offsets[i+1]; entry++)
+        {
+            mValues[(size_t) i * mRowStride + p_columns[entry]] = p_values[entry];
+        }
+    }
+    update();
+}
+
+bool DenseTerminalComponentSweep::isReachable(unsigned node, const uint64_t* p_targets) const
+{
+    std::vector<uint64_t> visited(mRowWords, 0);
+    std::vector<uint64_t> frontier(mRowWords, 0);
+    std::vector<uint64_t> next(mRowWords);
+    visited[node >> 6] = frontier[node >> 6] = ((uint64_t) 1) << (node & 63);
+    while (true)
+    {
+        bool found = true;
+        for (unsigned w=0; w<mRowWords; w++)
+        {
+            found = found && (p_targets[w] & ~visited[w]) == 0;
+        }
+        if (found) return true;
+
+        std::fill(next.begin(), next.end(), (uint64_t) 0);
+        for (unsigned w=0; w<mRowWords; w++)
+        {
+            for (uint64_t word=frontier[w]; word; word &= word - 1)
+            {
+                const uint64_t* p_row = &mGraph[(size_t) (w * 64 + lowestBit(word)) * mRowWords];
+                for (unsigned v=0; v<mRowWords; v++)
+                {
+                    next[v] |= p_row[v];
+                }
+            }
+        }
+        bool empty = true;
+        for (unsigned w=0; w<mRowWords; w++)
+        {
+            frontier[w] = next[w] & ~visited[w];
+            visited[w] |= frontier[w];
+            empty = empty && frontier[w] == 0;
+        }
+        if (empty) return false;
+    }
+}
+
+void DenseTerminalComponentSweep::update()
+{
+    if (mSize == 0) return;
+    std::vector<uint64_t> previous_graph((size_t) mSize * mRowWords, 0);
+    mGraph.swap(previous_graph);
+#ifdef COGNAC_X86_SIMD
+    if (mAvx2) maskRowsAvx2(&mValues[0], mSize, mRowStride, mThreshold, &mGraph[0], mRowWords);
+    else
+#endif
+    maskRowsScalar(&mValues[0], mSize, mRowStride, mThreshold, &mGraph[0], mRowWords);
+
+    mEdgesNumber = 0;
+    mEmptyRow = false;
+    for (unsigned i=0; i<mSize; i++)
+    {
+        const uint64_t* p_row = &mGraph[(size_t) i * mRowWords];
+        unsigned edges_number = 0;
+        for (unsigned w=0; w<mRowWords; w++)
+        {
+            edges_number += countBits(p_row[w]);
+        }
+        mEdgesNumber += edges_number;
+        mEmptyRow = mEmptyRow || edges_number == 0;
+    }
+
+    /* The closure does not change if the nodes of every removed edge are
+     * still joined by a path, which is usual in dense graphs. */
+    if (!mTerminalComponents.empty())
+    {
+        bool same_closure = true;
+        std::vector<uint64_t> removed(mRowWords);
+        for (unsigned i=0; i<mSize && same_closure; i++)
+        {
+            bool any_removed = false;
+            for (unsigned w=0; w<mRowWords; w++)
+            {
+                removed[w] = previous_graph[(size_t) i * mRowWords + w] & ~mGraph[(size_t) i * mRowWords + w];
+                any_removed = any_removed || removed[w] != 0;
+            }
+            same_closure = !any_removed || isReachable(i, &removed[0]);
+        }
+        if (same_closure) return;
+    }
+
+    mReachable = mGraph;
+    std::fill(mReaching.begin(), mReaching.end(), (uint64_t) 0);
+    for (unsigned i=0; i<mSize; i++)
+    {
+        mReachable[(size_t) i * mRowWords + (i >> 6)] |= ((uint64_t) 1) << (i & 63);
+    }
+
+#ifdef COGNAC_X86_SIMD
+    if (mAvx2) closeRowsAvx2(&mReachable[0], mSize, mRowWords);
+    else
+#endif
+    closeRowsScalar(&mReachable[0], mSize, mRowWords);
+
+    for (unsigned i=0; i<mSize; i++)
+    {
+        const uint64_t* p_row = &mReachable[(size_t) i * mRowWords];
+        for (unsigned w=0; w<mRowWords; w++)
+        {
+            for (uint64_t word=p_row[w]; word; word &= word - 1)
+            {
+                unsigned j = w * 64 + lowestBit(word);
+                mReaching[(size_t) j * mRowWords + (i >> 6)] |= ((uint64_t) 1) << (i & 63);
+            }
+        }
+    }
+
+    /* A node is terminal if it reaches only nodes which reach it; its
+     * component is the set of those nodes. */
+    std::vector<unsigned> terminal_components(mSize, mSize);
+    mTerminalComponentsNumber = 0;
+    mTerminalNodesNumber = 0;
+    for (unsigned i=0; i<mSize; i++)
+    {
+        const uint64_t* p_reachable = &mReachable[(size_t) i * mRowWords];
+        const uint64_t* p_reaching = &mReaching[(size_t) i * mRowWords];
+        bool terminal = true;
+        unsigned first = mSize;
+        for (unsigned w=0; w<mRowWords && terminal; w++)
+        {
+            terminal = (p_reachable[w] & ~p_reaching[w]) == 0;
+            if (first == mSize && p_reachable[w] != 0) first = w * 64 + lowestBit(p_reachable[w]);
+        }
+        if (!terminal) continue;
+        terminal_components[i] = first;
+        mTerminalNodesNumber++;
+        if (first == i) mTerminalComponentsNumber++;
+    }
+    if (terminal_components != mTerminalComponents)
+    {
+        if (!mTerminalComponents.empty()) mTerminalChangesNumber++;
+        mTerminalComponents.swap(terminal_components);
+    }
+}
+
+unsigned DenseTerminalComponentSweep::removeEdges(double threshold)
+{
+    if (threshold <= mThreshold) return 0;
+    unsigned edges_number = mEdgesNumber;
+    mThreshold = threshold;
+    update();
+    return edges_number - mEdgesNumber;
+}
+
+bool DenseTerminalComponentSweep::hasEmptyRow() const
+{
+    return mEmptyRow;
+}
+
+unsigned DenseTerminalComponentSweep::getTerminalComponentsNumber() const
+{
+    return mTerminalComponentsNumber;
+}
+
+unsigned DenseTerminalComponentSweep::getTerminalNodesNumber() const
+{
+    return mTerminalNodesNumber;
+}
+
+unsigned DenseTerminalComponentSweep::getTerminalChangesNumber() const
+{
+    return mTerminalChangesNumber;
+}
+
+std::set<std::set<unsigned> > DenseTerminalComponentSweep::getTerminalComponentSets() const
+{
+    std::map<unsigned, std::set<unsigned> > components;
+    for (unsigned i=0; i<mSize; i++)
+    {
+        if (mTerminalComponents[i] < mSize) components[mTerminalComponents[i]].insert(i);
+    }
+    std::set<std::set<unsigned> > terminal_components;
+    for (std::map<unsigned, std::set<unsigned> >::iterator it=components.begin(); it!=components.end(); ++it)
+    {
+        terminal_components.insert(it->second);
+    }
+    return terminal_components;
+}
@@ -0,0 +1,154 @@
+#ifndef DENSETERMINALCOMPONENTSWEEP_HPP_
+#define DENSETERMINALCOMPONENTSWEEP_HPP_
+
+#include <vector>
+#include <set>
+#include <stdint.h>
+#include "StochasticMatrix.hpp"
+
+/**
+ * The terminal components of the pruned matrices of a small ATN at
+ * increasing thresholds, as in TerminalComponentSweep, on a dense copy
+ * of the matrix.
+ *
+ * The matrix is stored row-major with rows padded to a multiple of four
+ * values. At every threshold the graph is a bit matrix, found by
+ * comparing four values at a time (AVX2, if the CPU supports it, with a
+ * scalar fallback), and its transitive closure is computed by Warshall's
+ * algorithm on whole rows of bits. A node is in a terminal component if
+ * every node it reaches reaches it. The closure is not recomputed when
+ * every removed edge is bypassed by a path of the pruned graph.
+ *
+ * As in TerminalComponentSweep, every stored entry is an edge of the
+ * whole graph, 0 included, until a threshold removes it.
+ */
+class DenseTerminalComponentSweep
+{
+public:
+
+    /** The largest ATN for which the dense sweep is used instead of TerminalComponentSweep */
+    static const unsigned SIZE_LIMIT = 128;
+
+    /** The smallest fraction of non-zero entries, as 1/DENSITY_LIMIT, for which the dense sweep is used */
+    static const unsigned DENSITY_LIMIT = 8;
+
+private:
+
+    /** The number of nodes */
+    unsigned mSize;
+
+    /** The number of values in a row of mValues (a multiple of 4) */
+    unsigned mRowStride;
+
+    /** The number of words in a row of a bit matrix (a multiple of 4) */
+    unsigned mRowWords;
+
+    /** The dense matrix, with -1 where no entry is stored and in the padding */
+    std::vector<double> mValues;
+
+    /** The last threshold, or -1 for the whole graph */
+    double mThreshold;
+
+    /** Whether the CPU supports AVX2 */
+    bool mAvx2;
+
+    /** The number of edges of the pruned graph */
+    unsigned mEdgesNumber;
+
+    /** Whether some node has no leaving edges */
+    bool mEmptyRow;
+
+    /** The edges of the pruned graph (a bit matrix) */
+    std::vector<uint64_t> mGraph;
+
+    /** The nodes reached by every node, itself included (a bit matrix) */
+    std::vector<uint64_t> mReachable;
+
+    /** The nodes which reach every node, itself included (a bit matrix) */
+    std::vector<uint64_t> mReaching;
+
+    /** The smallest node of the terminal component of every node, or mSize if it is not terminal */
+    std::vector<unsigned> mTerminalComponents;
+
+    /** The number of terminal components */
+    unsigned mTerminalComponentsNumber;
+
+    /** The number of nodes in terminal components */
+    unsigned mTerminalNodesNumber;
+
+    /** The number of times the terminal components changed */
+    unsigned mTerminalChangesNumber;
+
+    /**
+     * Breadth-first search on the bit matrix of the graph.
+     *
+     * @param node the first node
+     * @param p_targets the nodes to reach (mRowWords words)
+     *
+     * @return true if the node reaches all the targets.
+     */
+    bool isReachable(unsigned node, const uint64_t* p_targets) const;
+
+    /**
+     * Find the graph at mThreshold and, if some removed edge was not
+     * redundant, its closure and the terminal components.
+     */
+    void update();
+
+public:
+
+    /**
+     * @param rMatrix the stochastic matrix
+     *
+     * @return true if the dense sweep is faster than TerminalComponentSweep
+     * for the matrix (at most SIZE_LIMIT rows and a fraction of at least
+     * 1/DENSITY_LIMIT non-zero entries).
+     */
+    static bool isSuitable(const StochasticMatrix& rMatrix);
+
+    /**
+     * Constructor: it finds the terminal components of the whole graph.
+     *
+     * @param rMatrix the stochastic matrix (at most SIZE_LIMIT rows is
+     * advisable, but not required)
+     */
+    DenseTerminalComponentSweep(const StochasticMatrix& rMatrix);
+
+    /**
+     * Remove the edges with weight <= threshold (thresholds must be given
+     * in ascending order) and update the terminal components.
+     *
+     * @param threshold the threshold
+     *
+     * @return the number of edges removed.
+     */
+    unsigned removeEdges(double threshold);
+
+    /**
+     * @return true if some node has no leaving edges.
+     */
+    bool hasEmptyRow() const;
+
+    /**
+     * @return the number of terminal components.
+     */
+    unsigned getTerminalComponentsNumber() const;
+
+    /**
+     * @return the number of nodes which belong to terminal components.
+     */
+    unsigned getTerminalNodesNumber() const;
+
+    /**
+     * @return the number of times the terminal components changed (see
+     * TerminalComponentSweep::getTerminalChangesNumber()).
+     */
+    unsigned getTerminalChangesNumber() const;
+
+    /**
+     * @return the nodes of every terminal component.
+     */
+    std::set<std::set<unsigned> > getTerminalComponentSets() const;
+};
+
+#endif /* DENSETERMINALCOMPONENTSWEEP_HPP_ */
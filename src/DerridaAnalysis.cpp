@@ -0,0 +1,154 @@
+#include "DerridaAnalysis.hpp"
+#include "BitSlicedNetworkKernel.hpp"
+#include "SplitMixRandomGenerator.hpp"
+#include "RandomNumberGenerator.hpp"
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * @param word a 64-bit word
+ *
+ * @return the number of bits set in the word.
+ */
+static inline unsigned countBits(uint64_t word)
+{
+#ifdef __GNUC__
+    return __builtin_popcountll(word);
+#else
+    unsigned count = 0;
+    for (; word; count++)
+    {
+        word &= word - 1;
+    }
+    return count;
+#endif
+}
+
+DerridaAnalysis::DerridaAnalysis(const TruthTableNetwork& rNetwork) :
+mrNetwork(rNetwork)
+{
+}
+
+void DerridaAnalysis::computeDerridaCurve(unsigned max_distance, unsigned pairs_number, uint64_t seed)
+{
+    unsigned nodes_number = mrNetwork.getNodesNumber();
+    if (max_distance > nodes_number)
+        EXCEPTION("The maximum distance must be <= number of nodes.");
+    if (pairs_number == 0)
+        EXCEPTION("The number of pairs must be greater than 0.");
+    if (seed == 0)
+    {
+        seed = (uint64_t) RandomNumberGenerator::Instance()->randMod(4294967295u) + 1;
+    }
+
+    BitSlicedNetworkKernel kernel(mrNetwork);
+    const unsigned words_per_node = BitSlicedNetworkKernel::BLOCK_WORDS;
+    const unsigned batch_pairs = words_per_node * 64;
+    unsigned batches_per_distance = (pairs_number + batch_pairs - 1) / batch_pairs;
+    int jobs_number = (max_distance + 1) * batches_per_distance;
+
+    /* One accumulator per thread: the distances are integers, so the sums
+     * do not depend on how the jobs are split among the threads. */
+    unsigned threads_number = 1;
+#ifdef _OPENMP
+    threads_number = omp_get_max_threads();
+#endif
+    std::vector<std::vector<uint64_t> > thread_distances(threads_number, std::vector<uint64_t>(max_distance + 1, 0));
+
+#ifdef _OPENMP
+    #pragma omp parallel
+#endif
+    {
+        unsigned thread = 0;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+#endif
+        std::vector<uint64_t> first(nodes_number * words_per_node);
+        std::vector<uint64_t> second(nodes_number * words_per_node);
+        std::vector<uint64_t> first_next(nodes_number * words_per_node);
+        std::vector<uint64_t> second_next(nodes_number * words_per_node);
+        std::vector<unsigned> permutation(nodes_number);
+
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic)
+#endif
+        for (int job=0; job<jobs_number; job++)
+        {
+            unsigned distance = job / batches_per_distance;
+            unsigned batch = job % batches_per_distance;
+            unsigned pairs = std::min(batch_pairs, pairs_number - batch * batch_pairs);
+            uint64_t lanes_mask[BitSlicedNetworkKernel::BLOCK_WORDS];
+            for (unsigned w=0; w<words_per_node; w++)
+            {
+                unsigned lanes = pairs > 64 * w ? std::min(pairs - 64 * w, 64u) : 0;
+                lanes_mask[w] = lanes == 64 ? ~((uint64_t) 0) : (((uint64_t) 1) << lanes) - 1;
+            }
+
+            /* The first state is random, the second one differs in
+             * 'distance' nodes chosen by a partial Fisher-Yates shuffle.
+             * Unused lanes are equal in both states. */
+            SplitMixRandomGenerator generator(seed, job);
+            for (unsigned i=0; i<nodes_number; i++)
+            {
+                permutation[i] = i;
+            }
+            for (unsigned i=0; i<first.size(); i++)
+            {
+                first[i] = generator.next() & lanes_mask[i % words_per_node];
+            }
+            second = first;
+            for (unsigned lane=0; lane<pairs; lane++)
+            {
+                for (unsigned k=0; k<distance; k++)
+                {
+                    std::swap(permutation[k], permutation[k + generator.randMod(nodes_number - k)]);
+                    second[permutation[k] * words_per_node + (lane >> 6)] ^= ((uint64_t) 1) << (lane & 63);
+                }
+            }
+
+            kernel.update(&first[0], &first_next[0], words_per_node);
+            kernel.update(&second[0], &second_next[0], words_per_node);
+            uint64_t next_distance = 0;
+            for (unsigned i=0; i<first_next.size(); i++)
+            {
+                next_distance += countBits(first_next[i] ^ second_next[i]);
+            }
+            thread_distances[thread][distance] += next_distance;
+        }
+    }
+
+    mDerridaCurve.assign(max_distance + 1, 0.0);
+    for (unsigned distance=0; distance<=max_distance; distance++)
+    {
+        uint64_t total_distance = 0;
+        for (unsigned thread=0; thread<threads_number; thread++)
+        {
+            total_distance += thread_distances[thread][distance];
+        }
+        mDerridaCurve[distance] = (double) total_distance / pairs_number;
+    }
+}
+
+const std::vector<double>& DerridaAnalysis::getDerridaCurve() const
+{
+    return mDerridaCurve;
+}
+
+double DerridaAnalysis::getDerridaCoefficient() const
+{
+    if (mDerridaCurve.size() < 2)
+        EXCEPTION("The Derrida curve must be computed up to distance 1.");
+    return mDerridaCurve[1];
+}
+
+double DerridaAnalysis::computeAverageSensitivity() const
+{
+    double sensitivity = 0.0;
+    for (unsigned node=0; node<mrNetwork.getNodesNumber(); node++)
+    {
+        sensitivity += mrNetwork.getNodeSensitivity(node);
+    }
+    return sensitivity / mrNetwork.getNodesNumber();
+}
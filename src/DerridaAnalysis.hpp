@@ -0,0 +1,70 @@
+#ifndef DERRIDAANALYSIS_HPP_
+#define DERRIDAANALYSIS_HPP_
+
+#include "TruthTableNetwork.hpp"
+#include "Exception.hpp"
+#include <vector>
+#include <stdint.h>
+
+/**
+ * Dynamical regime of a synchronous network (ordered, critical or chaotic)
+ * by means of the Derrida map and of the average sensitivity.
+ *
+ * The Derrida map gives, for every Hamming distance d, the mean distance
+ * after one step between two random states at distance d. Pairs are
+ * advanced with the bit-sliced kernel, 512 of them at a time, and the work
+ * is distributed among the threads with an accumulator per thread. The
+ * slope of the map in d = 1 is about the average sensitivity: less than 1
+ * in the ordered regime, 1 at criticality, greater than 1 in the chaotic one.
+ */
+class DerridaAnalysis
+{
+private:
+
+    /** The network */
+    const TruthTableNetwork& mrNetwork;
+
+    /** The i-th entry is the mean next-step distance of pairs at distance i */
+    std::vector<double> mDerridaCurve;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rNetwork the network (it must live as long as this object)
+     */
+    DerridaAnalysis(const TruthTableNetwork& rNetwork);
+
+    /**
+     * Compute the Derrida map sampling random pairs of states.
+     *
+     * @param max_distance largest Hamming distance (<= number of nodes)
+     * @param pairs_number number of pairs sampled for every distance
+     * @param seed seed of the pairs; with the same seed the result does not
+     * depend on the number of threads. If 0, the seed is drawn from the
+     * RandomNumberGenerator.
+     */
+    void computeDerridaCurve(unsigned max_distance, unsigned pairs_number, uint64_t seed = 0);
+
+    /**
+     * @return the Derrida map: the i-th entry is the mean distance after one
+     * step of pairs of states at distance i.
+     */
+    const std::vector<double>& getDerridaCurve() const;
+
+    /**
+     * @return the Derrida coefficient, i.e. the mean next-step distance of
+     * pairs at distance 1.
+     */
+    double getDerridaCoefficient() const;
+
+    /**
+     * Compute the average sensitivity directly from the truth tables.
+     *
+     * @return the mean sensitivity of the nodes.
+     */
+    double computeAverageSensitivity() const;
+};
+
+#endif /* DERRIDAANALYSIS_HPP_ */
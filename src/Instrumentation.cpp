@@ -0,0 +1,363 @@
+#include "Instrumentation.hpp"
+#include "OutputFileHandler.hpp"
+#include "Exception.hpp"
+#include <map>
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <sys/time.h>
+#include <bdd.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * A snapshot of the counters and of the BuDDy statistics.
+ */
+struct InstrumentationSnapshot
+{
+    /** The time in microseconds */
+    double microseconds;
+
+    /** The counters */
+    std::vector<unsigned long> counters;
+
+    /** The BDD nodes produced */
+    long bddNodesProduced;
+
+    /** The garbage collections */
+    long bddGarbageCollections;
+
+    /** The hits in the operation caches */
+    unsigned long bddCacheHits;
+
+    /** The misses in the operation caches */
+    unsigned long bddCacheMisses;
+
+    /** The BDD nodes in use */
+    long bddNodesInUse;
+};
+
+/**
+ * A call of a phase, for the Chrome trace.
+ */
+struct PhaseCall
+{
+    /** The index of the phase */
+    unsigned phase;
+
+    /** The beginning of the call, in microseconds from the first call */
+    double begin;
+
+    /** The duration of the call, in microseconds */
+    double duration;
+
+    /** The statistics of the call (calls and seconds are not used) */
+    PhaseStatistics statistics;
+};
+
+/**
+ * Take a snapshot of the counters and of BuDDy.
+ *
+ * @param rSnapshot the snapshot
+ */
+void takeSnapshot(InstrumentationSnapshot& rSnapshot);
+
+/**
+ * Write a string as a JSON string literal.
+ *
+ * @param rStream the output stream
+ * @param rString the string
+ */
+void writeJsonString(std::ostream& rStream, const std::string& rString);
+
+/**
+ * Write the statistics of a phase (except the name) as JSON members.
+ *
+ * @param rStream the output stream
+ * @param rStatistics the statistics
+ */
+void writeJsonStatistics(std::ostream& rStream, const PhaseStatistics& rStatistics);
+
+bool Instrumentation::mEnabled = false;
+
+/** The counters, incremented atomically */
+static unsigned long gCounters[Instrumentation::COUNTERS_NUMBER] = {0};
+
+/** The statistics of the phases, in order of first call */
+static std::vector<PhaseStatistics> gPhases;
+
+/** The index of every phase in gPhases */
+static std::map<std::string, unsigned> gPhaseIndex;
+
+/** The calls of the phases, in order of end */
+static std::vector<PhaseCall> gPhaseCalls;
+
+/** The open phases, with their snapshots */
+static std::vector<std::pair<unsigned, InstrumentationSnapshot> > gOpenPhases;
+
+/** The time of the first call, in microseconds */
+static double gOriginMicroseconds = -1.0;
+
+void Instrumentation::enable()
+{
+    mEnabled = true;
+}
+
+void Instrumentation::disable()
+{
+    mEnabled = false;
+}
+
+void Instrumentation::reset()
+{
+    if (!gOpenPhases.empty())
+        EXCEPTION("The statistics cannot be reset while a phase is open.");
+    std::fill(gCounters, gCounters + COUNTERS_NUMBER, 0ul);
+    gPhases.clear();
+    gPhaseIndex.clear();
+    gPhaseCalls.clear();
+    gOriginMicroseconds = -1.0;
+}
+
+void Instrumentation::addToCounter(Counter counter, unsigned long amount)
+{
+    assert(counter < COUNTERS_NUMBER);
+#ifdef _OPENMP
+    #pragma omp atomic
+#endif
+    gCounters[counter] += amount;
+}
+
+bool Instrumentation::beginPhase(const std::string& name)
+{
+    if (!isEnabled()) return false;
+#ifdef _OPENMP
+    if (omp_in_parallel()) return false;
+#endif
+    std::map<std::string, unsigned>::iterator it = gPhaseIndex.find(name);
+    if (it == gPhaseIndex.end())
+    {
+        PhaseStatistics statistics;
+        statistics.name = name;
+        statistics.calls = 0;
+        statistics.seconds = 0.0;
+        statistics.counters.assign(COUNTERS_NUMBER, 0ul);
+        statistics.bddNodesProduced = 0;
+        statistics.bddGarbageCollections = 0;
+        statistics.bddCacheHits = 0;
+        statistics.bddCacheMisses = 0;
+        statistics.bddNodesInUse = 0;
+        it = gPhaseIndex.insert(std::make_pair(name, (unsigned) gPhases.size())).first;
+        gPhases.push_back(statistics);
+    }
+    gOpenPhases.push_back(std::make_pair(it->second, InstrumentationSnapshot()));
+    takeSnapshot(gOpenPhases.back().second);
+    if (gOriginMicroseconds < 0.0)
+    {
+        gOriginMicroseconds = gOpenPhases.back().second.microseconds;
+    }
+    return true;
+}
+
+void Instrumentation::endPhase()
+{
+    if (gOpenPhases.empty()) return;
+    InstrumentationSnapshot end;
+    takeSnapshot(end);
+    const InstrumentationSnapshot& r_begin = gOpenPhases.back().second;
+
+    /* BuDDy may have been restarted during the phase: differences are clamped to 0. */
+    PhaseCall call;
+    call.phase = gOpenPhases.back().first;
+    call.begin = r_begin.microseconds - gOriginMicroseconds;
+    call.duration = end.microseconds - r_begin.microseconds;
+    call.statistics.counters.resize(COUNTERS_NUMBER);
+    for (unsigned i=0; i<COUNTERS_NUMBER; i++)
+    {
+        call.statistics.counters[i] = end.counters[i] - r_begin.counters[i];
+    }
+    call.statistics.bddNodesProduced = std::max(0l, end.bddNodesProduced - r_begin.bddNodesProduced);
+    call.statistics.bddGarbageCollections = std::max(0l, end.bddGarbageCollections - r_begin.bddGarbageCollections);
+    call.statistics.bddCacheHits = end.bddCacheHits >= r_begin.bddCacheHits ? end.bddCacheHits - r_begin.bddCacheHits : 0;
+    call.statistics.bddCacheMisses = end.bddCacheMisses >= r_begin.bddCacheMisses ? end.bddCacheMisses - r_begin.bddCacheMisses : 0;
+    call.statistics.bddNodesInUse = end.bddNodesInUse;
+    gOpenPhases.pop_back();
+
+    PhaseStatistics& r_phase = gPhases[call.phase];
+    r_phase.calls++;
+    r_phase.seconds += call.duration * 1e-6;
+    for (unsigned i=0; i<COUNTERS_NUMBER; i++)
+    {
+        r_phase.counters[i] += call.statistics.counters[i];
+    }
+    r_phase.bddNodesProduced += call.statistics.bddNodesProduced;
+    r_phase.bddGarbageCollections += call.statistics.bddGarbageCollections;
+    r_phase.bddCacheHits += call.statistics.bddCacheHits;
+    r_phase.bddCacheMisses += call.statistics.bddCacheMisses;
+    r_phase.bddNodesInUse = std::max(r_phase.bddNodesInUse, call.statistics.bddNodesInUse);
+    gPhaseCalls.push_back(call);
+}
+
+const char* Instrumentation::getCounterName(Counter counter)
+{
+    switch (counter)
+    {
+        case IMAGES:
+            return "images";
+        case PREIMAGES:
+            return "preimages";
+        case FUNCTION_COMPOSITIONS:
+            return "function_compositions";
+        case LINEAR_SOLVES:
+            return "linear_solves";
+        default:
+            EXCEPTION("Unknown counter.");
+    }
+}
+
+const std::vector<PhaseStatistics>& Instrumentation::getPhases()
+{
+    return gPhases;
+}
+
+const PhaseStatistics* Instrumentation::getPhase(const std::string& name)
+{
+    std::map<std::string, unsigned>::const_iterator it = gPhaseIndex.find(name);
+    if (it == gPhaseIndex.end())
+    {
+        return NULL;
+    }
+    return &gPhases[it->second];
+}
+
+void Instrumentation::writeJson(std::ostream& rStream)
+{
+    std::streamsize precision = rStream.precision(17);
+    rStream << "{\n  \"phases\": [";
+    for (unsigned i=0; i<gPhases.size(); i++)
+    {
+        rStream << (i > 0 ? ",\n" : "\n") << "    {\"name\": ";
+        writeJsonString(rStream, gPhases[i].name);
+        rStream << ", \"calls\": " << gPhases[i].calls << ", \"seconds\": " << gPhases[i].seconds << ", ";
+        writeJsonStatistics(rStream, gPhases[i]);
+        rStream << "}";
+    }
+    rStream << "\n  ]\n}\n";
+    rStream.precision(precision);
+}
+
+void Instrumentation::writeChromeTrace(std::ostream& rStream)
+{
+    /* The default 6 digits would round the timestamps of a run longer
+     * than a second, so that distinct events get the same time. */
+    std::streamsize precision = rStream.precision(17);
+    rStream << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    for (unsigned i=0; i<gPhaseCalls.size(); i++)
+    {
+        rStream << (i > 0 ? ",\n" : "\n") << "  {\"name\": ";
+        writeJsonString(rStream, gPhases[gPhaseCalls[i].phase].name);
+        rStream << ", \"cat\": \"CoGNaC\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1"
+                << ", \"ts\": " << gPhaseCalls[i].begin << ", \"dur\": " << gPhaseCalls[i].duration
+                << ", \"args\": {";
+        writeJsonStatistics(rStream, gPhaseCalls[i].statistics);
+        rStream << "}}";
+    }
+    rStream << "\n]}\n";
+    rStream.precision(precision);
+}
+
+void Instrumentation::printJsonToFile(const std::string directory, const std::string filename)
+{
+    if (directory.empty())
+        EXCEPTION("Directory name not valid.");
+
+    OutputFileHandler handler(directory,false);
+    out_stream p_file = handler.OpenOutputFile(filename);
+    writeJson(*p_file);
+    p_file->close();
+}
+
+void Instrumentation::printChromeTraceToFile(const std::string directory, const std::string filename)
+{
+    if (directory.empty())
+        EXCEPTION("Directory name not valid.");
+
+    OutputFileHandler handler(directory,false);
+    out_stream p_file = handler.OpenOutputFile(filename);
+    writeChromeTrace(*p_file);
+    p_file->close();
+}
+
+void takeSnapshot(InstrumentationSnapshot& rSnapshot)
+{
+    timeval time;
+    gettimeofday(&time, NULL);
+    rSnapshot.microseconds = time.tv_sec * 1e6 + time.tv_usec;
+    rSnapshot.counters.assign(gCounters, gCounters + Instrumentation::COUNTERS_NUMBER);
+    rSnapshot.bddNodesProduced = 0;
+    rSnapshot.bddGarbageCollections = 0;
+    rSnapshot.bddCacheHits = 0;
+    rSnapshot.bddCacheMisses = 0;
+    rSnapshot.bddNodesInUse = 0;
+    if (bdd_isrunning())
+    {
+        bddStat statistics;
+        bdd_stats(&statistics);
+        rSnapshot.bddNodesProduced = statistics.produced;
+        rSnapshot.bddGarbageCollections = statistics.gbcnum;
+        rSnapshot.bddNodesInUse = statistics.nodenum - statistics.freenodes;
+        bddCacheStat cache_statistics;
+        bdd_cachestats(&cache_statistics);
+        rSnapshot.bddCacheHits = cache_statistics.opHit;
+        rSnapshot.bddCacheMisses = cache_statistics.opMiss;
+    }
+}
+
+void writeJsonString(std::ostream& rStream, const std::string& rString)
+{
+    rStream << "\"";
+    for (unsigned i=0; i<rString.size(); i++)
+    {
+        unsigned char character = rString[i];
+        if (character == '"' || character == '\\')
+        {
+            rStream << "\\" << rString[i];
+        }
+        else if (character < 0x20)
+        {
+            char buffer[8];
+            sprintf(buffer, "\\u%04x", character);
+            rStream << buffer;
+        }
+        else
+        {
+            rStream << rString[i];
+        }
+    }
+    rStream << "\"";
+}
+
+void writeJsonStatistics(std::ostream& rStream, const PhaseStatistics& rStatistics)
+{
+    for (unsigned i=0; i<Instrumentation::COUNTERS_NUMBER; i++)
+    {
+        rStream << "\"" << Instrumentation::getCounterName((Instrumentation::Counter) i) << "\": "
+                << rStatistics.counters[i] << ", ";
+    }
+    unsigned long cache_accesses = rStatistics.bddCacheHits + rStatistics.bddCacheMisses;
+    rStream << "\"bdd_nodes_produced\": " << rStatistics.bddNodesProduced
+            << ", \"bdd_garbage_collections\": " << rStatistics.bddGarbageCollections
+            << ", \"bdd_nodes_in_use\": " << rStatistics.bddNodesInUse
+            << ", \"bdd_cache_hits\": " << rStatistics.bddCacheHits
+            << ", \"bdd_cache_misses\": " << rStatistics.bddCacheMisses
+            << ", \"bdd_cache_hit_rate\": ";
+    if (cache_accesses > 0)
+    {
+        rStream << (double) rStatistics.bddCacheHits / cache_accesses;
+    }
+    else
+    {
+        rStream << "null";
+    }
+}
@@ -0,0 +1,233 @@
+#ifndef INSTRUMENTATION_HPP_
+#define INSTRUMENTATION_HPP_
+
+#include <vector>
+#include <string>
+#include <ostream>
+
+/**
+ * The statistics of a phase (e.g. findAttractors), summed over all its calls.
+ * Nested phases are included in the statistics of the enclosing ones.
+ */
+struct PhaseStatistics
+{
+    /** The name of the phase */
+    std::string name;
+
+    /** The number of times the phase was run */
+    unsigned calls;
+
+    /** The wall-clock time, in seconds */
+    double seconds;
+
+    /** The values of the counters of Instrumentation::Counter */
+    std::vector<unsigned long> counters;
+
+    /** The number of BDD nodes produced (BuDDy statistics) */
+    long bddNodesProduced;
+
+    /** The number of garbage collections of the BDD node table */
+    long bddGarbageCollections;
+
+    /** The hits in the BDD operation caches (BuDDy must be compiled with CACHESTATS) */
+    unsigned long bddCacheHits;
+
+    /** The misses in the BDD operation caches (BuDDy must be compiled with CACHESTATS) */
+    unsigned long bddCacheMisses;
+
+    /** The largest number of BDD nodes in use at the end of a call */
+    long bddNodesInUse;
+};
+
+/**
+ * Lightweight instrumentation: scoped timers aggregated per phase, the
+ * counters of Instrumentation::Counter and the node, garbage collection
+ * and cache statistics of BuDDy, exported as JSON or in the Chrome trace
+ * format (chrome://tracing, Perfetto).
+ *
+ * It is disabled by default. When disabled, a phase or a counter costs a
+ * test of a static flag; if COGNAC_NO_INSTRUMENTATION is defined at
+ * compile time isEnabled() is constant and the instrumentation is removed.
+ * Phases must be opened and closed by the master thread, counters can be
+ * incremented by any thread.
+ */
+class Instrumentation
+{
+public:
+
+    /** The counters */
+    enum Counter
+    {
+        /** Images (forward steps) of sets of states */
+        IMAGES,
+        /** Preimages (backward steps) of sets of states */
+        PREIMAGES,
+        /** Compositions of the transition function with itself */
+        FUNCTION_COMPOSITIONS,
+        /** Linear systems solved for stationary distributions */
+        LINEAR_SOLVES,
+        /** The number of counters */
+        COUNTERS_NUMBER
+    };
+
+private:
+
+    /** Whether the instrumentation is enabled */
+    static bool mEnabled;
+
+    /**
+     * Increment a counter.
+     *
+     * @param counter the counter
+     * @param amount the increment
+     */
+    static void addToCounter(Counter counter, unsigned long amount);
+
+public:
+
+    /**
+     * Start collecting statistics.
+     */
+    static void enable();
+
+    /**
+     * Stop collecting statistics (the ones collected are kept).
+     */
+    static void disable();
+
+    /**
+     * @return true if the instrumentation is enabled.
+     */
+    static bool isEnabled()
+    {
+#ifdef COGNAC_NO_INSTRUMENTATION
+        return false;
+#else
+        return mEnabled;
+#endif
+    }
+
+    /**
+     * Discard all the statistics collected. No phase can be open.
+     */
+    static void reset();
+
+    /**
+     * Open a phase; phases can be nested. Prefer ScopedPhase.
+     *
+     * @param name the name of the phase
+     *
+     * @return false if the phase was not opened (disabled, or called by a
+     * thread in a parallel region).
+     */
+    static bool beginPhase(const std::string& name);
+
+    /**
+     * Close the last phase opened.
+     */
+    static void endPhase();
+
+    /**
+     * Increment a counter, if the instrumentation is enabled.
+     *
+     * @param counter the counter
+     * @param amount the increment
+     */
+    static void increment(Counter counter, unsigned long amount = 1)
+    {
+        if (isEnabled())
+        {
+            addToCounter(counter, amount);
+        }
+    }
+
+    /**
+     * @param counter the counter
+     *
+     * @return the name of the counter, as used in the exported files.
+     */
+    static const char* getCounterName(Counter counter);
+
+    /**
+     * @return the statistics of the phases, in order of first call.
+     */
+    static const std::vector<PhaseStatistics>& getPhases();
+
+    /**
+     * @param name the name of a phase
+     *
+     * @return the statistics of the phase, or NULL if it was never run.
+     */
+    static const PhaseStatistics* getPhase(const std::string& name);
+
+    /**
+     * Write the statistics of the phases as a JSON object.
+     *
+     * @param rStream the output stream
+     */
+    static void writeJson(std::ostream& rStream);
+
+    /**
+     * Write every call of every phase as a complete event of the Chrome
+     * trace format, with the counters as arguments.
+     *
+     * @param rStream the output stream
+     */
+    static void writeChromeTrace(std::ostream& rStream);
+
+    /**
+     * Save the statistics of the phases to a JSON file.
+     *
+     * @param directory the name of the subfolder of testoutput.
+     * @param filename the name of the output file.
+     */
+    static void printJsonToFile(const std::string directory, const std::string filename);
+
+    /**
+     * Save the trace of the phases to a file in the Chrome trace format.
+     *
+     * @param directory the name of the subfolder of testoutput.
+     * @param filename the name of the output file.
+     */
+    static void printChromeTraceToFile(const std::string directory, const std::string filename);
+};
+
+/**
+ * A phase open for the lifetime of the object, if the instrumentation is enabled.
+ */
+class ScopedPhase
+{
+private:
+
+    /** Whether a phase was opened */
+    bool mOpen;
+
+public:
+
+    /**
+     * Constructor: it opens the phase.
+     *
+     * @param name the name of the phase
+     */
+    ScopedPhase(const char* name) :
+    mOpen(false)
+    {
+        if (Instrumentation::isEnabled())
+        {
+            mOpen = Instrumentation::beginPhase(name);
+        }
+    }
+
+    /**
+     * Destructor: it closes the phase.
+     */
+    ~ScopedPhase()
+    {
+        if (mOpen)
+        {
+            Instrumentation::endPhase();
+        }
+    }
+};
+
+#endif /* INSTRUMENTATION_HPP_ */
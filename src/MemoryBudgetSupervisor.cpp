@@ -0,0 +1,256 @@
+#include "MemoryBudgetSupervisor.hpp"
+#include "BddMemoryPolicy.hpp"
+#include "SamplingAttractorFinder.hpp"
+#include "Instrumentation.hpp"
+#include <algorithm>
+#include <cassert>
+#include <boost/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
+
+/** Map from the packed attractor states to the index of their attractor */
+typedef boost::unordered_map<std::vector<uint64_t>, unsigned> AttractorStateMap;
+
+/**
+ * Add the states of an attractor to the map.
+ *
+ * @param rStates the packed states of the attractor
+ * @param words_per_state the number of words of a state
+ * @param index the index of the attractor
+ * @param rStateMap the map
+ */
+void addAttractorStates(const std::vector<uint64_t>& rStates, unsigned words_per_state,
+        unsigned index, AttractorStateMap& rStateMap);
+
+/**
+ * Follow the trajectory of a state until it reaches an attractor; a cycle
+ * not in the map (found with Brent's algorithm) is appended.
+ *
+ * @param rNetwork the network
+ * @param rState the initial state
+ * @param max_steps the maximum number of updates
+ * @param rAttractorStates the packed states of every attractor
+ * @param rAttractorLength the number of states of every attractor
+ * @param rStateMap the map of the attractor states
+ *
+ * @return the index of the attractor reached.
+ */
+unsigned getExplicitStateAttractor(const TruthTableNetwork& rNetwork, const std::vector<uint64_t>& rState,
+        unsigned max_steps, std::vector<std::vector<uint64_t> >& rAttractorStates,
+        std::vector<unsigned>& rAttractorLength, AttractorStateMap& rStateMap);
+
+MemoryBudgetSupervisor::MemoryBudgetSupervisor(RandomBooleanNetwork& rNetwork, size_t memory_budget) :
+mrNetwork(rNetwork),
+mMemoryBudget(memory_budget),
+mSamplesNumber(10000),
+mMaxSteps(100000),
+mSeed(0)
+{
+}
+
+void MemoryBudgetSupervisor::setSamplingOptions(unsigned samples_number, unsigned max_steps, uint64_t seed)
+{
+    if (samples_number == 0 || max_steps == 0)
+        EXCEPTION("The number of samples and the maximum number of steps must be greater than 0.");
+    mSamplesNumber = samples_number;
+    mMaxSteps = max_steps;
+    mSeed = seed;
+}
+
+SupervisedAnalysisResult MemoryBudgetSupervisor::run(bool compute_attractor_matrix)
+{
+    ScopedPhase phase("MemoryBudgetSupervisor");
+
+    /* The truth tables are built before the table can fill up. */
+    TruthTableNetwork network(mrNetwork);
+    unsigned words_per_state = network.getWordsPerState();
+
+    size_t previous_limit = BddMemoryPolicy::getMemoryLimit();
+    if (mMemoryBudget > 0)
+    {
+        BddMemoryPolicy::setMemoryLimit(previous_limit == 0 ? mMemoryBudget : std::min(previous_limit, mMemoryBudget));
+    }
+
+    SupervisedAnalysisResult result;
+    result.attractorEngine = SYMBOLIC_ENGINE;
+    result.attractorMatrixEngine = SYMBOLIC_ENGINE;
+    try
+    {
+        mrNetwork.findAttractors();
+        bool budget_exceeded = !mrNetwork.isAttractorSearchComplete() && BddMemoryPolicy::isNodesLimitReached();
+        result.complete = mrNetwork.isAttractorSearchComplete();
+
+        /* The attractors found before the table filled up are kept. */
+        BddMemoryPolicy::clearNodesLimitReached();
+        result.symbolicAttractorsNumber = mrNetwork.getAttractorsNumber();
+        for (unsigned i=0; i<result.symbolicAttractorsNumber; i++)
+        {
+            result.attractorStates.push_back(mrNetwork.getAttractorStates(i));
+            result.attractorLength.push_back(mrNetwork.getAttractorLength()[i]);
+        }
+
+        if (budget_exceeded)
+        {
+            result.attractorEngine = EXPLICIT_ENGINE;
+            AttractorStateMap state_map;
+            for (unsigned i=0; i<result.attractorStates.size(); i++)
+            {
+                addAttractorStates(result.attractorStates[i], words_per_state, i, state_map);
+            }
+            SamplingAttractorFinder finder(network);
+            finder.findAttractors(mSamplesNumber, mMaxSteps, mSeed);
+            for (unsigned i=0; i<finder.getAttractors().size(); i++)
+            {
+                if (state_map.find(finder.getAttractors()[i].minimalState) == state_map.end())
+                {
+                    result.attractorStates.push_back(finder.getAttractorStates(i));
+                    result.attractorLength.push_back(finder.getAttractors()[i].length);
+                    addAttractorStates(result.attractorStates.back(), words_per_state,
+                            result.attractorStates.size() - 1, state_map);
+                }
+            }
+        }
+
+        if (compute_attractor_matrix && !result.attractorStates.empty())
+        {
+            bool symbolic_matrix = result.complete;
+            if (symbolic_matrix)
+            {
+                try
+                {
+                    result.attractorMatrix = mrNetwork.getAttractorMatrix();
+                }
+                catch (Exception&)
+                {
+                    /* Only a full node table falls back to the explicit
+                     * engine; any other error is not hidden. */
+                    if (!BddMemoryPolicy::isNodesLimitReached()) throw;
+                    symbolic_matrix = false;
+                }
+            }
+            if (!symbolic_matrix)
+            {
+                result.attractorMatrixEngine = EXPLICIT_ENGINE;
+                unsigned attractors_number = result.attractorStates.size();
+                result.attractorMatrix = getExplicitAttractorMatrix(network, result.attractorStates,
+                        result.attractorLength, mMaxSteps);
+                if (result.attractorStates.size() > attractors_number)
+                {
+                    result.attractorEngine = EXPLICIT_ENGINE;
+                }
+            }
+        }
+    }
+    catch (Exception&)
+    {
+        BddMemoryPolicy::setMemoryLimit(previous_limit);
+        throw;
+    }
+    BddMemoryPolicy::setMemoryLimit(previous_limit);
+    return result;
+}
+
+std::vector<std::map<unsigned,double> > MemoryBudgetSupervisor::getExplicitAttractorMatrix(
+        const TruthTableNetwork& rNetwork, std::vector<std::vector<uint64_t> >& rAttractorStates,
+        std::vector<unsigned>& rAttractorLength, unsigned max_steps)
+{
+    assert(rAttractorStates.size() == rAttractorLength.size());
+    unsigned words_per_state = rNetwork.getWordsPerState();
+    unsigned nodes_number = rNetwork.getNodesNumber();
+    AttractorStateMap state_map;
+    for (unsigned i=0; i<rAttractorStates.size(); i++)
+    {
+        addAttractorStates(rAttractorStates[i], words_per_state, i, state_map);
+    }
+
+    /* Attractors reached by a flip are appended and get their own row. */
+    std::vector<std::map<unsigned,unsigned> > frequency_matrix;
+    for (unsigned i=0; i<rAttractorStates.size(); i++)
+    {
+        frequency_matrix.push_back(std::map<unsigned,unsigned>());
+        for (unsigned s=0; s<rAttractorLength[i]; s++)
+        {
+            for (unsigned node=0; node<nodes_number; node++)
+            {
+                std::vector<uint64_t> flip_state(rAttractorStates[i].begin() + s * words_per_state,
+                        rAttractorStates[i].begin() + (s + 1) * words_per_state);
+                flip_state[node / 64] ^= ((uint64_t) 1) << (node % 64);
+                unsigned position = getExplicitStateAttractor(rNetwork, flip_state, max_steps,
+                        rAttractorStates, rAttractorLength, state_map);
+                frequency_matrix[i][position]++;
+            }
+        }
+    }
+
+    std::vector<std::map<unsigned,double> > stochastic_matrix(frequency_matrix.size());
+    for (unsigned row=0; row<frequency_matrix.size(); row++)
+    {
+        unsigned row_sum = 0;
+        std::map<unsigned,unsigned>::const_iterator iterator;
+        for (iterator=frequency_matrix[row].begin(); iterator!=frequency_matrix[row].end(); ++iterator)
+        {
+            row_sum += iterator->second;
+        }
+        for (iterator=frequency_matrix[row].begin(); iterator!=frequency_matrix[row].end(); ++iterator)
+        {
+            stochastic_matrix[row][iterator->first] = (double) iterator->second / (double) row_sum;
+        }
+    }
+    return stochastic_matrix;
+}
+
+void addAttractorStates(const std::vector<uint64_t>& rStates, unsigned words_per_state,
+        unsigned index, AttractorStateMap& rStateMap)
+{
+    for (unsigned offset=0; offset<rStates.size(); offset+=words_per_state)
+    {
+        std::vector<uint64_t> state(rStates.begin() + offset, rStates.begin() + offset + words_per_state);
+        rStateMap[state] = index;
+    }
+}
+
+unsigned getExplicitStateAttractor(const TruthTableNetwork& rNetwork, const std::vector<uint64_t>& rState,
+        unsigned max_steps, std::vector<std::vector<uint64_t> >& rAttractorStates,
+        std::vector<unsigned>& rAttractorLength, AttractorStateMap& rStateMap)
+{
+    unsigned words_per_state = rNetwork.getWordsPerState();
+    std::vector<uint64_t> current(rState);
+    std::vector<uint64_t> next(words_per_state);
+    std::vector<uint64_t> tortoise(rState);
+
+    /* Brent: the tortoise jumps to the current state every power of two steps. */
+    unsigned power = 1;
+    unsigned length = 0;
+    for (unsigned steps=0; ; steps++)
+    {
+        AttractorStateMap::const_iterator found = rStateMap.find(current);
+        if (found != rStateMap.end())
+        {
+            return found->second;
+        }
+        if (steps >= max_steps)
+            EXCEPTION("A trajectory did not reach an attractor within the maximum number of steps.");
+        rNetwork.update(&current[0], &next[0]);
+        current.swap(next);
+        length++;
+        if (current == tortoise)
+        {
+            /* A new attractor of the given length. */
+            std::vector<uint64_t> states(current);
+            states.resize(length * words_per_state);
+            for (unsigned i=1; i<length; i++)
+            {
+                rNetwork.update(&states[(i-1) * words_per_state], &states[i * words_per_state]);
+            }
+            rAttractorStates.push_back(states);
+            rAttractorLength.push_back(length);
+            addAttractorStates(states, words_per_state, rAttractorStates.size() - 1, rStateMap);
+            return rAttractorStates.size() - 1;
+        }
+        if (length == power)
+        {
+            tortoise = current;
+            power *= 2;
+            length = 0;
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#ifndef MEMORYBUDGETSUPERVISOR_HPP_
+#define MEMORYBUDGETSUPERVISOR_HPP_
+
+#include "RandomBooleanNetwork.hpp"
+#include "TruthTableNetwork.hpp"
+#include "Exception.hpp"
+#include <vector>
+#include <map>
+#include <stdint.h>
+
+/**
+ * The engines which can produce the attractors and the ATN.
+ */
+enum AttractorEngine
+{
+    /** The symbolic (BDD) algorithms of RandomBooleanNetwork */
+    SYMBOLIC_ENGINE,
+    /** Explicit simulation of the truth tables (SamplingAttractorFinder) */
+    EXPLICIT_ENGINE
+};
+
+/**
+ * The attractors and the ATN computed by MemoryBudgetSupervisor.
+ */
+struct SupervisedAnalysisResult
+{
+    /** The states of every attractor, packed as in TruthTableNetwork */
+    std::vector<std::vector<uint64_t> > attractorStates;
+
+    /** The number of states of every attractor */
+    std::vector<unsigned> attractorLength;
+
+    /** The number of attractors found by the symbolic search (the first ones) */
+    unsigned symbolicAttractorsNumber;
+
+    /** Whether the attractors are all the attractors of the network */
+    bool complete;
+
+    /** The engine which produced the attractors (EXPLICIT_ENGINE if some were sampled) */
+    AttractorEngine attractorEngine;
+
+    /** The ATN (empty if it was not requested) */
+    std::vector<std::map<unsigned,double> > attractorMatrix;
+
+    /** The engine which produced the ATN */
+    AttractorEngine attractorMatrixEngine;
+};
+
+/**
+ * Run the attractor search and the ATN of a network within a memory
+ * budget for the BDD node table. The budget is set as the memory limit of
+ * BddMemoryPolicy while the symbolic algorithms run: if the table fills
+ * up, the symbolic path is abandoned. The attractors found so far are
+ * kept, the others are sampled with SamplingAttractorFinder, and the ATN
+ * is computed explicitly by simulating the flips of every attractor state
+ * on the truth tables.
+ */
+class MemoryBudgetSupervisor
+{
+private:
+
+    /** The network */
+    RandomBooleanNetwork& mrNetwork;
+
+    /** The memory budget of the node table in bytes (0 means no budget) */
+    size_t mMemoryBudget;
+
+    /** The number of random initial states of the sampling search */
+    unsigned mSamplesNumber;
+
+    /** The maximum number of updates of a trajectory */
+    unsigned mMaxSteps;
+
+    /** The seed of the sampling search (0 means drawn from the RandomNumberGenerator) */
+    uint64_t mSeed;
+
+public:
+
+    /**
+     * Constructor. By default 10000 states are sampled, with at most
+     * 100000 updates per trajectory.
+     *
+     * @param rNetwork the network (it must live as long as this object)
+     * @param memory_budget the memory budget of the node table in bytes,
+     * or 0 for no budget
+     */
+    MemoryBudgetSupervisor(RandomBooleanNetwork& rNetwork, size_t memory_budget);
+
+    /**
+     * Set the parameters of the explicit engines.
+     *
+     * @param samples_number the number of random initial states
+     * @param max_steps the maximum number of updates of a trajectory
+     * @param seed the seed of the initial states, or 0
+     */
+    void setSamplingOptions(unsigned samples_number, unsigned max_steps, uint64_t seed = 0);
+
+    /**
+     * Find the attractors and, if requested, the ATN, falling back to the
+     * explicit engines when the budget is exceeded. The memory limit of
+     * BddMemoryPolicy is restored at the end.
+     *
+     * @param compute_attractor_matrix whether to compute the ATN
+     *
+     * @return the attractors, the ATN and the engines which produced them.
+     */
+    SupervisedAnalysisResult run(bool compute_attractor_matrix = true);
+
+    /**
+     * Compute the ATN explicitly: every node of every attractor state is
+     * flipped and the trajectory is followed until it reaches an
+     * attractor. Attractors reached but not given are appended.
+     *
+     * @param rNetwork the network
+     * @param rAttractorStates the packed states of every attractor
+     * @param rAttractorLength the number of states of every attractor
+     * @param max_steps the maximum number of updates of a trajectory
+     *
+     * @return the ATN, as RandomBooleanNetwork::getAttractorMatrix().
+     */
+    static std::vector<std::map<unsigned,double> > getExplicitAttractorMatrix(const TruthTableNetwork& rNetwork,
+            std::vector<std::vector<uint64_t> >& rAttractorStates, std::vector<unsigned>& rAttractorLength,
+            unsigned max_steps);
+};
+
+#endif /* MEMORYBUDGETSUPERVISOR_HPP_ */
@@ -0,0 +1,269 @@
+#include "PerturbationScreen.hpp"
+#include "OutputFileHandler.hpp"
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+PerturbationScreen::PerturbationScreen(const RandomBooleanNetwork& rNetwork, bool compute_attractor_matrix) :
+mrNetwork(rNetwork),
+mNodesNumber(rNetwork.getNodesNumber()),
+mComputeAttractorMatrix(compute_attractor_matrix)
+{
+    assert(mNodesNumber > 0);
+
+    for (unsigned node=0; node<mNodesNumber; node++)
+    {
+        mNodeFunctions.push_back(mrNetwork.getNodeFunction(node));
+    }
+
+    ArrayDirectedGraph* p_dependency_graph = mrNetwork.getDependencyGraph();
+    unsigned modules_number = p_dependency_graph->getStronglyConnectedComponents(mNodeModule);
+    delete p_dependency_graph;
+    mModules.resize(modules_number);
+    for (unsigned node=0; node<mNodesNumber; node++)
+    {
+        mModules.at(mNodeModule.at(node)).push_back(node);
+    }
+
+    mpVariablesPair = bdd_newpair();
+    int* p_variables_id = new int[mNodesNumber];
+    int* p_next_variables_id = new int[mNodesNumber];
+    for (unsigned i=0; i<mNodesNumber; i++)
+    {
+        p_variables_id[i] = (int) i*2;
+        p_next_variables_id[i] = (int) i*2 + 1;
+    }
+    mpNextVariablesPair = bdd_newpair();
+    bdd_setpairs(mpVariablesPair, p_next_variables_id, p_variables_id, mNodesNumber);
+    bdd_setpairs(mpNextVariablesPair, p_variables_id, p_next_variables_id, mNodesNumber);
+    delete[] p_variables_id;
+    delete[] p_next_variables_id;
+
+    std::vector<bdd> attractors;
+    std::vector<unsigned> attractor_length;
+    searchModules(mNodeFunctions, 0, true, attractors, attractor_length);
+    if (mComputeAttractorMatrix)
+    {
+        mAttractorMatrix = mrNetwork.getAttractorMatrix(attractors, mNodeFunctions);
+    }
+}
+
+PerturbationScreen::~PerturbationScreen()
+{
+    bdd_freepair(mpVariablesPair);
+    bdd_freepair(mpNextVariablesPair);
+}
+
+void PerturbationScreen::searchModules(const std::vector<bdd>& rNodeFunctions, unsigned first_module,
+        bool store_prefix, std::vector<bdd>& rAttractors, std::vector<unsigned>& rAttractorLength)
+{
+    /* Before the first module no variable is involved: the only
+     * upstream "attractor" is the whole state space. */
+    std::vector<bdd> upstream_attractors(1, bddtrue);
+    std::vector<unsigned> upstream_attractor_length(1, 1u);
+    std::vector<bdd> upstream_transitions(1, bddtrue);
+    bdd upstream_variables = bddtrue;
+    if (first_module > 0)
+    {
+        upstream_attractors = mPrefixAttractors.at(first_module - 1);
+        upstream_attractor_length = mPrefixAttractorLength.at(first_module - 1);
+        upstream_transitions = mPrefixAttractorTransitions.at(first_module - 1);
+        upstream_variables = mPrefixVariables.at(first_module - 1);
+    }
+
+    for (unsigned module=first_module; module<mModules.size(); module++)
+    {
+        bdd module_transition_function = bddtrue;
+        bdd module_variables = bddtrue;
+        for (unsigned i=0; i<mModules.at(module).size(); i++)
+        {
+            unsigned node = mModules.at(module).at(i);
+            module_transition_function &= bdd_apply(bdd_ithvar(node*2 + 1), rNodeFunctions.at(node), bddop_biimp);
+            module_variables &= bdd_ithvar(node*2);
+        }
+        std::vector<bdd> driven_attractors;
+        std::vector<unsigned> driven_attractor_length;
+        std::vector<bdd> driven_transitions;
+        for (unsigned i=0; i<upstream_attractors.size(); i++)
+        {
+            mrNetwork.findAttractorsInClosedStates(upstream_attractors.at(i), upstream_transitions.at(i),
+                    upstream_variables, module_transition_function, module_variables, mpVariablesPair,
+                    mpNextVariablesPair, driven_attractors, driven_attractor_length, driven_transitions);
+        }
+        upstream_attractors.swap(driven_attractors);
+        upstream_attractor_length.swap(driven_attractor_length);
+        upstream_transitions.swap(driven_transitions);
+        upstream_variables &= module_variables;
+        if (store_prefix)
+        {
+            mPrefixAttractorTransitions.push_back(upstream_transitions);
+            mPrefixVariables.push_back(upstream_variables);
+            mPrefixAttractors.push_back(upstream_attractors);
+            mPrefixAttractorLength.push_back(upstream_attractor_length);
+        }
+    }
+    rAttractors = upstream_attractors;
+    rAttractorLength = upstream_attractor_length;
+}
+
+PerturbationResult PerturbationScreen::runPerturbation(const std::vector<std::pair<unsigned,bool> >& clamped_nodes)
+{
+    if (clamped_nodes.empty())
+        EXCEPTION("At least a node must be clamped.");
+
+    PerturbationResult result;
+    result.clampedNodes = clamped_nodes;
+
+    /* The constants are substituted in all the functions, so the clamped
+     * nodes disappear from the supports of their targets. */
+    std::vector<bdd> node_functions(mNodeFunctions);
+    bdd assignment = bddtrue;
+    unsigned first_module = mModules.size();
+    for (unsigned i=0; i<clamped_nodes.size(); i++)
+    {
+        unsigned node = clamped_nodes[i].first;
+        if (node >= mNodesNumber)
+            EXCEPTION("Error, node id must be < number of nodes.");
+        assignment &= clamped_nodes[i].second ? bdd_ithvar(node*2) : bdd_nithvar(node*2);
+        first_module = std::min(first_module, mNodeModule.at(node));
+    }
+    if (assignment == bddfalse)
+        EXCEPTION("A node cannot be clamped to both values.");
+    for (unsigned node=0; node<mNodesNumber; node++)
+    {
+        node_functions[node] = bdd_restrict(node_functions[node], assignment);
+    }
+    for (unsigned i=0; i<clamped_nodes.size(); i++)
+    {
+        node_functions[clamped_nodes[i].first] = clamped_nodes[i].second ? bddtrue : bddfalse;
+    }
+
+    std::vector<bdd> attractors;
+    searchModules(node_functions, first_module, false, attractors, result.attractorLength);
+    result.reusedModulesNumber = first_module;
+
+    /* BDDs are canonical: the same set of states is the same node. */
+    const std::vector<bdd>& wild_type_attractors = getWildTypeAttractors();
+    std::vector<bool> preserved(wild_type_attractors.size(), false);
+    for (unsigned i=0; i<attractors.size(); i++)
+    {
+        std::vector<bdd>::const_iterator it = std::find(wild_type_attractors.begin(),
+                wild_type_attractors.end(), attractors[i]);
+        int index = -1;
+        if (it != wild_type_attractors.end())
+        {
+            index = it - wild_type_attractors.begin();
+            preserved[index] = true;
+        }
+        result.wildTypeAttractor.push_back(index);
+    }
+    result.lostAttractorsNumber = std::count(preserved.begin(), preserved.end(), false);
+
+    result.changedTransitionsNumber = 0;
+    if (mComputeAttractorMatrix)
+    {
+        result.attractorMatrix = mrNetwork.getAttractorMatrix(attractors, node_functions);
+        for (unsigned row=0; row<attractors.size(); row++)
+        {
+            if (result.wildTypeAttractor[row] < 0) continue;
+            for (unsigned col=0; col<attractors.size(); col++)
+            {
+                if (result.wildTypeAttractor[col] < 0) continue;
+                std::map<unsigned,double>::const_iterator mutant_it = result.attractorMatrix[row].find(col);
+                std::map<unsigned,double>::const_iterator wild_it =
+                        mAttractorMatrix[result.wildTypeAttractor[row]].find(result.wildTypeAttractor[col]);
+                double mutant_value = mutant_it == result.attractorMatrix[row].end() ? 0.0 : mutant_it->second;
+                double wild_value = wild_it == mAttractorMatrix[result.wildTypeAttractor[row]].end() ? 0.0 : wild_it->second;
+                if (fabs(mutant_value - wild_value) > 1e-12)
+                {
+                    result.changedTransitionsNumber++;
+                }
+            }
+        }
+    }
+
+    mResults.push_back(result);
+    return result;
+}
+
+void PerturbationScreen::runScreen(bool knockouts, bool over_expressions, bool double_perturbations)
+{
+    std::vector<bool> values;
+    if (knockouts) values.push_back(false);
+    if (over_expressions) values.push_back(true);
+
+    for (unsigned node=0; node<mNodesNumber; node++)
+    {
+        for (unsigned v=0; v<values.size(); v++)
+        {
+            std::vector<std::pair<unsigned,bool> > clamped_nodes(1, std::make_pair(node, values[v]));
+            runPerturbation(clamped_nodes);
+        }
+    }
+    if (double_perturbations)
+    {
+        for (unsigned node1=0; node1<mNodesNumber; node1++)
+        {
+            for (unsigned node2=node1+1; node2<mNodesNumber; node2++)
+            {
+                for (unsigned v1=0; v1<values.size(); v1++)
+                {
+                    for (unsigned v2=0; v2<values.size(); v2++)
+                    {
+                        std::vector<std::pair<unsigned,bool> > clamped_nodes;
+                        clamped_nodes.push_back(std::make_pair(node1, values[v1]));
+                        clamped_nodes.push_back(std::make_pair(node2, values[v2]));
+                        runPerturbation(clamped_nodes);
+                    }
+                }
+            }
+        }
+    }
+}
+
+const std::vector<PerturbationResult>& PerturbationScreen::getResults() const
+{
+    return mResults;
+}
+
+const std::vector<bdd>& PerturbationScreen::getWildTypeAttractors() const
+{
+    return mPrefixAttractors.back();
+}
+
+const std::vector<unsigned>& PerturbationScreen::getWildTypeAttractorLength() const
+{
+    return mPrefixAttractorLength.back();
+}
+
+void PerturbationScreen::printResultsToFile(const std::string directory, const std::string filename) const
+{
+    if (directory.empty())
+        EXCEPTION("Directory name not valid.");
+
+    OutputFileHandler handler(directory,false);
+    out_stream p_file = handler.OpenOutputFile(filename);
+
+    *p_file << "#This file has been generated by CoGNaC\n";
+    *p_file << "#Wild type: " << getWildTypeAttractors().size() << " attractors\n";
+    *p_file << "#mutant\tattractors\tlengths\tpreserved\tnew\tlost\tchanged_transitions\n";
+    for (unsigned i=0; i<mResults.size(); i++)
+    {
+        const PerturbationResult& r_result = mResults[i];
+        for (unsigned j=0; j<r_result.clampedNodes.size(); j++)
+        {
+            *p_file << (j > 0 ? "," : "") << r_result.clampedNodes[j].first + 1 << "=" << r_result.clampedNodes[j].second;
+        }
+        *p_file << "\t" << r_result.attractorLength.size() << "\t";
+        for (unsigned j=0; j<r_result.attractorLength.size(); j++)
+        {
+            *p_file << (j > 0 ? "," : "") << r_result.attractorLength[j];
+        }
+        unsigned new_attractors = std::count(r_result.wildTypeAttractor.begin(), r_result.wildTypeAttractor.end(), -1);
+        *p_file << "\t" << r_result.attractorLength.size() - new_attractors
+                << "\t" << new_attractors
+                << "\t" << r_result.lostAttractorsNumber
+                << "\t" << r_result.changedTransitionsNumber << "\n";
+    }
+    p_file->close();
+}
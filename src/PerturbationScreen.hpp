@@ -0,0 +1,183 @@
+#ifndef PERTURBATIONSCREEN_HPP_
+#define PERTURBATIONSCREEN_HPP_
+
+#include "RandomBooleanNetwork.hpp"
+#include "Exception.hpp"
+#include <vector>
+#include <map>
+#include <string>
+#include <utility>
+#include <bdd.h>
+
+/**
+ * The effect of a perturbation (some nodes clamped to 0 or 1) on the
+ * attractors and on the ATN of a network.
+ */
+struct PerturbationResult
+{
+    /** The clamped nodes with their values (false = knockout, true = over-expression) */
+    std::vector<std::pair<unsigned,bool> > clampedNodes;
+
+    /** The lengths of the attractors of the mutant */
+    std::vector<unsigned> attractorLength;
+
+    /**
+     * For every attractor of the mutant, the index of the same attractor
+     * (same set of states) in the wild type, or -1 if it is a new one.
+     */
+    std::vector<int> wildTypeAttractor;
+
+    /** The number of wild-type attractors which are not attractors of the mutant */
+    unsigned lostAttractorsNumber;
+
+    /**
+     * The number of transitions between attractors present in both the
+     * wild type and the mutant whose probability changed in the ATN.
+     */
+    unsigned changedTransitionsNumber;
+
+    /** The ATN of the mutant (empty if the ATNs are not computed) */
+    std::vector<std::map<unsigned,double> > attractorMatrix;
+
+    /** The number of (wild-type) modules whose attractors were reused */
+    unsigned reusedModulesNumber;
+};
+
+/**
+ * Screen of gene knockouts and over-expressions. A mutant clamps some
+ * nodes: their functions become constants, and the constants are
+ * substituted (bdd_restrict) in the functions of the nodes reading them.
+ *
+ * Attractors are computed with the modular algorithm of
+ * RandomBooleanNetwork::findAttractorsModular(). Clamping a node only
+ * removes dependencies, so the wild-type modules, in topological order,
+ * are still a valid decomposition for every mutant. The wild-type
+ * attractors of the modules upstream of the first clamped node are stored
+ * once, and every mutant restarts the search from there.
+ *
+ * BuDDy is not reentrant, so mutants are processed one after the other.
+ */
+class PerturbationScreen
+{
+private:
+
+    /** The wild-type network */
+    const RandomBooleanNetwork& mrNetwork;
+
+    /** The number of nodes of the network */
+    unsigned mNodesNumber;
+
+    /** The wild-type functions of the nodes */
+    std::vector<bdd> mNodeFunctions;
+
+    /** The strongly connected modules, in topological order */
+    std::vector<std::vector<unsigned> > mModules;
+
+    /** The module of every node */
+    std::vector<unsigned> mNodeModule;
+
+    /** The i-th entry has the cycles of the attractors of the modules 0..i */
+    std::vector<std::vector<bdd> > mPrefixAttractorTransitions;
+
+    /** The i-th entry is the set of current variables of the modules 0..i */
+    std::vector<bdd> mPrefixVariables;
+
+    /** The i-th entry contains the attractors of the modules 0..i */
+    std::vector<std::vector<bdd> > mPrefixAttractors;
+
+    /** The i-th entry contains the lengths of the attractors of the modules 0..i */
+    std::vector<std::vector<unsigned> > mPrefixAttractorLength;
+
+    /** The wild-type ATN (empty if the ATNs are not computed) */
+    std::vector<std::map<unsigned,double> > mAttractorMatrix;
+
+    /** Whether the ATNs are computed */
+    bool mComputeAttractorMatrix;
+
+    /** The results of the perturbations run so far */
+    std::vector<PerturbationResult> mResults;
+
+    /** bddPair replacing next variables with current variables */
+    bddPair* mpVariablesPair;
+
+    /** bddPair replacing current variables with next variables */
+    bddPair* mpNextVariablesPair;
+
+    /**
+     * Run the modular search from a given module.
+     *
+     * @param rNodeFunctions the functions of the nodes
+     * @param first_module the first module to visit (the attractors of the
+     * previous ones are taken from the wild type)
+     * @param store_prefix whether to store the attractors of every prefix
+     * @param rAttractors vector filled with the attractors
+     * @param rAttractorLength vector filled with the lengths of the attractors
+     */
+    void searchModules(const std::vector<bdd>& rNodeFunctions, unsigned first_module, bool store_prefix,
+            std::vector<bdd>& rAttractors, std::vector<unsigned>& rAttractorLength);
+
+public:
+
+    /**
+     * Constructor: it computes the attractors (and, if requested, the ATN)
+     * of the wild type. Buddy must be initialised and the network must live
+     * as long as this object.
+     *
+     * @param rNetwork the wild-type network
+     * @param compute_attractor_matrix whether to compute the ATN of every mutant
+     */
+    PerturbationScreen(const RandomBooleanNetwork& rNetwork, bool compute_attractor_matrix = true);
+
+    /**
+     * Destructor: it releases the bddPair.
+     */
+    ~PerturbationScreen();
+
+    /**
+     * Compute the attractors of a mutant and compare them with the wild type.
+     * The result is also appended to the results of the screen.
+     *
+     * @param clamped_nodes the clamped nodes with their values
+     *
+     * @return the effect of the perturbation.
+     */
+    PerturbationResult runPerturbation(const std::vector<std::pair<unsigned,bool> >& clamped_nodes);
+
+    /**
+     * Run all the single perturbations and, if requested, all the double
+     * ones (pairs of distinct nodes).
+     *
+     * @param knockouts whether nodes are clamped to 0
+     * @param over_expressions whether nodes are clamped to 1
+     * @param double_perturbations whether pairs of nodes are clamped too
+     */
+    void runScreen(bool knockouts, bool over_expressions, bool double_perturbations);
+
+    /**
+     * @return the results of the perturbations run so far.
+     */
+    const std::vector<PerturbationResult>& getResults() const;
+
+    /**
+     * @return the wild-type attractors.
+     */
+    const std::vector<bdd>& getWildTypeAttractors() const;
+
+    /**
+     * @return the lengths of the wild-type attractors.
+     */
+    const std::vector<unsigned>& getWildTypeAttractorLength() const;
+
+    /**
+     * Save the results in a tab-separated file: one row per mutant, with
+     * the clamped nodes (e.g. '3=0,5=1', ids start from 1), the number of
+     * attractors and their lengths, the preserved, new and lost attractors
+     * and the changed ATN transitions.
+     *
+     * @param directory the name of the subfolder of testoutput.
+     * @param filename the name of the output file.
+     */
+    void printResultsToFile(const std::string directory, const std::string filename) const;
+};
+
+#endif /* PERTURBATIONSCREEN_HPP_ */
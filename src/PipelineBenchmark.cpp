@@ -0,0 +1,296 @@
+#include "PipelineBenchmark.hpp"
+#include "ThresholdErgodicSetDifferentiationTree.hpp"
+#include "DifferentiationTree.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "TruthTableNetwork.hpp"
+#include "BitSlicedNetworkKernel.hpp"
+#include "SplitMixRandomGenerator.hpp"
+#include "OutputFileHandler.hpp"
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/algorithm/string.hpp>
+#include <bdd.h>
+
+/**
+ * @return the wall-clock time, in seconds.
+ */
+double getWallTime();
+
+/**
+ * @return the BDD nodes produced so far (0 if Buddy is not running).
+ */
+long getBddNodesProduced();
+
+PipelineBenchmark::PipelineBenchmark() :
+mStageBeginning(0.0),
+mStageBddNodesProduced(0)
+{
+}
+
+void PipelineBenchmark::beginStage()
+{
+    mStageBddNodesProduced = getBddNodesProduced();
+    mStageBeginning = getWallTime();
+}
+
+void PipelineBenchmark::endStage(const std::string& rNetwork, const std::string& rStage)
+{
+    BenchmarkMeasure measure;
+    measure.seconds = getWallTime() - mStageBeginning;
+    measure.network = rNetwork;
+    measure.stage = rStage;
+    measure.bddNodesProduced = std::max(0l, getBddNodesProduced() - mStageBddNodesProduced);
+    measure.bddNodesInUse = bdd_isrunning() ? bdd_getnodenum() : 0;
+    measure.geneUpdatesPerSecond = 0.0;
+    /* ru_maxrss is in kB on Linux. */
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    measure.peakRss = usage.ru_maxrss;
+    mMeasures.push_back(measure);
+}
+
+void PipelineBenchmark::runPipeline(const std::string& rName, RandomBooleanNetwork& rNetwork)
+{
+    beginStage();
+    rNetwork.findAttractors();
+    endStage(rName, "findAttractors");
+
+    beginStage();
+    std::vector<std::map<unsigned,double> > attractor_matrix = rNetwork.getAttractorMatrix();
+    endStage(rName, "getAttractorMatrix");
+
+    beginStage();
+    ThresholdErgodicSetDifferentiationTree tes_tree(attractor_matrix, rNetwork.getAttractorLength());
+    endStage(rName, "ThresholdErgodicSetDifferentiationTree");
+
+    beginStage();
+    DifferentiationTree* p_tree = tes_tree.getDifferentiationTree();
+    delete p_tree;
+    endStage(rName, "getDifferentiationTree");
+
+    runKernelStages(rName, rNetwork);
+}
+
+void PipelineBenchmark::runKernelStages(const std::string& rName, const RandomBooleanNetwork& rNetwork)
+{
+    TruthTableNetwork truth_table_network(rNetwork);
+    BitSlicedNetworkKernel kernel(truth_table_network);
+    unsigned nodes_number = kernel.getNodesNumber();
+    unsigned words_per_node = BitSlicedNetworkKernel::getWordsPerNode(KERNEL_TRAJECTORIES);
+    std::vector<uint64_t> initial_states((size_t) nodes_number * words_per_node);
+    SplitMixRandomGenerator generator(0, 0);
+    for (unsigned i=0; i<initial_states.size(); i++)
+    {
+        initial_states[i] = generator.next();
+    }
+
+    BitSlicedNetworkKernel::InstructionSet instruction_sets[] =
+            {BitSlicedNetworkKernel::SCALAR, BitSlicedNetworkKernel::AVX2, BitSlicedNetworkKernel::AVX512};
+    for (unsigned i=0; i<3; i++)
+    {
+        if (!BitSlicedNetworkKernel::isInstructionSetSupported(instruction_sets[i])) continue;
+        kernel.setInstructionSet(instruction_sets[i]);
+        std::vector<uint64_t> current_states(initial_states);
+        std::vector<uint64_t> next_states(initial_states.size());
+        unsigned steps_number = 0;
+        beginStage();
+        do
+        {
+            for (unsigned step=0; step<KERNEL_STEPS; step++)
+            {
+                kernel.update(&current_states[0], &next_states[0], words_per_node);
+                current_states.swap(next_states);
+            }
+            steps_number += KERNEL_STEPS;
+        } while (getWallTime() - mStageBeginning < KERNEL_MILLISECONDS * 1e-3);
+        endStage(rName, "kernel_" + BitSlicedNetworkKernel::getInstructionSetName(instruction_sets[i]));
+        double gene_updates = (double) nodes_number * KERNEL_TRAJECTORIES * steps_number;
+        mMeasures.back().geneUpdatesPerSecond = mMeasures.back().seconds > 0.0 ?
+                gene_updates / mMeasures.back().seconds : 0.0;
+    }
+}
+
+void PipelineBenchmark::runNetworkFile(const std::string file_path)
+{
+    std::string name = boost::filesystem::path(file_path).filename().string();
+    beginStage();
+    RandomBooleanNetwork network(file_path);
+    endStage(name, "parse");
+    runPipeline(name, network);
+}
+
+void PipelineBenchmark::runNetworkFiles(const std::string directory)
+{
+    if (!boost::filesystem::is_directory(directory))
+        EXCEPTION("Error in the directory path.");
+
+    std::vector<std::string> files;
+    boost::filesystem::directory_iterator end;
+    for (boost::filesystem::directory_iterator it(directory); it != end; ++it)
+    {
+        std::string extension = it->path().extension().string();
+        if (extension == ".net" || extension == ".cnet")
+        {
+            files.push_back(it->path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    for (unsigned i=0; i<files.size(); i++)
+    {
+        runNetworkFile(files[i]);
+    }
+}
+
+void PipelineBenchmark::runRandomNetwork(unsigned nodes_number, unsigned avarage_inputs_per_node, bool scale_free,
+        double probability_canalyzing_function, unsigned seed)
+{
+    std::stringstream name;
+    name << "rbn_n" << nodes_number << "_k" << avarage_inputs_per_node << (scale_free ? "_sf" : "_er")
+            << "_c" << probability_canalyzing_function << "_s" << seed;
+
+    RandomNumberGenerator::Instance()->Reseed(seed);
+    beginStage();
+    RandomBooleanNetwork network(nodes_number, avarage_inputs_per_node, scale_free, probability_canalyzing_function);
+    endStage(name.str(), "generate");
+    runPipeline(name.str(), network);
+}
+
+void PipelineBenchmark::runRandomNetworkGrid(const std::vector<unsigned>& nodes_numbers,
+        const std::vector<unsigned>& avarage_inputs_per_node, const std::vector<bool>& scale_free,
+        const std::vector<double>& probabilities_canalyzing_function, unsigned seed)
+{
+    for (unsigned n=0; n<nodes_numbers.size(); n++)
+    {
+        for (unsigned k=0; k<avarage_inputs_per_node.size(); k++)
+        {
+            for (unsigned s=0; s<scale_free.size(); s++)
+            {
+                for (unsigned p=0; p<probabilities_canalyzing_function.size(); p++)
+                {
+                    runRandomNetwork(nodes_numbers[n], avarage_inputs_per_node[k], scale_free[s],
+                            probabilities_canalyzing_function[p], seed);
+                }
+            }
+        }
+    }
+}
+
+const std::vector<BenchmarkMeasure>& PipelineBenchmark::getMeasures() const
+{
+    return mMeasures;
+}
+
+void PipelineBenchmark::printMeasuresToFile(const std::string directory, const std::string filename) const
+{
+    if (directory.empty())
+        EXCEPTION("Directory name not valid.");
+
+    OutputFileHandler handler(directory,false);
+    out_stream p_file = handler.OpenOutputFile(filename);
+
+    *p_file << "#This file has been generated by CoGNaC\n";
+    *p_file << "#network\tstage\tseconds\tpeak_rss_kb\tbdd_nodes_produced\tbdd_nodes_in_use\tgene_updates_per_second\n";
+    for (unsigned i=0; i<mMeasures.size(); i++)
+    {
+        *p_file << mMeasures[i].network << "\t" << mMeasures[i].stage << "\t" << mMeasures[i].seconds
+                << "\t" << mMeasures[i].peakRss << "\t" << mMeasures[i].bddNodesProduced
+                << "\t" << mMeasures[i].bddNodesInUse << "\t" << mMeasures[i].geneUpdatesPerSecond << "\n";
+    }
+    p_file->close();
+}
+
+std::vector<std::string> PipelineBenchmark::compareWithBaseline(const std::string baseline_path, double tolerance,
+        double min_seconds) const
+{
+    std::ifstream input_file(baseline_path.c_str());
+    if (!input_file.is_open())
+        EXCEPTION("Not able to open the file.");
+
+    std::map<std::pair<std::string,std::string>, BenchmarkMeasure> baseline;
+    std::string line;
+    std::vector<std::string> strs;
+    while (std::getline(input_file, line))
+    {
+        boost::algorithm::trim(line);
+        if (line.empty() || line[0] == '#') continue;
+        boost::split(strs, line, boost::is_any_of("\t"));
+        /* Baselines saved before the kernel stages have 6 columns. */
+        if (strs.size() != 6 && strs.size() != 7)
+            EXCEPTION("Error reading the file.");
+        BenchmarkMeasure measure;
+        try
+        {
+            measure.network = strs[0];
+            measure.stage = strs[1];
+            measure.seconds = boost::lexical_cast<double>(strs[2]);
+            measure.peakRss = boost::lexical_cast<long>(strs[3]);
+            measure.bddNodesProduced = boost::lexical_cast<long>(strs[4]);
+            measure.bddNodesInUse = boost::lexical_cast<long>(strs[5]);
+            measure.geneUpdatesPerSecond = strs.size() == 7 ? boost::lexical_cast<double>(strs[6]) : 0.0;
+        }
+        catch (boost::bad_lexical_cast&)
+        {
+            EXCEPTION("Error reading the file.");
+        }
+        baseline[std::make_pair(measure.network, measure.stage)] = measure;
+    }
+
+    std::vector<std::string> regressions;
+    for (unsigned i=0; i<mMeasures.size(); i++)
+    {
+        const BenchmarkMeasure& r_measure = mMeasures[i];
+        std::map<std::pair<std::string,std::string>, BenchmarkMeasure>::const_iterator it =
+                baseline.find(std::make_pair(r_measure.network, r_measure.stage));
+        if (it == baseline.end()) continue;
+        const BenchmarkMeasure& r_baseline = it->second;
+
+        std::stringstream message;
+        if (r_measure.seconds >= min_seconds && r_measure.seconds > r_baseline.seconds * (1.0 + tolerance))
+        {
+            message << " time " << r_baseline.seconds << "s -> " << r_measure.seconds << "s";
+        }
+        if (r_measure.peakRss > r_baseline.peakRss * (1.0 + tolerance))
+        {
+            message << " peak RSS " << r_baseline.peakRss << "kB -> " << r_measure.peakRss << "kB";
+        }
+        if (r_measure.bddNodesProduced > r_baseline.bddNodesProduced * (1.0 + tolerance))
+        {
+            message << " BDD nodes " << r_baseline.bddNodesProduced << " -> " << r_measure.bddNodesProduced;
+        }
+        if (r_measure.seconds >= min_seconds
+                && r_measure.geneUpdatesPerSecond < r_baseline.geneUpdatesPerSecond * (1.0 - tolerance))
+        {
+            message << " gene updates/s " << r_baseline.geneUpdatesPerSecond << " -> "
+                    << r_measure.geneUpdatesPerSecond;
+        }
+        if (!message.str().empty())
+        {
+            regressions.push_back(r_measure.network + " " + r_measure.stage + ":" + message.str());
+        }
+    }
+    return regressions;
+}
+
+double getWallTime()
+{
+    timeval time;
+    gettimeofday(&time, NULL);
+    return time.tv_sec + time.tv_usec * 1e-6;
+}
+
+long getBddNodesProduced()
+{
+    if (!bdd_isrunning())
+    {
+        return 0;
+    }
+    bddStat statistics;
+    bdd_stats(&statistics);
+    return statistics.produced;
+}
@@ -0,0 +1,182 @@
+#ifndef PIPELINEBENCHMARK_HPP_
+#define PIPELINEBENCHMARK_HPP_
+
+#include "RandomBooleanNetwork.hpp"
+#include "Exception.hpp"
+#include <vector>
+#include <string>
+
+/**
+ * The cost of a stage of the pipeline on a network.
+ */
+struct BenchmarkMeasure
+{
+    /** The name of the network (file name or parameters of the generator) */
+    std::string network;
+
+    /** The name of the stage */
+    std::string stage;
+
+    /** The wall-clock time of the stage, in seconds */
+    double seconds;
+
+    /** The peak resident set size of the process at the end of the stage, in kB */
+    long peakRss;
+
+    /** The BDD nodes produced during the stage */
+    long bddNodesProduced;
+
+    /** The BDD nodes in use at the end of the stage */
+    long bddNodesInUse;
+
+    /** The gene updates per second of a kernel stage, 0 for the other stages */
+    double geneUpdatesPerSecond;
+};
+
+/**
+ * Benchmark of the whole pipeline: parse (or generate) a network, find
+ * its attractors, compute the ATN, build a
+ * ThresholdErgodicSetDifferentiationTree and its differentiation tree.
+ * Then the throughput of the BitSlicedNetworkKernel is measured on the
+ * network, with every instruction set supported by the CPU.
+ * Every stage is measured separately; the measures can be saved as a
+ * baseline and later runs compared with it.
+ *
+ * Buddy must be initialised. The measures of a network are taken in one
+ * process, so the peak RSS of a stage includes the previous networks.
+ */
+class PipelineBenchmark
+{
+public:
+
+    /** The number of trajectories updated at once by the kernel stages */
+    static const unsigned KERNEL_TRAJECTORIES = 4096;
+
+    /** The number of synchronous steps between two checks of the time in the kernel stages */
+    static const unsigned KERNEL_STEPS = 100;
+
+    /** The minimum duration of a kernel stage, in milliseconds, so its throughput is stable */
+    static const unsigned KERNEL_MILLISECONDS = 200;
+
+private:
+
+    /** The measures taken so far */
+    std::vector<BenchmarkMeasure> mMeasures;
+
+    /** The time at the beginning of the current stage, in seconds */
+    double mStageBeginning;
+
+    /** The BDD nodes produced before the current stage */
+    long mStageBddNodesProduced;
+
+    /**
+     * Start measuring a stage.
+     */
+    void beginStage();
+
+    /**
+     * Stop measuring a stage and store the measure.
+     *
+     * @param rNetwork the name of the network
+     * @param rStage the name of the stage
+     */
+    void endStage(const std::string& rNetwork, const std::string& rStage);
+
+    /**
+     * Run the stages after the creation of the network.
+     *
+     * @param rName the name of the network
+     * @param rNetwork the network
+     */
+    void runPipeline(const std::string& rName, RandomBooleanNetwork& rNetwork);
+
+    /**
+     * Measure the gene updates per second of the BitSlicedNetworkKernel
+     * with every instruction set supported by the CPU, in the stages
+     * "kernel_scalar", "kernel_AVX2" and "kernel_AVX-512".
+     *
+     * @param rName the name of the network
+     * @param rNetwork the network
+     */
+    void runKernelStages(const std::string& rName, const RandomBooleanNetwork& rNetwork);
+
+public:
+
+    /**
+     * Constructor.
+     */
+    PipelineBenchmark();
+
+    /**
+     * Run the pipeline on a network file (.net or .cnet).
+     *
+     * @param file_path the path of the file
+     */
+    void runNetworkFile(const std::string file_path);
+
+    /**
+     * Run the pipeline on every .net and .cnet file of a folder, in
+     * alphabetical order.
+     *
+     * @param directory the path of the folder
+     */
+    void runNetworkFiles(const std::string directory);
+
+    /**
+     * Run the pipeline on a network of the generator.
+     *
+     * @param nodes_number number of nodes
+     * @param avarage_inputs_per_node average number of inputs per node
+     * @param scale_free whether the topology is scale free
+     * @param probability_canalyzing_function probability that a function is canalyzing
+     * @param seed the seed of the RandomNumberGenerator
+     */
+    void runRandomNetwork(unsigned nodes_number, unsigned avarage_inputs_per_node, bool scale_free,
+            double probability_canalyzing_function, unsigned seed);
+
+    /**
+     * Run the pipeline on all the combinations of the parameters of the generator.
+     *
+     * @param nodes_numbers the numbers of nodes
+     * @param avarage_inputs_per_node the average numbers of inputs per node
+     * @param scale_free the topologies (false: random, true: scale free)
+     * @param probabilities_canalyzing_function the probabilities of canalyzing functions
+     * @param seed the seed of the RandomNumberGenerator for every network
+     */
+    void runRandomNetworkGrid(const std::vector<unsigned>& nodes_numbers,
+            const std::vector<unsigned>& avarage_inputs_per_node, const std::vector<bool>& scale_free,
+            const std::vector<double>& probabilities_canalyzing_function, unsigned seed);
+
+    /**
+     * @return the measures taken so far.
+     */
+    const std::vector<BenchmarkMeasure>& getMeasures() const;
+
+    /**
+     * Save the measures in a tab-separated file, which can be used as a
+     * baseline: one row per network and stage.
+     *
+     * @param directory the name of the subfolder of testoutput.
+     * @param filename the name of the output file.
+     */
+    void printMeasuresToFile(const std::string directory, const std::string filename) const;
+
+    /**
+     * Compare the measures with a baseline saved by printMeasuresToFile().
+     * A stage is a regression if its time, peak RSS or BDD nodes produced
+     * exceed the baseline by more than the tolerance, or if its gene
+     * updates per second are below the baseline by more than the tolerance. Times shorter than
+     * min_seconds are ignored, being too noisy. Stages missing from the
+     * baseline are skipped.
+     *
+     * @param baseline_path the path of the baseline file
+     * @param tolerance the relative tolerance (e.g. 0.2 for 20%)
+     * @param min_seconds times below this value are not compared
+     *
+     * @return a description of every regression.
+     */
+    std::vector<std::string> compareWithBaseline(const std::string baseline_path, double tolerance,
+            double min_seconds = 0.05) const;
+};
+
+#endif /* PIPELINEBENCHMARK_HPP_ */
@@ -0,0 +1,74 @@
+#include "PrunedMatrixCache.hpp"
+#include <cstddef>
+
+PrunedMatrixCache::PrunedMatrixCache(const StochasticMatrix& rMatrix) :
+mrMatrix(rMatrix),
+mDistributionsNumber(0)
+{
+}
+
+const StochasticMatrixView& PrunedMatrixCache::getPrunedMatrix(double threshold)
+{
+    std::map<double, StochasticMatrixView>::iterator iterator = mViews.find(threshold);
+    if (iterator == mViews.end())
+    {
+        StochasticMatrixView view = (threshold < 1.0) ? StochasticMatrixView(mrMatrix, threshold)
+                : StochasticMatrixView(mrMatrix);
+        iterator = mViews.insert(std::pair<double, StochasticMatrixView>(threshold, view)).first;
+    }
+    return iterator->second;
+}
+
+const std::vector<double>& PrunedMatrixCache::getStationaryDistribution(double threshold,
+        const std::vector<unsigned>& rComponent, const StationaryDistributionSolver& rSolver)
+{
+    const std::vector<double>* p_distribution = findStationaryDistribution(threshold, rComponent);
+    if (p_distribution != NULL)
+    {
+        return *p_distribution;
+    }
+    return addStationaryDistribution(threshold, rComponent, rSolver.solve(getPrunedMatrix(threshold), rComponent));
+}
+
+const std::vector<double>* PrunedMatrixCache::findStationaryDistribution(double threshold,
+        const std::vector<unsigned>& rComponent) const
+{
+    std::map<double, std::map<std::vector<unsigned>, std::vector<double> > >::const_iterator threshold_iterator =
+            mDistributions.find(threshold);
+    if (threshold_iterator == mDistributions.end()) return NULL;
+    std::map<std::vector<unsigned>, std::vector<double> >::const_iterator iterator =
+            threshold_iterator->second.find(rComponent);
+    if (iterator == threshold_iterator->second.end()) return NULL;
+    return &iterator->second;
+}
+
+const std::vector<double>& PrunedMatrixCache::addStationaryDistribution(double threshold,
+        const std::vector<unsigned>& rComponent, const std::vector<double>& rDistribution)
+{
+    std::map<std::vector<unsigned>, std::vector<double> >& r_distributions = mDistributions[threshold];
+    std::map<std::vector<unsigned>, std::vector<double> >::iterator iterator = r_distributions.find(rComponent);
+    if (iterator == r_distributions.end())
+    {
+        iterator = r_distributions.insert(std::pair<std::vector<unsigned>, std::vector<double> >(rComponent,
+                rDistribution)).first;
+        mDistributionsNumber++;
+    }
+    return iterator->second;
+}
+
+unsigned PrunedMatrixCache::getPrunedMatricesNumber() const
+{
+    return mViews.size();
+}
+
+unsigned PrunedMatrixCache::getStationaryDistributionsNumber() const
+{
+    return mDistributionsNumber;
+}
+
+void PrunedMatrixCache::clear()
+{
+    mViews.clear();
+    mDistributions.clear();
+    mDistributionsNumber = 0;
+}
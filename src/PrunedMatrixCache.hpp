@@ -0,0 +1,99 @@
+#ifndef PRUNEDMATRIXCACHE_HPP_
+#define PRUNEDMATRIXCACHE_HPP_
+
+#include "StochasticMatrix.hpp"
+#include "StationaryDistributionSolver.hpp"
+#include <vector>
+#include <map>
+
+/**
+ * The pruned matrices of a StochasticMatrix and the stationary
+ * distributions of their components, computed once per threshold and
+ * kept until clear() is called. The references returned stay valid
+ * until then.
+ *
+ * At threshold 1 (or more) every entry would be pruned, so the matrix is
+ * taken as it is, as in ThresholdErgodicSetDifferentiationTree.
+ *
+ * The cache is not thread safe: it must be filled by one thread at a time.
+ */
+class PrunedMatrixCache
+{
+private:
+
+    /** The matrix */
+    const StochasticMatrix& mrMatrix;
+
+    /** The pruned matrix at every threshold */
+    std::map<double, StochasticMatrixView> mViews;
+
+    /** The stationary distribution of every component, at every threshold */
+    std::map<double, std::map<std::vector<unsigned>, std::vector<double> > > mDistributions;
+
+    /** The number of distributions in mDistributions */
+    unsigned mDistributionsNumber;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rMatrix the matrix (it must live as long as this object)
+     */
+    PrunedMatrixCache(const StochasticMatrix& rMatrix);
+
+    /**
+     * @param threshold the threshold
+     *
+     * @return the pruned matrix at the threshold.
+     */
+    const StochasticMatrixView& getPrunedMatrix(double threshold);
+
+    /**
+     * @param threshold the threshold
+     * @param rComponent the states of the component, in ascending order
+     * @param rSolver the solver used if the distribution is not cached
+     *
+     * @return the stationary distribution of the component in the pruned
+     * matrix at the threshold, in the order of rComponent.
+     */
+    const std::vector<double>& getStationaryDistribution(double threshold, const std::vector<unsigned>& rComponent,
+            const StationaryDistributionSolver& rSolver);
+
+    /**
+     * @param threshold the threshold
+     * @param rComponent the states of the component, in ascending order
+     *
+     * @return the cached distribution, or NULL if it was never computed.
+     */
+    const std::vector<double>* findStationaryDistribution(double threshold, const std::vector<unsigned>& rComponent) const;
+
+    /**
+     * Store a distribution computed outside the cache (e.g. by another thread).
+     *
+     * @param threshold the threshold
+     * @param rComponent the states of the component, in ascending order
+     * @param rDistribution the stationary distribution
+     *
+     * @return the cached distribution.
+     */
+    const std::vector<double>& addStationaryDistribution(double threshold, const std::vector<unsigned>& rComponent,
+            const std::vector<double>& rDistribution);
+
+    /**
+     * @return the number of pruned matrices.
+     */
+    unsigned getPrunedMatricesNumber() const;
+
+    /**
+     * @return the number of stationary distributions.
+     */
+    unsigned getStationaryDistributionsNumber() const;
+
+    /**
+     * Remove every pruned matrix and distribution.
+     */
+    void clear();
+};
+
+#endif /* PRUNEDMATRIXCACHE_HPP_ */
@@ -1,9 +1,18 @@
 #include "RandomBooleanNetwork.hpp"
 #include "RandomNumberGenerator.hpp"
+#include "TruthTableNetwork.hpp"
+#include "BitSlicedNetworkKernel.hpp"
+#include "SplitMixRandomGenerator.hpp"
+#include "Instrumentation.hpp"
+#include "BddMemoryPolicy.hpp"
 #include <math.h>
 #include <cassert>
+#include <cstdlib>
+#include <cstdio>
+#include <algorithm>
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
+#include <sys/time.h>
 
 /**
  * Default bddallsathandler defined by buddy for allsat()
@@ -20,10 +29,38 @@ void allsatHandlerPrintToStringBuffer(char *varset,int size);
 /** String buffer used for print functions */
 std::vector<std::string> stringBuffer;
 
+/**
+ * Flip every bit of a bit-sliced buffer with a given probability. The
+ * distance between two flips is geometric, so the cost is proportional
+ * to the number of flips and not to the number of bits.
+ *
+ * @param rSliced the bit-sliced states
+ * @param probability the probability of flipping a bit (in (0,1])
+ * @param rGenerator the random generator of the batch
+ */
+void flipBitsAtRandom(std::vector<uint64_t>& rSliced, double probability, SplitMixRandomGenerator& rGenerator);
+
+/**
+ * @return the wall-clock time, in seconds.
+ */
+static inline double getSearchClock()
+{
+    timeval time;
+    gettimeofday(&time, NULL);
+    return time.tv_sec + time.tv_usec * 1e-6;
+}
+
 RandomBooleanNetwork::RandomBooleanNetwork(unsigned nodes_number, unsigned avarage_inputs_per_node,
         bool scale_free, double probability_canalyzing_function) :
 mNodesNumber(nodes_number),
-mAverageInputsPerNode(avarage_inputs_per_node)
+mAverageInputsPerNode(avarage_inputs_per_node),
+mpSearchMonitor(NULL),
+mSearchTimeLimit(0.0),
+mSearchStartTime(0.0),
+mSearchCancelled(false),
+mAttractorSearchComplete(false),
+mCheckpointPath(),
+mCheckpointInterval(0.0)
 {
     if (mNodesNumber == 0 || mAverageInputsPerNode == 0 || mAverageInputsPerNode >= mNodesNumber)
         EXCEPTION("Constructor parameters not valid.");
@@ -53,10 +90,18 @@ mAverageInputsPerNode(avarage_inputs_per_node)
     for (unsigned node_id=0; node_id < mNodesNumber;node_id++){
         createBooleanFunction(node_id, RandomNumberGenerator::Instance()->ranf() <= probability_canalyzing_function);
     }
+    reserveBinaryDecisionDiagramNodes();
 }
 
 RandomBooleanNetwork::RandomBooleanNetwork(const std::string file_path,
-        double probability_canalyzing_function)
+        double probability_canalyzing_function) :
+mpSearchMonitor(NULL),
+mSearchTimeLimit(0.0),
+mSearchStartTime(0.0),
+mSearchCancelled(false),
+mAttractorSearchComplete(false),
+mCheckpointPath(),
+mCheckpointInterval(0.0)
 {
     if (probability_canalyzing_function < 0.0 || probability_canalyzing_function > 1.0)
         EXCEPTION("Range of a probability must be between 0 and 1.");
@@ -86,6 +131,7 @@ RandomBooleanNetwork::RandomBooleanNetwork(const std::string file_path,
             for (unsigned node_id=0; node_id < mNodesNumber;node_id++){
                 createBooleanFunction(node_id, RandomNumberGenerator::Instance()->ranf() <= probability_canalyzing_function);
             }
+            reserveBinaryDecisionDiagramNodes();
 
         } catch (Exception& e)
         {
@@ -94,7 +140,14 @@ RandomBooleanNetwork::RandomBooleanNetwork(const std::string file_path,
     } else EXCEPTION("Error in the file path.");
 }
 
-RandomBooleanNetwork::RandomBooleanNetwork(const std::string file_path)
+RandomBooleanNetwork::RandomBooleanNetwork(const std::string file_path) :
+mpSearchMonitor(NULL),
+mSearchTimeLimit(0.0),
+mSearchStartTime(0.0),
+mSearchCancelled(false),
+mAttractorSearchComplete(false),
+mCheckpointPath(),
+mCheckpointInterval(0.0)
 {
     if (file_path.size() > 4)
     {
@@ -103,6 +156,7 @@ RandomBooleanNetwork::RandomBooleanNetwork(const std::string file_path)
                     ||  file_path.compare(file_path.size()-4,4,"cnet") == 0)
             {
                 createNetworkFromNetFile(file_path);
+                reserveBinaryDecisionDiagramNodes();
             }
             else EXCEPTION("File format is not correct.");
         } catch (Exception& e)
@@ -512,11 +566,27 @@ void RandomBooleanNetwork::createGraphFromGmlFile(const std::string file_path)
 
 void RandomBooleanNetwork::initBinaryDecisionDiagram() const
 {
+    /* A function with k inputs has at most 2^k nodes. */
+    unsigned long function_nodes = 0;
+    for (unsigned i=0; i<mNodesNumber; i++)
+    {
+        function_nodes += 1ul << std::min(mpRbnGraph->getIncomingVerticesNumberById(i), 16u);
+    }
+    BddMemoryPolicy::initialise(BddMemoryPolicy::estimateNodesNumber(mNodesNumber, function_nodes));
     bdd_setvarnum(mNodesNumber * 2);
-    bdd_setcacheratio(64);
     bdd_varblockall();
 }
 
+void RandomBooleanNetwork::reserveBinaryDecisionDiagramNodes() const
+{
+    unsigned long function_nodes = bdd_nodecount(*mpReverseTransitionFunction);
+    for (unsigned i=0; i<mNodesNumber; i++)
+    {
+        function_nodes += bdd_nodecount(mpNodeFunction[i]);
+    }
+    BddMemoryPolicy::reserveNodes(BddMemoryPolicy::estimateNodesNumber(mNodesNumber, function_nodes));
+}
+
 void RandomBooleanNetwork::createBooleanFunction(unsigned node_id, bool canalyzing_function)
 {
     assert(node_id < mNodesNumber);
@@ -664,6 +734,7 @@ bdd RandomBooleanNetwork::find_next_cycles(bddPair* variables_pair){
     for(unsigned i = 0; i < mNodesNumber; i++){
         mpNodeNthFunction[i] = bdd_veccompose(mpNodeNthFunction[i], variables_pair);
     }
+    Instrumentation::increment(Instrumentation::FUNCTION_COMPOSITIONS);
 
     bdd new_states = bddtrue;
     for (unsigned i = 0; i < mNodesNumber; i++) {
@@ -686,6 +757,7 @@ bdd RandomBooleanNetwork::find_backward_reachable_states(bdd current_ring, bdd s
     {
         states = bdd_appex(states, *mpReverseTransitionFunction, bddop_and, set_variables);
         states = bdd_replace(states, variables_pair);
+        Instrumentation::increment(Instrumentation::PREIMAGES);
         if (current_ring == (current_ring | states)) {
             ring_found = true;
         }
@@ -694,7 +766,7 @@ bdd RandomBooleanNetwork::find_backward_reachable_states(bdd current_ring, bdd s
             length++;
             current_ring |= states;
         }
-    } while (states != bddfalse && !ring_found && current_ring != bddtrue);
+    } while (states != bddfalse && !ring_found && current_ring != bddtrue && !isSearchStopped());
     if (length > steps_max)
     {
         steps_max = length;
@@ -705,76 +777,593 @@ bdd RandomBooleanNetwork::find_backward_reachable_states(bdd current_ring, bdd s
 void RandomBooleanNetwork::findAttractors()
 {
     assert(mNodesNumber > 0);
+    ScopedPhase phase("findAttractors");
 
-    if (mAttractors.empty()) {
+    if (mAttractors.empty() || !mAttractorSearchComplete) {
+        /* An interrupted search starts again from the functions of the nodes. */
+        mAttractors.clear();
         mAttractorLength.clear();
-        unsigned j = 1;
-        unsigned steps_max = 1;
-        /* such as forall x, F^{step_max} (x) = y
-         * where y is a state of an attractor. */
-        bddPair* replace_backward_assignment;
-        bddPair* replace_forward_assignment;
-        replace_backward_assignment = bdd_newpair();
-        replace_forward_assignment = bdd_newpair();
-
-        bdd explored_states = bddfalse; //totalR
-        bdd states_return_to_themself = bddtrue; //I
+        for (unsigned i=0; i<mNodesNumber; i++)
+        {
+            mpNodeNthFunction[i] = mpNodeFunction[i];
+        }
+        searchAttractors(bddfalse, 1, 1);
+    } // ELSE ALREADY FOUND!
 
-        int* p_variables_id = new int[mNodesNumber];
-        int* p_next_variables_id = new int[mNodesNumber];
+}
+
+void RandomBooleanNetwork::resumeAttractorSearch(const std::string file_path)
+{
+    assert(mNodesNumber > 0);
+    ScopedPhase phase("findAttractors");
 
-        int index = 0;
-        for(unsigned i = 0; i < mNodesNumber; i++){
+    bdd explored_states;
+    unsigned j;
+    unsigned steps_max;
+    loadSearchCheckpoint(file_path, explored_states, j, steps_max);
+    searchAttractors(explored_states, j, steps_max);
+}
+
+void RandomBooleanNetwork::searchAttractors(bdd explored_states, unsigned j, unsigned steps_max)
+{
+    BddMemoryPolicy::clearNodesLimitReached();
+    mSearchStartTime = getSearchClock();
+    bool stopped = false;
+    /* steps_max is such as forall x, F^{step_max} (x) = y
+     * where y is a state of an attractor. */
+    bddPair* replace_backward_assignment;
+    bddPair* replace_forward_assignment;
+    replace_backward_assignment = bdd_newpair();
+    replace_forward_assignment = bdd_newpair();
+
+    bdd states_return_to_themself = bddtrue; //I
+
+    int* p_variables_id = new int[mNodesNumber];
+    int* p_next_variables_id = new int[mNodesNumber];
+
+    int index = 0;
+    for(unsigned i = 0; i < mNodesNumber; i++){
+        if (j == 1)
+        {
             states_return_to_themself &= bdd_apply(mpVariables[i], mpNodeNthFunction[i], bddop_biimp);
-            p_variables_id[i] = index*2;
-            p_next_variables_id[i] = index*2 +1;
-            index++;
         }
-        bdd_setpairs(replace_backward_assignment, p_next_variables_id, p_variables_id, mNodesNumber);
-        bdd_setbddpairs(replace_forward_assignment, p_variables_id, mpNodeNthFunction, mNodesNumber);
-        bdd set_variables = bdd_makeset(p_variables_id, mNodesNumber);
+        p_variables_id[i] = index*2;
+        p_next_variables_id[i] = index*2 +1;
+        index++;
+    }
+    bdd_setpairs(replace_backward_assignment, p_next_variables_id, p_variables_id, mNodesNumber);
+    bdd_setbddpairs(replace_forward_assignment, p_variables_id, mpNodeFunction, mNodesNumber);
+    bdd set_variables = bdd_makeset(p_variables_id, mNodesNumber);
 
+    delete[] p_variables_id;
+    delete[] p_next_variables_id;
+    p_variables_id = NULL;
+    p_next_variables_id = NULL;
+
+    /* The state at the beginning of the current step, which is the one
+     * saved in the checkpoint: a step interrupted in the middle of the
+     * backward search has not explored the whole basin of its attractors. */
+    bdd step_explored_states;
+    unsigned step_j = j;
+    unsigned step_steps_max = steps_max;
+    unsigned step_attractors_number = mAttractors.size();
+    std::vector<bdd> step_functions;
+    double last_checkpoint_time = mSearchStartTime;
+
+    while(explored_states != bddtrue)
+    {
+        step_attractors_number = mAttractors.size();
+        if (!mCheckpointPath.empty())
+        {
+            step_explored_states = explored_states;
+            step_j = j;
+            step_steps_max = steps_max;
+            step_functions.assign(mpNodeNthFunction, mpNodeNthFunction + mNodesNumber);
+            if (mCheckpointInterval > 0.0 && getSearchClock() - last_checkpoint_time >= mCheckpointInterval)
+            {
+                saveSearchCheckpoint(step_explored_states, step_j, step_steps_max,
+                        step_attractors_number, step_functions);
+                last_checkpoint_time = getSearchClock();
+            }
+        }
+        if (mpSearchMonitor)
+        {
+            AttractorSearchProgress progress;
+            progress.exploredFraction = explored_states == bddfalse ? 0.0 :
+                    pow(2.0, bdd_satcountlnset(explored_states, set_variables) - mNodesNumber);
+            progress.step = j;
+            progress.attractorsNumber = mAttractors.size();
+            progress.elapsedSeconds = getSearchClock() - mSearchStartTime;
+            if (!mpSearchMonitor->reportProgress(progress))
+            {
+                mSearchCancelled = true;
+            }
+        }
+        if (isSearchStopped())
+        {
+            stopped = true;
+            break;
+        }
+        if(j > 1)
+        {
+            states_return_to_themself = find_next_cycles(replace_forward_assignment);
+            if (states_return_to_themself == bddtrue)
+            {
+                storageAttractors((!explored_states), j, set_variables, replace_backward_assignment);
+                break;
+            }
+
+            states_return_to_themself = states_return_to_themself - explored_states;
+            if(states_return_to_themself == bddfalse){
+                j++;
+                continue;
+            }
+        }
+        j++;
+        bdd current_ring = bddfalse;
+        storageAttractors(states_return_to_themself, j-1, set_variables, replace_backward_assignment);
+        current_ring |= states_return_to_themself;
+        explored_states |= find_backward_reachable_states(current_ring,
+                        states_return_to_themself,set_variables, replace_backward_assignment, steps_max);
+        if (isSearchStopped())
+        {
+            stopped = true;
+            break;
+        }
+    }
+    mAttractorSearchComplete = !stopped;
+    if (stopped && BddMemoryPolicy::isNodesLimitReached())
+    {
+        /* The BDDs computed after the node table was full are not valid. */
+        mAttractors.resize(step_attractors_number);
+        mAttractorLength.resize(step_attractors_number);
+    }
+    if (stopped && !mCheckpointPath.empty())
+    {
+        saveSearchCheckpoint(step_explored_states, step_j, step_steps_max,
+                step_attractors_number, step_functions);
+    }
+    /* After a complete search F^steps_max maps every state in an attractor. */
+    if (!stopped && steps_max > j-1)
+    {
+        steps_max -= j-1;
+        do {
+            for(unsigned i = 0; i < mNodesNumber; i++){
+                mpNodeNthFunction[i] = bdd_veccompose(mpNodeNthFunction[i], replace_forward_assignment);
+            }
+            Instrumentation::increment(Instrumentation::FUNCTION_COMPOSITIONS);
+            steps_max --;
+        } while (steps_max > 0);
+        mAttractorSearchComplete = !BddMemoryPolicy::isNodesLimitReached();
+    }
+    bdd_freepair(replace_backward_assignment);
+    bdd_freepair(replace_forward_assignment);
+    /* The flag is cleared when the search ends, not when it begins, so a
+     * cancellation requested before the first check is not lost. */
+    mSearchCancelled = false;
+}
+
+void RandomBooleanNetwork::setSearchCheckpoint(const std::string file_path, double interval_seconds)
+{
+    if (interval_seconds < 0.0)
+        EXCEPTION("The checkpoint interval must be >= 0.");
+    mCheckpointPath = file_path;
+    mCheckpointInterval = interval_seconds;
+}
+
+void RandomBooleanNetwork::saveSearchCheckpoint(bdd explored_states, unsigned j, unsigned steps_max,
+        unsigned attractors_number, const std::vector<bdd>& rNthFunctions) const
+{
+    assert(rNthFunctions.size() == mNodesNumber);
+    assert(attractors_number <= mAttractors.size());
+
+    std::string temporary_path = mCheckpointPath + ".tmp";
+    FILE* p_file = fopen(temporary_path.c_str(), "w");
+    if (p_file == NULL)
+        EXCEPTION("Not able to open the file.");
+
+    fprintf(p_file, "#This file has been generated by CoGNaC\n");
+    fprintf(p_file, "#Checkpoint of the attractor search\n");
+    fprintf(p_file, "nodes %u\nstep %u\nsteps_max %u\nattractors %u\n",
+            mNodesNumber, j, steps_max, attractors_number);
+    for (unsigned i=0; i<attractors_number; i++)
+    {
+        fprintf(p_file, "%u\n", mAttractorLength[i]);
+    }
+    /* The functions of the nodes identify the network. */
+    bool saved = true;
+    for (unsigned i=0; i<mNodesNumber && saved; i++)
+    {
+        saved = bdd_save(p_file, mpNodeFunction[i]) == 0;
+    }
+    saved = saved && bdd_save(p_file, explored_states) == 0;
+    for (unsigned i=0; i<mNodesNumber && saved; i++)
+    {
+        saved = bdd_save(p_file, rNthFunctions[i]) == 0;
+    }
+    for (unsigned i=0; i<attractors_number && saved; i++)
+    {
+        saved = bdd_save(p_file, mAttractors[i]) == 0;
+    }
+    saved = fclose(p_file) == 0 && saved;
+    if (!saved || rename(temporary_path.c_str(), mCheckpointPath.c_str()) != 0)
+    {
+        remove(temporary_path.c_str());
+        EXCEPTION("Error writing the checkpoint.");
+    }
+}
+
+void RandomBooleanNetwork::loadSearchCheckpoint(const std::string file_path, bdd& rExploredStates,
+        unsigned& rJ, unsigned& rStepsMax)
+{
+    FILE* p_file = fopen(file_path.c_str(), "r");
+    if (p_file == NULL)
+        EXCEPTION("Not able to open the file.");
+
+    char p_line[256];
+    unsigned nodes_number = 0;
+    unsigned attractors_number = 0;
+    bool read = fgets(p_line, sizeof(p_line), p_file) != NULL
+            && fgets(p_line, sizeof(p_line), p_file) != NULL
+            && fscanf(p_file, " nodes %u step %u steps_max %u attractors %u",
+                    &nodes_number, &rJ, &rStepsMax, &attractors_number) == 4
+            && rJ > 0;
+    std::vector<unsigned> lengths(read ? attractors_number : 0);
+    for (unsigned i=0; i<lengths.size() && read; i++)
+    {
+        read = fscanf(p_file, "%u", &lengths[i]) == 1;
+    }
+    if (!read)
+    {
+        fclose(p_file);
+        EXCEPTION("Error reading the file.");
+    }
+    bool same_network = nodes_number == mNodesNumber;
+    for (unsigned i=0; i<mNodesNumber && read && same_network; i++)
+    {
+        bdd function;
+        read = bdd_load(p_file, function) == 0;
+        same_network = !read || function == mpNodeFunction[i];
+    }
+    if (!same_network)
+    {
+        fclose(p_file);
+        EXCEPTION("The checkpoint does not match the network.");
+    }
+    std::vector<bdd> functions(mNodesNumber);
+    std::vector<bdd> attractors(attractors_number);
+    read = read && bdd_load(p_file, rExploredStates) == 0;
+    for (unsigned i=0; i<mNodesNumber && read; i++)
+    {
+        read = bdd_load(p_file, functions[i]) == 0;
+    }
+    for (unsigned i=0; i<attractors_number && read; i++)
+    {
+        read = bdd_load(p_file, attractors[i]) == 0;
+    }
+    fclose(p_file);
+    if (!read)
+        EXCEPTION("Error reading the file.");
+
+    std::copy(functions.begin(), functions.end(), mpNodeNthFunction);
+    mAttractors = attractors;
+    mAttractorLength = lengths;
+    mAttractorSearchComplete = false;
+}
+
+void RandomBooleanNetwork::setSearchMonitor(AbstractAttractorSearchMonitor* p_monitor)
+{
+    mpSearchMonitor = p_monitor;
+}
+
+void RandomBooleanNetwork::setSearchTimeLimit(double seconds)
+{
+    if (seconds < 0.0)
+        EXCEPTION("The time limit must be >= 0.");
+    mSearchTimeLimit = seconds;
+}
+
+void RandomBooleanNetwork::cancelSearch()
+{
+    mSearchCancelled = true;
+}
+
+bool RandomBooleanNetwork::isAttractorSearchComplete() const
+{
+    return mAttractorSearchComplete;
+}
+
+bool RandomBooleanNetwork::isSearchStopped() const
+{
+    return mSearchCancelled
+            || BddMemoryPolicy::isNodesLimitReached()
+            || (mSearchTimeLimit > 0.0 && getSearchClock() - mSearchStartTime > mSearchTimeLimit);
+}
+
+void RandomBooleanNetwork::findAttractorsModular()
+{
+    assert(mNodesNumber > 0);
+    ScopedPhase phase("findAttractorsModular");
+
+    if (mAttractors.empty() || !mAttractorSearchComplete)
+    {
+        mAttractors.clear();
+        mAttractorLength.clear();
+        ArrayDirectedGraph* p_dependency_graph = getDependencyGraph();
+        std::vector<unsigned> node_components;
+        unsigned modules_number = p_dependency_graph->getStronglyConnectedComponents(node_components);
+        delete p_dependency_graph;
+
+        std::vector<std::vector<unsigned> > modules(modules_number);
+        for (unsigned node=0; node<mNodesNumber; node++)
+        {
+            modules.at(node_components.at(node)).push_back(node);
+        }
+
+        bddPair* replace_backward_assignment = bdd_newpair();
+        bddPair* replace_forward_assignment = bdd_newpair();
+        int* p_variables_id = new int[mNodesNumber];
+        int* p_next_variables_id = new int[mNodesNumber];
+        for (unsigned i=0; i<mNodesNumber; i++)
+        {
+            p_variables_id[i] = (int) i*2;
+            p_next_variables_id[i] = (int) i*2 + 1;
+        }
+        bdd_setpairs(replace_backward_assignment, p_next_variables_id, p_variables_id, mNodesNumber);
+        bdd_setpairs(replace_forward_assignment, p_variables_id, p_next_variables_id, mNodesNumber);
         delete[] p_variables_id;
         delete[] p_next_variables_id;
-        p_variables_id = NULL;
-        p_next_variables_id = NULL;
 
-        while(explored_states != bddtrue)
+        /* Before the first module no variable is involved: the only
+         * upstream "attractor" is the whole state space. */
+        std::vector<bdd> upstream_attractors(1, bddtrue);
+        std::vector<unsigned> upstream_attractor_length(1, 1u);
+        std::vector<bdd> upstream_transitions(1, bddtrue);
+        bdd upstream_variables = bddtrue;
+
+        for (unsigned module=0; module<modules_number; module++)
         {
-            if(j > 1)
+            /* A module only depends on itself and on the modules before it:
+             * its relation covers its own nodes, and the upstream nodes
+             * follow the cycle of the upstream attractor. */
+            bdd module_transition_function = bddtrue;
+            bdd module_variables = bddtrue;
+            for (unsigned i=0; i<modules.at(module).size(); i++)
             {
-                states_return_to_themself = find_next_cycles(replace_forward_assignment);
-                if (states_return_to_themself == bddtrue)
-                {
-                    storageAttractors((!explored_states), j, set_variables, replace_backward_assignment);
-                    break;
-                }
-
-                states_return_to_themself = states_return_to_themself - explored_states;
-                if(states_return_to_themself == bddfalse){
-                    j++;
-                    continue;
-                }
+                unsigned node = modules.at(module).at(i);
+                module_transition_function &= bdd_apply(mpNextVariables[node], mpNodeFunction[node], bddop_biimp);
+                module_variables &= mpVariables[node];
+            }
+            std::vector<bdd> driven_attractors;
+            std::vector<unsigned> driven_attractor_length;
+            std::vector<bdd> driven_transitions;
+            for (unsigned i=0; i<upstream_attractors.size(); i++)
+            {
+                findAttractorsInClosedStates(upstream_attractors.at(i), upstream_transitions.at(i), upstream_variables,
+                        module_transition_function, module_variables, replace_backward_assignment,
+                        replace_forward_assignment, driven_attractors, driven_attractor_length, driven_transitions);
             }
-            j++;
-            bdd current_ring = bddfalse;
-            storageAttractors(states_return_to_themself, j-1, set_variables, replace_backward_assignment);
-            current_ring |= states_return_to_themself;
-            explored_states |= find_backward_reachable_states(current_ring,
-                            states_return_to_themself,set_variables, replace_backward_assignment, steps_max);
+            upstream_attractors.swap(driven_attractors);
+            upstream_attractor_length.swap(driven_attractor_length);
+            upstream_transitions.swap(driven_transitions);
+            upstream_variables &= module_variables;
         }
-        if (steps_max > j-1)
+        bdd_freepair(replace_backward_assignment);
+        bdd_freepair(replace_forward_assignment);
+
+        mAttractors = upstream_attractors;
+        mAttractorLength = upstream_attractor_length;
+        mAttractorSearchComplete = true;
+    } // ELSE ALREADY FOUND!
+}
+
+void RandomBooleanNetwork::findParametrisedAttractors(const std::vector<unsigned>& input_nodes)
+{
+    assert(mNodesNumber > 0);
+    ScopedPhase phase("findParametrisedAttractors");
+
+    std::vector<bool> is_input(mNodesNumber, false);
+    for (unsigned i=0; i<input_nodes.size(); i++)
+    {
+        if (input_nodes[i] >= mNodesNumber)
+            EXCEPTION("Error, node id must be < number of nodes.");
+        if (is_input[input_nodes[i]])
+            EXCEPTION("Input nodes must be distinct.");
+        is_input[input_nodes[i]] = true;
+    }
+    mInputNodes = input_nodes;
+    mParametrisedAttractors.clear();
+
+    /* Input variables are neither quantified nor renamed, so they are
+     * carried unchanged through every image. */
+    bdd transition_function = bddtrue;
+    std::vector<int> variables_id;
+    std::vector<int> next_variables_id;
+    for (unsigned node=0; node<mNodesNumber; node++)
+    {
+        if (is_input[node]) continue;
+        transition_function &= bdd_apply(mpNextVariables[node], mpNodeFunction[node], bddop_biimp);
+        variables_id.push_back((int) node*2);
+        next_variables_id.push_back((int) node*2 + 1);
+    }
+    if (variables_id.empty())
+        EXCEPTION("At least a node must not be an input.");
+    bdd set_variables = bdd_makeset(&variables_id[0], variables_id.size());
+    bddPair* replace_backward_assignment = bdd_newpair();
+    bdd_setpairs(replace_backward_assignment, &next_variables_id[0], &variables_id[0], variables_id.size());
+
+    /* The images of the whole space decrease until, for every input
+     * combination, only the states of its attractors are left. */
+    bdd cycle_states = bddtrue;
+    bdd previous_states;
+    do
+    {
+        previous_states = cycle_states;
+        cycle_states = bdd_appex(previous_states, transition_function, bddop_and, set_variables);
+        cycle_states = bdd_replace(cycle_states, replace_backward_assignment);
+        Instrumentation::increment(Instrumentation::IMAGES);
+    } while (cycle_states != previous_states);
+
+    /* One state per input combination is followed at once: the orbits of
+     * shorter cycles close first, and we stop when all of them are closed. */
+    while (cycle_states != bddfalse)
+    {
+        bdd state = pickStatePerParameter(cycle_states, variables_id);
+        bdd attractor_states = bddfalse;
+        do
         {
-            steps_max -= j-1;
-            do {
-                for(unsigned i = 0; i < mNodesNumber; i++){
-                    mpNodeNthFunction[i] = bdd_veccompose(mpNodeNthFunction[i], replace_forward_assignment);
-                }
-                steps_max --;
-            } while (steps_max > 0);
+            attractor_states |= state;
+            state = bdd_appex(state, transition_function, bddop_and, set_variables);
+            state = bdd_replace(state, replace_backward_assignment);
+            Instrumentation::increment(Instrumentation::IMAGES);
+        } while ((state - attractor_states) != bddfalse);
+        cycle_states -= attractor_states;
+        mParametrisedAttractors.push_back(attractor_states);
+    }
+    bdd_freepair(replace_backward_assignment);
+}
+
+bdd RandomBooleanNetwork::pickStatePerParameter(bdd states, const std::vector<int>& variables_id) const
+{
+    bdd picked = states;
+    for (unsigned k=0; k<variables_id.size(); k++)
+    {
+        /* The variables before k are already a function of the parameters:
+         * the k-th is set to 0 wherever this is still possible. */
+        bdd remaining_variables = bdd_makeset(const_cast<int*>(&variables_id[k]), variables_id.size() - k);
+        bdd can_be_false = bdd_exist(picked & bdd_nithvar(variables_id[k]), remaining_variables);
+        picked &= bdd_apply(bdd_ithvar(variables_id[k]), !can_be_false, bddop_biimp);
+    }
+    return picked;
+}
+
+unsigned RandomBooleanNetwork::getParametrisedAttractorsNumber() const
+{
+    return mParametrisedAttractors.size();
+}
+
+bdd RandomBooleanNetwork::getParametrisedAttractor(unsigned index) const
+{
+    if (index >= mParametrisedAttractors.size())
+        EXCEPTION("Error, attractor index must be < number of attractors.");
+    return mParametrisedAttractors[index];
+}
+
+bdd RandomBooleanNetwork::getParametrisedAttractorInputs(unsigned index) const
+{
+    bdd state_variables = bddtrue;
+    std::vector<bool> is_input(mNodesNumber, false);
+    for (unsigned i=0; i<mInputNodes.size(); i++)
+    {
+        is_input[mInputNodes[i]] = true;
+    }
+    for (unsigned node=0; node<mNodesNumber; node++)
+    {
+        if (!is_input[node])
+        {
+            state_variables &= mpVariables[node];
         }
-    } // ELSE ALREADY FOUND!
+    }
+    return bdd_exist(getParametrisedAttractor(index), state_variables);
+}
+
+std::vector<bdd> RandomBooleanNetwork::getAttractorsForInputs(const std::vector<bool>& input_values,
+        std::vector<unsigned>& rAttractorLength) const
+{
+    if (input_values.size() != mInputNodes.size())
+        EXCEPTION("A value must be given for every input node.");
 
+    bdd assignment = bddtrue;
+    for (unsigned i=0; i<mInputNodes.size(); i++)
+    {
+        assignment &= input_values[i] ? mpVariables[mInputNodes[i]] : !mpVariables[mInputNodes[i]];
+    }
+    bdd set_variables = bddtrue;
+    for (unsigned node=0; node<mNodesNumber; node++)
+    {
+        set_variables &= mpVariables[node];
+    }
+
+    std::vector<bdd> attractors;
+    rAttractorLength.clear();
+    for (unsigned i=0; i<mParametrisedAttractors.size(); i++)
+    {
+        bdd attractor = mParametrisedAttractors[i] & assignment;
+        if (attractor != bddfalse)
+        {
+            attractors.push_back(attractor);
+            rAttractorLength.push_back((unsigned) bdd_satcountset(attractor, set_variables));
+        }
+    }
+    return attractors;
+}
+
+bdd RandomBooleanNetwork::getDrivenImage(bdd states, bdd upstream_transitions, bdd upstream_variables,
+        bdd module_transition_function, bdd module_variables, bddPair* variables_pair) const
+{
+    /* The module variables are quantified first, with the relation of the
+     * module which reads the upstream ones; then the upstream variables,
+     * with the cycle of the upstream attractor. */
+    bdd image = bdd_appex(states, module_transition_function, bddop_and, module_variables);
+    image = bdd_appex(image, upstream_transitions, bddop_and, upstream_variables);
+    Instrumentation::increment(Instrumentation::IMAGES);
+    return bdd_replace(image, variables_pair);
+}
+
+void RandomBooleanNetwork::findAttractorsInClosedStates(bdd closed_states, bdd upstream_transitions,
+        bdd upstream_variables, bdd module_transition_function, bdd module_variables, bddPair* variables_pair,
+        bddPair* next_variables_pair, std::vector<bdd>& rAttractors, std::vector<unsigned>& rAttractorLength,
+        std::vector<bdd>& rAttractorTransitions) const
+{
+    /* The image of a closed set is a subset of it, so the sequence of images
+     * decreases until only the states of the attractors are left. */
+    bdd cycle_states = closed_states;
+    bdd previous_states;
+    do
+    {
+        previous_states = cycle_states;
+        cycle_states = getDrivenImage(previous_states, upstream_transitions, upstream_variables,
+                module_transition_function, module_variables, variables_pair);
+    } while (cycle_states != previous_states);
+
+    bdd set_variables = upstream_variables & module_variables;
+    while (cycle_states != bddfalse)
+    {
+        bdd state = bdd_satoneset(cycle_states, set_variables, bddtrue);
+        bdd attractor_states = bddfalse;
+        bdd attractor_transitions = bddfalse;
+        unsigned length = 0;
+        do
+        {
+            attractor_states |= state;
+            length++;
+            bdd next_state = getDrivenImage(state, upstream_transitions, upstream_variables,
+                    module_transition_function, module_variables, variables_pair);
+            attractor_transitions |= state & bdd_replace(next_state, next_variables_pair);
+            state = next_state;
+        } while ((state & attractor_states) == bddfalse);
+        cycle_states -= attractor_states;
+        rAttractors.push_back(attractor_states);
+        rAttractorLength.push_back(length);
+        rAttractorTransitions.push_back(attractor_transitions);
+    }
+}
+
+ArrayDirectedGraph* RandomBooleanNetwork::getDependencyGraph() const
+{
+    ArrayDirectedGraph* p_graph = new ArrayDirectedGraph(mNodesNumber);
+    for (unsigned node=0; node<mNodesNumber; node++)
+    {
+        int* p_support_variables = NULL;
+        int support_size = 0;
+        bdd_scanset(bdd_support(mpNodeFunction[node]), p_support_variables, support_size);
+        for (int i=0; i<support_size; i++)
+        {
+            p_graph->addEdgeById((unsigned) p_support_variables[i] / 2, node);
+        }
+        free(p_support_variables);
+    }
+    return p_graph;
 }
 
 void RandomBooleanNetwork::storageAttractors(bdd states_return_to_themself, unsigned j,
@@ -789,6 +1378,7 @@ void RandomBooleanNetwork::storageAttractors(bdd states_return_to_themself, unsi
             states_return_to_themself -= backward_states;
             backward_states = bdd_appex(backward_states, *mpReverseTransitionFunction, bddop_and, set_variables);
             backward_states = bdd_replace(backward_states, variables_pair);
+            Instrumentation::increment(Instrumentation::PREIMAGES);
             backward_states &= states_return_to_themself;
             if (backward_states == bddfalse)
             {
@@ -804,7 +1394,20 @@ void RandomBooleanNetwork::storageAttractors(bdd states_return_to_themself, unsi
 
 std::vector<std::map<unsigned,double> > RandomBooleanNetwork::getAttractorMatrix() const
 {
+    if (!mAttractorSearchComplete)
+        EXCEPTION("The attractor search is incomplete.");
     assert(!mAttractors.empty());
+    std::vector<bdd> node_functions(mpNodeNthFunction, mpNodeNthFunction + mNodesNumber);
+    return getAttractorMatrix(mAttractors, node_functions);
+}
+
+std::vector<std::map<unsigned,double> > RandomBooleanNetwork::getAttractorMatrix(
+        const std::vector<bdd>& attractors, const std::vector<bdd>& node_functions) const
+{
+    assert(!attractors.empty());
+    assert(node_functions.size() == mNodesNumber);
+    ScopedPhase phase("getAttractorMatrix");
+    BddMemoryPolicy::clearNodesLimitReached();
 
     bdd transition_function = bddtrue;
     bddPair* replace_forward_assignment = bdd_newpair();
@@ -816,7 +1419,7 @@ std::vector<std::map<unsigned,double> > RandomBooleanNetwork::getAttractorMatrix
 
     for (unsigned i=0; i < mNodesNumber; i++)
     {
-        transition_function &= bdd_apply(mpNextVariables[i], mpNodeNthFunction[i], bddop_biimp);
+        transition_function &= bdd_apply(mpNextVariables[i], node_functions[i], bddop_biimp);
         p_variables_id[i] = (int)i*2;
         p_next_variables_id[i] = (int) i*2 +1;
     }
@@ -826,12 +1429,12 @@ std::vector<std::map<unsigned,double> > RandomBooleanNetwork::getAttractorMatrix
     delete[] p_variables_id;
     delete[] p_next_variables_id;
 
-    for (unsigned i=0; i < mAttractors.size(); i++)
+    for (unsigned i=0; i < attractors.size(); i++)
     {
         std::map<unsigned,unsigned> map;
         frequency_attractor_matrix.push_back(map);
         std::map<unsigned,unsigned>::iterator iterator;
-        bdd current_attractor = mAttractors.at(i);
+        bdd current_attractor = attractors.at(i);
         do
         {
             bdd state = bdd_satoneset(current_attractor, set_variables, bddtrue);
@@ -839,7 +1442,8 @@ std::vector<std::map<unsigned,double> > RandomBooleanNetwork::getAttractorMatrix
             for (unsigned j=0; j<mNodesNumber; j++)
             {
                 bdd flip_state = bdd_compose(state, bdd_nithvar(j*2), j*2);
-                unsigned position = getStateAttractor(flip_state, transition_function, set_variables, replace_forward_assignment);
+                unsigned position = getStateAttractor(flip_state, transition_function, set_variables,
+                        replace_forward_assignment, attractors);
 
                 iterator = frequency_attractor_matrix.at(i).find(position);
                 if (iterator != frequency_attractor_matrix.at(i).end())
@@ -851,42 +1455,129 @@ std::vector<std::map<unsigned,double> > RandomBooleanNetwork::getAttractorMatrix
                     frequency_attractor_matrix.at(i).insert(std::pair<unsigned,unsigned>(position,1));
                 }
             }
-        } while (current_attractor != bddfalse);
+        } while (current_attractor != bddfalse && !BddMemoryPolicy::isNodesLimitReached());
     }
+    bdd_freepair(replace_forward_assignment);
+    if (BddMemoryPolicy::isNodesLimitReached())
+        EXCEPTION("The BDD node table is full.");
 
     std::vector<std::map<unsigned,double> > stochastic_matrix = getStochasticMatrix(frequency_attractor_matrix);
 
     return stochastic_matrix;
 }
 
+void RandomBooleanNetwork::simulate(std::vector<uint64_t>& rStates, unsigned steps,
+        const SimulationOptions& options) const
+{
+    unsigned words_per_state = (mNodesNumber + 63) / 64;
+    if (rStates.size() % words_per_state != 0)
+        EXCEPTION("The size of the states vector must be a multiple of the words per state.");
+    if (options.noiseProbability < 0.0 || options.noiseProbability > 1.0)
+        EXCEPTION("Noise probability must be between 0 and 1.");
+    if (options.batchSize == 0)
+        EXCEPTION("Batch size must be greater than 0.");
+    unsigned states_number = rStates.size() / words_per_state;
+    if (options.recordInterval > 0 && (options.pRecordBuffer == NULL ||
+            options.recordBufferSize < getRecordBufferSize(states_number, steps, options.recordInterval)))
+        EXCEPTION("The record buffer is too small.");
+    if (states_number == 0)
+        return;
+
+    TruthTableNetwork network(*this);
+    BitSlicedNetworkKernel kernel(network);
+    uint64_t seed = options.seed;
+    if (seed == 0 && options.noiseProbability > 0.0)
+    {
+        seed = (uint64_t) RandomNumberGenerator::Instance()->randMod(4294967295u) + 1;
+    }
+
+    unsigned batch_size = std::min(options.batchSize, states_number);
+    unsigned words_per_node = BitSlicedNetworkKernel::getWordsPerNode(batch_size);
+    int batches_number = (states_number + batch_size - 1) / batch_size;
+
+    /* Batches write disjoint ranges of rStates and of the record buffer. */
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (int batch=0; batch<batches_number; batch++)
+    {
+        unsigned first_state = batch * batch_size;
+        unsigned batch_states = std::min(batch_size, states_number - first_state);
+        std::vector<uint64_t> current(mNodesNumber * words_per_node);
+        std::vector<uint64_t> next(mNodesNumber * words_per_node);
+        SplitMixRandomGenerator generator(seed, batch);
+
+        BitSlicedNetworkKernel::sliceStates(&rStates[first_state * words_per_state], batch_states,
+                words_per_state, mNodesNumber, &current[0], words_per_node);
+        for (unsigned step=1; step<=steps; step++)
+        {
+            kernel.update(&current[0], &next[0], words_per_node);
+            if (options.noiseProbability > 0.0)
+            {
+                flipBitsAtRandom(next, options.noiseProbability, generator);
+            }
+            current.swap(next);
+            if (options.recordInterval > 0 && step % options.recordInterval == 0)
+            {
+                size_t record = step / options.recordInterval - 1;
+                BitSlicedNetworkKernel::unsliceStates(&current[0], words_per_node, mNodesNumber,
+                        options.pRecordBuffer + (record * states_number + first_state) * words_per_state,
+                        batch_states, words_per_state);
+            }
+        }
+        BitSlicedNetworkKernel::unsliceStates(&current[0], words_per_node, mNodesNumber,
+                &rStates[first_state * words_per_state], batch_states, words_per_state);
+    }
+}
+
+size_t RandomBooleanNetwork::getRecordBufferSize(unsigned states_number, unsigned steps,
+        unsigned record_interval) const
+{
+    if (record_interval == 0)
+        return 0;
+    return (size_t) (steps / record_interval) * states_number * ((mNodesNumber + 63) / 64);
+}
+
 unsigned RandomBooleanNetwork::getStateAttractor(
             bdd flip_state, bdd transition_function,
-            bdd set_variables, bddPair* replace_forward_assignment) const
+            bdd set_variables, bddPair* replace_forward_assignment,
+            const std::vector<bdd>& rAttractors) const
 {
-    assert(!mAttractors.empty());
+    assert(!rAttractors.empty());
 
-    flip_state = bdd_appex(flip_state, transition_function, bddop_and, set_variables);
-    flip_state = bdd_replace(flip_state, replace_forward_assignment);
+    /* After findAttractors() the transition function is T^steps_max, so the
+     * first image is always in an attractor. Otherwise (e.g. after
+     * findAttractorsModular()) we keep applying it until we get there. */
     bool found = false;
     unsigned index = 0;
     do
     {
-        if ((flip_state & mAttractors.at(index)) != bddfalse)
+        flip_state = bdd_appex(flip_state, transition_function, bddop_and, set_variables);
+        flip_state = bdd_replace(flip_state, replace_forward_assignment);
+        Instrumentation::increment(Instrumentation::IMAGES);
+        index = 0;
+        while (!found && index < rAttractors.size())
         {
-            found = true;
+            if ((flip_state & rAttractors.at(index)) != bddfalse)
+            {
+                found = true;
+            }
+            else
+            {
+                index++;
+            }
         }
-        index++;
-    } while (!found && index < mAttractors.size());
-    return (index - 1);
+    } while (!found && !BddMemoryPolicy::isNodesLimitReached());
+    return index;
 }
 
 std::vector<std::map<unsigned,double> > RandomBooleanNetwork::getStochasticMatrix(
         std::vector<std::map<unsigned,unsigned> > frequency_matrix) const
 {
-    assert(!mAttractors.empty());
+    assert(!frequency_matrix.empty());
 
     std::vector<std::map<unsigned,double> >  stochastic_matrix;
-    for (unsigned row=0; row< mAttractors.size(); row++)
+    for (unsigned row=0; row< frequency_matrix.size(); row++)
     {
         std::map<unsigned,double> map;
         stochastic_matrix.push_back(map);
@@ -1246,6 +1937,60 @@ std::vector<unsigned> RandomBooleanNetwork::getAttractorLength() const
     return mAttractorLength;
 }
 
+std::vector<uint64_t> RandomBooleanNetwork::getAttractorStates(unsigned index) const
+{
+    if (index >= mAttractors.size())
+        EXCEPTION("Error, attractor index must be < number of attractors.");
+    unsigned words_per_state = (mNodesNumber + 63) / 64;
+    std::vector<uint64_t> states;
+    states.reserve(mAttractorLength[index] * words_per_state);
+
+    int* p_variables_id = new int[mNodesNumber];
+    for (unsigned i=0; i<mNodesNumber; i++)
+    {
+        p_variables_id[i] = i*2;
+    }
+    bdd set_variables = bdd_makeset(p_variables_id, mNodesNumber);
+    delete[] p_variables_id;
+
+    bdd attractor = mAttractors[index];
+    while (attractor != bddfalse)
+    {
+        bdd state = bdd_satoneset(attractor, set_variables, bddtrue);
+        attractor -= state;
+        /* The state is a cube over the current variables: a node is 1 if
+         * its low branch is false. */
+        size_t offset = states.size();
+        states.resize(offset + words_per_state, 0);
+        for (bdd node = state; node != bddtrue; )
+        {
+            unsigned node_id = bdd_var(node) / 2;
+            if (bdd_low(node) == bddfalse)
+            {
+                states[offset + node_id / 64] |= ((uint64_t) 1) << (node_id % 64);
+                node = bdd_high(node);
+            }
+            else
+            {
+                node = bdd_low(node);
+            }
+        }
+    }
+    return states;
+}
+
+const ArrayDirectedGraph* RandomBooleanNetwork::getGraph() const
+{
+    return mpRbnGraph;
+}
+
+bdd RandomBooleanNetwork::getNodeFunction(unsigned node) const
+{
+    if (node >= mNodesNumber)
+        EXCEPTION("Error, node id must be < number of nodes.");
+    return mpNodeFunction[node];
+}
+
 void allsatHandlerPrint(char *varset,int size)
 {
   for (int v=0; v<size; v=v+2)
@@ -1266,3 +2011,28 @@ void allsatHandlerPrintToStringBuffer(char *varset,int size)
     }
     stringBuffer.push_back(input_values);
 }
+
+void flipBitsAtRandom(std::vector<uint64_t>& rSliced, double probability, SplitMixRandomGenerator& rGenerator)
+{
+    uint64_t bits_number = (uint64_t) rSliced.size() * 64;
+    if (probability >= 1.0)
+    {
+        for (unsigned i=0; i<rSliced.size(); i++)
+        {
+            rSliced[i] = ~rSliced[i];
+        }
+        return;
+    }
+    double log_complement = log(1.0 - probability);
+    uint64_t position = 0;
+    while (true)
+    {
+        /* 1 - ranf() is in (0,1], so the logarithm is finite. */
+        double skip = floor(log(1.0 - rGenerator.ranf()) / log_complement);
+        if (skip >= (double) (bits_number - position))
+            break;
+        position += (uint64_t) skip;
+        rSliced[position >> 6] ^= ((uint64_t) 1) << (position & 63);
+        position++;
+    }
+}
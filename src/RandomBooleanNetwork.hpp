@@ -2,6 +2,7 @@
 #define RANDOMBOOLEANNETWORK_HPP_
 
 #include "ArrayDirectedGraph.hpp"
+#include "AbstractAttractorSearchMonitor.hpp"
 #include "Exception.hpp"
 #include "FileFinder.hpp"
 #include "OutputFileHandler.hpp"
@@ -10,6 +11,51 @@
 #include <bdd.h>
 #include <iostream>
 #include <fstream>
+#include <stdint.h>
+
+/**
+ * Options of RandomBooleanNetwork::simulate().
+ */
+struct SimulationOptions
+{
+    /** Probability to flip every node after every step (0 means no noise) */
+    double noiseProbability;
+
+    /** A state is recorded every recordInterval steps (0 means no recording) */
+    unsigned recordInterval;
+
+    /**
+     * Preallocated buffer for the recorded states: the r-th record contains
+     * the packed states of all trajectories after (r+1)*recordInterval steps.
+     */
+    uint64_t* pRecordBuffer;
+
+    /** Size of pRecordBuffer in words */
+    size_t recordBufferSize;
+
+    /** Number of trajectories simulated together by a thread */
+    unsigned batchSize;
+
+    /**
+     * Seed of the noise. With the same seed (and batch size) the result does
+     * not depend on the number of threads. If 0, the seed is drawn from the
+     * RandomNumberGenerator.
+     */
+    uint64_t seed;
+
+    /**
+     * Constructor: no noise, no recording, batches of 4096 trajectories.
+     */
+    SimulationOptions() :
+    noiseProbability(0.0),
+    recordInterval(0),
+    pRecordBuffer(NULL),
+    recordBufferSize(0),
+    batchSize(4096),
+    seed(0)
+    {
+    }
+};
 
 class RandomBooleanNetwork
 {
@@ -65,6 +111,37 @@ private:
      */
     std::vector<unsigned> mAttractorLength;
 
+    /** The input nodes used as parameters by findParametrisedAttractors() */
+    std::vector<unsigned> mInputNodes;
+
+    /**
+     * Attractors found by findParametrisedAttractors(), as BDDs over the
+     * input (parameter) and the state variables: for every combination of
+     * the inputs, each entry is an attractor or it is empty.
+     */
+    std::vector<bdd> mParametrisedAttractors;
+
+    /** The monitor of findAttractors(), not owned (NULL if none) */
+    AbstractAttractorSearchMonitor* mpSearchMonitor;
+
+    /** The maximum duration of findAttractors() in seconds (0 means no limit) */
+    double mSearchTimeLimit;
+
+    /** The wall-clock time at the beginning of the running search, in seconds */
+    double mSearchStartTime;
+
+    /** Whether the running search has to stop; it can be set by another thread */
+    volatile bool mSearchCancelled;
+
+    /** Whether mAttractors contains all the attractors of the network */
+    bool mAttractorSearchComplete;
+
+    /** The checkpoint file of findAttractors() (empty means no checkpoint) */
+    std::string mCheckpointPath;
+
+    /** The minimum time between two checkpoints in seconds (0 means only when stopped) */
+    double mCheckpointInterval;
+
     /**
      * Read a .cnet or .net file, build the graph and associate
      * a boolean function in every node.
@@ -81,10 +158,17 @@ private:
     void createGraphFromGmlFile(const std::string file_path);
 
     /**
-     * Initialize buddy and setting some property.
+     * Initialize buddy (if it is not running, with a node table sized from
+     * the graph) and setting some property.
      */
     void initBinaryDecisionDiagram() const;
 
+    /**
+     * Reserve a node table sized from the functions of the nodes, see
+     * BddMemoryPolicy::reserveNodes().
+     */
+    void reserveBinaryDecisionDiagramNodes() const;
+
     /**
      * Create a BDD boolean function and associate it to a given node
      *
@@ -101,8 +185,10 @@ private:
      * @param transition_function bdd transition function
      * @param set_variables bdd set of variables
      * @param replace_forward_assignment bddPair indicating the forward assignment
+     * @param rAttractors the attractors of the transition function
      */
-    unsigned getStateAttractor(bdd flip_state, bdd transition_function, bdd set_variables, bddPair* replace_forward_assignment) const;
+    unsigned getStateAttractor(bdd flip_state, bdd transition_function, bdd set_variables,
+            bddPair* replace_forward_assignment, const std::vector<bdd>& rAttractors) const;
 
     /**
      * Given a set of states returning to they self, the method find the attractors
@@ -140,6 +226,60 @@ private:
     bdd find_backward_reachable_states(bdd current_ring, bdd states, bdd set_variables,
             bddPair* variables_pair, unsigned &steps_max);
 
+    /**
+     * Select one state for every value of the variables not in
+     * variables_id (the parameters): for each of them, the minimal state
+     * of 'states' is kept.
+     *
+     * @param states set of states over parameters and variables
+     * @param variables_id the ids of the (state) variables, in BDD order
+     *
+     * @return a subset of 'states' with exactly one state for every parameter value.
+     */
+    bdd pickStatePerParameter(bdd states, const std::vector<int>& variables_id) const;
+
+    /**
+     * @return true if the running search has been cancelled or it has
+     * exceeded the time limit.
+     */
+    bool isSearchStopped() const;
+
+    /**
+     * The main loop of findAttractors(), starting from a given state of the
+     * search: mAttractors and mpNodeNthFunction must be consistent with it.
+     *
+     * @param explored_states the states whose attractor has been found
+     * @param j the next step
+     * @param steps_max the longest transient found so far
+     */
+    void searchAttractors(bdd explored_states, unsigned j, unsigned steps_max);
+
+    /**
+     * Write the state of findAttractors() at the beginning of a step in
+     * mCheckpointPath. The file is written aside and then renamed, so an
+     * interruption never leaves a partial checkpoint.
+     *
+     * @param explored_states the states whose attractor has been found
+     * @param j the step
+     * @param steps_max the longest transient found so far
+     * @param attractors_number the number of attractors found before the step
+     * @param rNthFunctions the functions of the nodes composed j-1 times
+     */
+    void saveSearchCheckpoint(bdd explored_states, unsigned j, unsigned steps_max,
+            unsigned attractors_number, const std::vector<bdd>& rNthFunctions) const;
+
+    /**
+     * Read a checkpoint written by saveSearchCheckpoint(): mAttractors,
+     * mAttractorLength and mpNodeNthFunction are restored.
+     *
+     * @param file_path the path of the checkpoint
+     * @param rExploredStates filled with the explored states
+     * @param rJ filled with the step
+     * @param rStepsMax filled with the longest transient
+     */
+    void loadSearchCheckpoint(const std::string file_path, bdd& rExploredStates,
+            unsigned& rJ, unsigned& rStepsMax);
+
     /**
      * Normalize a frequency matrix and obtain a probability distribution
      * in every row. This is the ATM as described here:
@@ -194,19 +334,177 @@ public:
      *
      * It when it finish, mAttractors vector has a attractor for every
      * entry.
+     *
+     * The search can be observed and stopped with setSearchMonitor(),
+     * setSearchTimeLimit() and cancelSearch(): then mAttractors contains
+     * the attractors found so far and isAttractorSearchComplete() is
+     * false. A new call after an incomplete search starts it again.
+     * The search stops in the same way when the node table reaches the
+     * memory limit of BddMemoryPolicy.
      */
     void findAttractors();
 
+    /**
+     * Save the state of findAttractors() in a file, so that a long search
+     * can be continued with resumeAttractorSearch() after a crash or a
+     * time limit. The file is written every interval_seconds and when the
+     * search stops; it contains the state at the beginning of a step
+     * (explored states, step, composed functions, longest transient and
+     * attractors found), the BDDs being saved with bdd_save().
+     *
+     * @param file_path the path of the checkpoint, or "" to disable it
+     * @param interval_seconds the minimum time between two checkpoints, or 0
+     * to write it only when the search stops
+     */
+    void setSearchCheckpoint(const std::string file_path, double interval_seconds);
+
+    /**
+     * Continue findAttractors() from a checkpoint written by a search on
+     * the same network, possibly by another process. The monitor, the time
+     * limit and the checkpoint apply as in findAttractors().
+     *
+     * @param file_path the path of the checkpoint
+     */
+    void resumeAttractorSearch(const std::string file_path);
+
+    /**
+     * Set the monitor of findAttractors().
+     *
+     * @param p_monitor the monitor (not owned), or NULL
+     */
+    void setSearchMonitor(AbstractAttractorSearchMonitor* p_monitor);
+
+    /**
+     * Set the maximum duration of findAttractors(). The time is checked
+     * between images, so the search can last a little longer.
+     *
+     * @param seconds the time limit, or 0 for no limit
+     */
+    void setSearchTimeLimit(double seconds);
+
+    /**
+     * Stop the running findAttractors() as soon as possible. It can be
+     * called by the monitor or by another thread. The search checks the
+     * request between images; if no search is running, the next
+     * findAttractors() or resumeAttractorSearch() stops at its first
+     * check. The request is cleared when the stopped search returns.
+     */
+    void cancelSearch();
+
+    /**
+     * @return true if the attractor search found all the attractors.
+     */
+    bool isAttractorSearchComplete() const;
+
+    /**
+     * Find attractors of the synchronous network decomposing its dependency
+     * graph in strongly connected modules. Modules are visited in topological
+     * order: the attractors of the upstream modules are computed first, and
+     * then, for each of them, the attractors of the next module driven by it.
+     * Every step works on a set of states bounded by an upstream attractor,
+     * with the relation of the nodes of the module and the cycle of the
+     * upstream attractor instead of the relation of the whole network, so
+     * networks much larger than the ones handled by findAttractors() are
+     * tractable when the graph is not a single big module.
+     *
+     * When it finish, mAttractors vector has a attractor for every
+     * entry, as for findAttractors().
+     */
+    void findAttractorsModular();
+
+    /**
+     * Find the attractors for all the combinations of some input nodes at
+     * once. The input nodes become parameters: their functions are ignored,
+     * their current variables are never quantified and they keep their
+     * value over time, so a single symbolic fixpoint gives the attractors
+     * of every input combination as BDDs over inputs and state.
+     *
+     * @param input_nodes the ids of the input nodes
+     */
+    void findParametrisedAttractors(const std::vector<unsigned>& input_nodes);
+
+    /**
+     * @return the number of parametrised attractors, each of them being an
+     * attractor for some input combinations.
+     */
+    unsigned getParametrisedAttractorsNumber() const;
+
+    /**
+     * @param index index of the parametrised attractor
+     *
+     * @return the parametrised attractor, over input and state variables.
+     */
+    bdd getParametrisedAttractor(unsigned index) const;
+
+    /**
+     * @param index index of the parametrised attractor
+     *
+     * @return the input combinations (over the input variables) for which
+     * the parametrised attractor exists.
+     */
+    bdd getParametrisedAttractorInputs(unsigned index) const;
+
+    /**
+     * Project the parametrised attractors on a concrete input combination.
+     *
+     * @param input_values the value of every input node, in the order given
+     * to findParametrisedAttractors()
+     * @param rAttractorLength vector filled with the lengths of the attractors
+     *
+     * @return the attractors for the input combination (the input nodes
+     * have the given values in every state).
+     */
+    std::vector<bdd> getAttractorsForInputs(const std::vector<bool>& input_values,
+            std::vector<unsigned>& rAttractorLength) const;
+
     /**
      * Method that induce noise in every bit of every state of the
      * attractors, and fill a frequency matrix in which rows and columns
      * are the attractors. Then, it normalises the frequency matrix.
      * http://dx.plos.org/10.1371/journal.pone.0017703
+     * The attractor search must be complete.
      *
      * @return a frequency matrix representing the ATN in frequency
      */
     std::vector<std::map<unsigned,double> > getAttractorMatrix()  const;
 
+    /**
+     * As getAttractorMatrix(), but for the attractors of the network in
+     * which node i has function node_functions[i] (e.g. a mutant). An
+     * exception is thrown if the node table reaches the memory limit of
+     * BddMemoryPolicy.
+     *
+     * @param attractors the attractors of the network
+     * @param node_functions the function of every node (over current variables)
+     *
+     * @return a frequency matrix representing the ATN in frequency
+     */
+    std::vector<std::map<unsigned,double> > getAttractorMatrix(const std::vector<bdd>& attractors,
+            const std::vector<bdd>& node_functions) const;
+
+    /**
+     * Simulate the synchronous network forward from explicit initial
+     * states. The states are packed as in TruthTableNetwork (one state
+     * every (getNodesNumber() + 63) / 64 words) and advanced in place.
+     * Trajectories are split in batches updated with the bit-sliced
+     * kernel, and batches are distributed among the threads.
+     *
+     * @param rStates the initial states, replaced by the final states
+     * @param steps number of synchronous steps
+     * @param options noise, recording and batching options
+     */
+    void simulate(std::vector<uint64_t>& rStates, unsigned steps,
+            const SimulationOptions& options = SimulationOptions()) const;
+
+    /**
+     * @param states_number number of trajectories
+     * @param steps number of steps
+     * @param record_interval a state is recorded every record_interval steps
+     *
+     * @return the size in words of the buffer needed by simulate() to record the states.
+     */
+    size_t getRecordBufferSize(unsigned states_number, unsigned steps, unsigned record_interval) const;
+
     /**
      * Save the network and if possible the attractors in a .net file.
      *
@@ -293,6 +591,81 @@ public:
      * @return mAttractorLength.
      */
     std::vector<unsigned> getAttractorLength() const;
+
+    /**
+     * @param index index of the attractor
+     *
+     * @return the states of the attractor, packed as in TruthTableNetwork
+     * (in no particular order).
+     */
+    std::vector<uint64_t> getAttractorStates(unsigned index) const;
+
+    /**
+     * Build the dependency graph of the network: an edge i -> j exists if
+     * the function of node j depends on node i. The supports of the BDDs
+     * are used instead of mpRbnGraph, because generated canalyzing
+     * functions can read nodes that are not inputs in the graph.
+     * User must delete the object explicitly after use.
+     *
+     * @return a pointer to the dependency graph
+     */
+    ArrayDirectedGraph* getDependencyGraph() const;
+
+    /**
+     * The image of a set of states under the relation of a module driven
+     * by an upstream attractor (see findAttractorsModular()).
+     *
+     * @param states set of states over the upstream and module variables
+     * @param upstream_transitions bdd cycle of the upstream attractor over
+     * the upstream variables and their next variables
+     * @param upstream_variables bdd set of the upstream variables
+     * @param module_transition_function bdd transition relation of the
+     * nodes of the module
+     * @param module_variables bdd set of the variables of the module
+     * @param variables_pair bddPair replacing next variables with current variables
+     *
+     * @return the image of the states.
+     */
+    bdd getDrivenImage(bdd states, bdd upstream_transitions, bdd upstream_variables,
+            bdd module_transition_function, bdd module_variables, bddPair* variables_pair) const;
+
+    /**
+     * Find the attractors of a module driven by an upstream attractor. The
+     * image of the closed set of states is iterated until it does not
+     * change, then the remaining states are split in cycles.
+     *
+     * @param closed_states set of states such that T(closed_states) is a subset of it
+     * @param upstream_transitions bdd cycle of the upstream attractor over
+     * the upstream variables and their next variables
+     * @param upstream_variables bdd set of the upstream variables
+     * @param module_transition_function bdd transition relation of the
+     * nodes of the module
+     * @param module_variables bdd set of the variables of the module
+     * @param variables_pair bddPair replacing next variables with current variables
+     * @param next_variables_pair bddPair replacing current variables with next variables
+     * @param rAttractors vector in which the attractors found are appended
+     * @param rAttractorLength vector in which the lengths of the attractors are appended
+     * @param rAttractorTransitions vector in which the cycles of the
+     * attractors are appended, as relations between current and next variables
+     */
+    void findAttractorsInClosedStates(bdd closed_states, bdd upstream_transitions, bdd upstream_variables,
+            bdd module_transition_function, bdd module_variables, bddPair* variables_pair,
+            bddPair* next_variables_pair, std::vector<bdd>& rAttractors, std::vector<unsigned>& rAttractorLength,
+            std::vector<bdd>& rAttractorTransitions) const;
+
+    /**
+     * getter of mpRbnGraph.
+     *
+     * @return mpRbnGraph.
+     */
+    const ArrayDirectedGraph* getGraph() const;
+
+    /**
+     * @param node id of the node
+     *
+     * @return the BDD of the function associated with the node.
+     */
+    bdd getNodeFunction(unsigned node) const;
 };
 
 #endif /* RANDOMBOOLEANNETWORK_HPP_ */
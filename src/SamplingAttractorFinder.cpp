@@ -0,0 +1,204 @@
+#include "SamplingAttractorFinder.hpp"
+#include "SplitMixRandomGenerator.hpp"
+#include "RandomNumberGenerator.hpp"
+#include <algorithm>
+#include <cassert>
+#include <boost/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * Order of the attractors: decreasing hits, then increasing minimal state.
+ *
+ * @param rAttractor1 the first attractor
+ * @param rAttractor2 the second attractor
+ *
+ * @return true if the first attractor comes before the second one.
+ */
+bool compareSampledAttractors(const SampledAttractor& rAttractor1, const SampledAttractor& rAttractor2);
+
+SamplingAttractorFinder::SamplingAttractorFinder(const TruthTableNetwork& rNetwork) :
+mrNetwork(rNetwork),
+mSamplesNumber(0),
+mUnresolvedSamplesNumber(0)
+{
+}
+
+void SamplingAttractorFinder::findAttractors(unsigned samples_number, unsigned max_steps, uint64_t seed)
+{
+    if (max_steps == 0)
+        EXCEPTION("The maximum number of steps must be greater than 0.");
+    if (seed == 0)
+    {
+        seed = (uint64_t) RandomNumberGenerator::Instance()->randMod(4294967295u) + 1;
+    }
+
+    /* Cycles are keyed by their minimal state; the value is (length, hits). */
+    typedef boost::unordered_map<std::vector<uint64_t>, std::pair<unsigned,unsigned> > AttractorShard;
+    const unsigned shards_number = 64;
+    std::vector<AttractorShard> shards(shards_number);
+#ifdef _OPENMP
+    std::vector<omp_lock_t> locks(shards_number);
+    for (unsigned i=0; i<shards_number; i++)
+    {
+        omp_init_lock(&locks[i]);
+    }
+#endif
+
+    unsigned words_per_state = mrNetwork.getWordsPerState();
+    unsigned nodes_number = mrNetwork.getNodesNumber();
+    uint64_t last_word_mask = (nodes_number % 64 == 0) ? ~((uint64_t) 0) : (((uint64_t) 1) << (nodes_number % 64)) - 1;
+    int samples = samples_number;
+    unsigned unresolved_samples = 0;
+
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic,16) reduction(+:unresolved_samples)
+#endif
+    for (int sample=0; sample<samples; sample++)
+    {
+        /* Every sample has its own stream, so the states do not depend on the threads. */
+        SplitMixRandomGenerator generator(seed, sample);
+        std::vector<uint64_t> state(words_per_state);
+        for (unsigned w=0; w<words_per_state; w++)
+        {
+            state[w] = generator.next();
+        }
+        state[words_per_state-1] &= last_word_mask;
+
+        unsigned length = findCycle(state, max_steps);
+        if (length == 0)
+        {
+            unresolved_samples++;
+            continue;
+        }
+
+        unsigned shard = boost::hash_range(state.begin(), state.end()) % shards_number;
+#ifdef _OPENMP
+        omp_set_lock(&locks[shard]);
+#endif
+        std::pair<AttractorShard::iterator,bool> inserted =
+                shards[shard].insert(std::make_pair(state, std::make_pair(length, 0u)));
+        inserted.first->second.second++;
+#ifdef _OPENMP
+        omp_unset_lock(&locks[shard]);
+#endif
+    }
+
+#ifdef _OPENMP
+    for (unsigned i=0; i<shards_number; i++)
+    {
+        omp_destroy_lock(&locks[i]);
+    }
+#endif
+
+    mAttractors.clear();
+    for (unsigned i=0; i<shards_number; i++)
+    {
+        for (AttractorShard::const_iterator it=shards[i].begin(); it!=shards[i].end(); ++it)
+        {
+            SampledAttractor attractor;
+            attractor.minimalState = it->first;
+            attractor.length = it->second.first;
+            attractor.hits = it->second.second;
+            mAttractors.push_back(attractor);
+        }
+    }
+    std::sort(mAttractors.begin(), mAttractors.end(), compareSampledAttractors);
+    mSamplesNumber = samples_number;
+    mUnresolvedSamplesNumber = unresolved_samples;
+}
+
+unsigned SamplingAttractorFinder::findCycle(std::vector<uint64_t>& rState, unsigned max_steps) const
+{
+    unsigned words_per_state = mrNetwork.getWordsPerState();
+    std::vector<uint64_t> tortoise(rState);
+    std::vector<uint64_t> hare(words_per_state);
+    std::vector<uint64_t> next(words_per_state);
+    mrNetwork.update(&tortoise[0], &hare[0]);
+
+    /* Brent: the tortoise jumps to the hare every power of two steps. */
+    uint64_t power = 1;
+    unsigned length = 1;
+    unsigned steps = 1;
+    while (hare != tortoise)
+    {
+        if (steps >= max_steps)
+            return 0;
+        if (power == length)
+        {
+            tortoise = hare;
+            power *= 2;
+            length = 0;
+        }
+        mrNetwork.update(&hare[0], &next[0]);
+        hare.swap(next);
+        length++;
+        steps++;
+    }
+
+    /* The hare is in the cycle: walk it to find the minimal state. */
+    rState = hare;
+    for (unsigned i=1; i<length; i++)
+    {
+        mrNetwork.update(&hare[0], &next[0]);
+        hare.swap(next);
+        if (isStateLess(&hare[0], &rState[0], words_per_state))
+        {
+            rState = hare;
+        }
+    }
+    return length;
+}
+
+const std::vector<SampledAttractor>& SamplingAttractorFinder::getAttractors() const
+{
+    return mAttractors;
+}
+
+std::vector<uint64_t> SamplingAttractorFinder::getAttractorStates(unsigned index) const
+{
+    if (index >= mAttractors.size())
+        EXCEPTION("Error, attractor index must be < number of attractors.");
+    unsigned words_per_state = mrNetwork.getWordsPerState();
+    std::vector<uint64_t> states(mAttractors[index].minimalState);
+    states.resize(mAttractors[index].length * words_per_state);
+    for (unsigned i=1; i<mAttractors[index].length; i++)
+    {
+        mrNetwork.update(&states[(i-1) * words_per_state], &states[i * words_per_state]);
+    }
+    return states;
+}
+
+unsigned SamplingAttractorFinder::getSamplesNumber() const
+{
+    return mSamplesNumber;
+}
+
+unsigned SamplingAttractorFinder::getUnresolvedSamplesNumber() const
+{
+    return mUnresolvedSamplesNumber;
+}
+
+bool SamplingAttractorFinder::isStateLess(const uint64_t* p_state1, const uint64_t* p_state2, unsigned words_per_state)
+{
+    for (unsigned w=words_per_state; w>0; w--)
+    {
+        if (p_state1[w-1] != p_state2[w-1])
+        {
+            return p_state1[w-1] < p_state2[w-1];
+        }
+    }
+    return false;
+}
+
+bool compareSampledAttractors(const SampledAttractor& rAttractor1, const SampledAttractor& rAttractor2)
+{
+    if (rAttractor1.hits != rAttractor2.hits)
+    {
+        return rAttractor1.hits > rAttractor2.hits;
+    }
+    return SamplingAttractorFinder::isStateLess(&rAttractor1.minimalState[0], &rAttractor2.minimalState[0],
+            rAttractor1.minimalState.size());
+}
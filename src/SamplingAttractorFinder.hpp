@@ -0,0 +1,117 @@
+#ifndef SAMPLINGATTRACTORFINDER_HPP_
+#define SAMPLINGATTRACTORFINDER_HPP_
+
+#include "TruthTableNetwork.hpp"
+#include "Exception.hpp"
+#include <vector>
+#include <stdint.h>
+
+/**
+ * An attractor found by sampling: it is identified by its minimal state
+ * (comparing the packed states from the most significant word), so two
+ * trajectories reaching the same cycle give the same attractor.
+ */
+struct SampledAttractor
+{
+    /** The minimal state of the cycle, packed */
+    std::vector<uint64_t> minimalState;
+
+    /** The number of states of the cycle */
+    unsigned length;
+
+    /** The number of samples whose trajectory reached the cycle */
+    unsigned hits;
+};
+
+/**
+ * Attractor search for networks too large for the symbolic algorithms of
+ * RandomBooleanNetwork. Random initial states are drawn and each trajectory
+ * is followed with Brent's cycle detection on packed states, so memory is
+ * constant per trajectory. Samples are distributed among the threads and
+ * the cycles found are deduplicated in a hash set split in locked shards.
+ *
+ * The attractors found are a subset of the attractors of the network; the
+ * hits estimate the relative size of their basins.
+ */
+class SamplingAttractorFinder
+{
+private:
+
+    /** The network */
+    const TruthTableNetwork& mrNetwork;
+
+    /** The attractors found, sorted by decreasing hits */
+    std::vector<SampledAttractor> mAttractors;
+
+    /** The number of samples of the last search */
+    unsigned mSamplesNumber;
+
+    /** The number of samples that did not reach a cycle within the maximum steps */
+    unsigned mUnresolvedSamplesNumber;
+
+    /**
+     * Follow the trajectory of a state with Brent's algorithm.
+     *
+     * @param rState the initial state, replaced by the minimal state of the cycle
+     * @param max_steps maximum number of updates
+     *
+     * @return the length of the cycle, or 0 if it was not found within max_steps updates.
+     */
+    unsigned findCycle(std::vector<uint64_t>& rState, unsigned max_steps) const;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rNetwork the network (it must live as long as this object)
+     */
+    SamplingAttractorFinder(const TruthTableNetwork& rNetwork);
+
+    /**
+     * Sample random initial states and find the attractors they reach.
+     * The results of previous searches are discarded.
+     *
+     * @param samples_number number of random initial states
+     * @param max_steps maximum number of updates of a trajectory
+     * @param seed seed of the initial states; with the same seed the result
+     * does not depend on the number of threads. If 0, the seed is drawn from
+     * the RandomNumberGenerator.
+     */
+    void findAttractors(unsigned samples_number, unsigned max_steps, uint64_t seed = 0);
+
+    /**
+     * @return the attractors found, sorted by decreasing hits.
+     */
+    const std::vector<SampledAttractor>& getAttractors() const;
+
+    /**
+     * @param index index of the attractor
+     *
+     * @return the packed states of the cycle, starting from the minimal one.
+     */
+    std::vector<uint64_t> getAttractorStates(unsigned index) const;
+
+    /**
+     * @return the number of samples of the last search.
+     */
+    unsigned getSamplesNumber() const;
+
+    /**
+     * @return the number of samples which did not reach an attractor.
+     */
+    unsigned getUnresolvedSamplesNumber() const;
+
+    /**
+     * Compare two packed states as unsigned integers.
+     *
+     * @param p_state1 the first state
+     * @param p_state2 the second state
+     * @param words_per_state number of words of the states
+     *
+     * @return true if the first state is smaller than the second one.
+     */
+    static bool isStateLess(const uint64_t* p_state1, const uint64_t* p_state2, unsigned words_per_state);
+};
+
+#endif /* SAMPLINGATTRACTORFINDER_HPP_ */
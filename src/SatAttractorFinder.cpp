@@ -0,0 +1,229 @@
+#include "SatAttractorFinder.hpp"
+#include "SamplingAttractorFinder.hpp"
+#include <algorithm>
+#include <cassert>
+
+SatAttractorFinder::SatAttractorFinder(const TruthTableNetwork& rNetwork) :
+mrNetwork(rNetwork),
+mSearchedLength(0),
+mComplete(false)
+{
+    assert(mrNetwork.getNodesNumber() > 0);
+    unroll(0);
+}
+
+void SatAttractorFinder::unroll(unsigned steps)
+{
+    unsigned nodes_number = mrNetwork.getNodesNumber();
+    while (mStateVariables.size() <= steps)
+    {
+        std::vector<int> variables(nodes_number);
+        for (unsigned node=0; node<nodes_number; node++)
+        {
+            variables[node] = mSolver.newVariable();
+        }
+        mStateVariables.push_back(variables);
+        if (mStateVariables.size() == 1) continue;
+
+        /* Every row of a truth table: (inputs != row) OR (next = value). */
+        const std::vector<int>& r_current = mStateVariables[mStateVariables.size() - 2];
+        std::vector<int> clause;
+        for (unsigned node=0; node<nodes_number; node++)
+        {
+            unsigned inputs_number = mrNetwork.getInputsNumber(node);
+            const unsigned* p_inputs = mrNetwork.getInputs(node);
+            for (unsigned row=0; row<(1u << inputs_number); row++)
+            {
+                clause.clear();
+                for (unsigned j=0; j<inputs_number; j++)
+                {
+                    int variable = r_current[p_inputs[j]];
+                    clause.push_back(((row >> j) & 1u) ? -variable : variable);
+                }
+                clause.push_back(mrNetwork.getTruthTableValue(node, row) ? variables[node] : -variables[node]);
+                mSolver.addClause(clause);
+            }
+        }
+    }
+}
+
+unsigned SatAttractorFinder::searchLength(unsigned length)
+{
+    assert(length > 0);
+    unroll(length);
+
+    unsigned nodes_number = mrNetwork.getNodesNumber();
+    const std::vector<int>& r_initial = mStateVariables[0];
+    std::vector<int> clause(3);
+    while (mCycleVariables.size() < length)
+    {
+        /* cycle -> (s_j = s_0), node by node */
+        int cycle = mSolver.newVariable();
+        const std::vector<int>& r_state = mStateVariables[mCycleVariables.size() + 1];
+        clause[0] = -cycle;
+        for (unsigned node=0; node<nodes_number; node++)
+        {
+            clause[1] = r_initial[node];
+            clause[2] = -r_state[node];
+            mSolver.addClause(clause);
+            clause[1] = -r_initial[node];
+            clause[2] = r_state[node];
+            mSolver.addClause(clause);
+        }
+        mCycleVariables.push_back(cycle);
+    }
+
+    /* The cycle conditions of this bound are active only under the assumption. */
+    int activation = mSolver.newVariable();
+    clause.assign(1, -activation);
+    clause.insert(clause.end(), mCycleVariables.begin(), mCycleVariables.begin() + length);
+    mSolver.addClause(clause);
+    std::vector<int> assumptions(1, activation);
+
+    unsigned words_per_state = mrNetwork.getWordsPerState();
+    unsigned attractors_number = mAttractors.size();
+    std::vector<uint64_t> states;
+    while (mSolver.solve(assumptions))
+    {
+        states.assign(words_per_state, 0);
+        for (unsigned node=0; node<nodes_number; node++)
+        {
+            TruthTableNetwork::setNodeValue(&states[0], node, mSolver.getModelValue(r_initial[node]));
+        }
+
+        /* Walk the cycle, keeping track of the minimal state. */
+        unsigned attractor_length = 0;
+        unsigned minimal_state = 0;
+        while (true)
+        {
+            states.resize(states.size() + words_per_state);
+            mrNetwork.update(&states[attractor_length * words_per_state], &states[(attractor_length + 1) * words_per_state]);
+            attractor_length++;
+            assert(attractor_length <= length);
+            if (std::equal(states.begin(), states.begin() + words_per_state,
+                    states.begin() + attractor_length * words_per_state))
+            {
+                break;
+            }
+            if (SamplingAttractorFinder::isStateLess(&states[attractor_length * words_per_state],
+                    &states[minimal_state * words_per_state], words_per_state))
+            {
+                minimal_state = attractor_length;
+            }
+        }
+        states.resize(attractor_length * words_per_state);
+        std::rotate(states.begin(), states.begin() + minimal_state * words_per_state, states.end());
+        mAttractors.push_back(states);
+        mAttractorLength.push_back(attractor_length);
+
+        /* No state of the cycle can be s_0 again, for every bound. */
+        for (unsigned i=0; i<attractor_length; i++)
+        {
+            clause.clear();
+            for (unsigned node=0; node<nodes_number; node++)
+            {
+                bool value = TruthTableNetwork::getNodeValue(&states[i * words_per_state], node);
+                clause.push_back(value ? -r_initial[node] : r_initial[node]);
+            }
+            mSolver.addClause(clause);
+        }
+    }
+
+    /* The clause of the bound is disabled for good. */
+    mSolver.addClause(std::vector<int>(1, -activation));
+    mSearchedLength = std::max(mSearchedLength, length);
+    return mAttractors.size() - attractors_number;
+}
+
+bool SatAttractorFinder::checkCompleteness(unsigned length)
+{
+    unroll(length);
+
+    /* Is there a state s_0 such that s_length is not in an attractor found? */
+    unsigned nodes_number = mrNetwork.getNodesNumber();
+    const std::vector<int>& r_final = mStateVariables[length];
+    int activation = mSolver.newVariable();
+    std::vector<int> clause;
+    for (unsigned i=0; i<mAttractors.size(); i++)
+    {
+        const std::vector<uint64_t>& r_states = mAttractors[i];
+        unsigned words_per_state = r_states.size() / mAttractorLength[i];
+        for (unsigned j=0; j<mAttractorLength[i]; j++)
+        {
+            clause.assign(1, -activation);
+            for (unsigned node=0; node<nodes_number; node++)
+            {
+                bool value = TruthTableNetwork::getNodeValue(&r_states[j * words_per_state], node);
+                clause.push_back(value ? -r_final[node] : r_final[node]);
+            }
+            mSolver.addClause(clause);
+        }
+    }
+    bool complete = !mSolver.solve(std::vector<int>(1, activation));
+    mSolver.addClause(std::vector<int>(1, -activation));
+    mComplete = mComplete || complete;
+    return complete;
+}
+
+void SatAttractorFinder::findFixedPoints()
+{
+    if (mSearchedLength < 1)
+    {
+        searchLength(1);
+    }
+}
+
+void SatAttractorFinder::findAttractors(unsigned max_length)
+{
+    if (max_length == 0)
+        EXCEPTION("The maximum length must be greater than 0.");
+
+    unsigned length = 1;
+    while (!mComplete)
+    {
+        length = std::min(length, max_length);
+        if (length > mSearchedLength)
+        {
+            searchLength(length);
+        }
+        if (checkCompleteness(length) || length == max_length)
+        {
+            break;
+        }
+        length *= 2;
+    }
+}
+
+unsigned SatAttractorFinder::getAttractorsNumber() const
+{
+    return mAttractors.size();
+}
+
+unsigned SatAttractorFinder::getAttractorLength(unsigned index) const
+{
+    if (index >= mAttractors.size())
+        EXCEPTION("Error, attractor index must be < number of attractors.");
+    return mAttractorLength[index];
+}
+
+const std::vector<uint64_t>& SatAttractorFinder::getAttractorStates(unsigned index) const
+{
+    if (index >= mAttractors.size())
+        EXCEPTION("Error, attractor index must be < number of attractors.");
+    return mAttractors[index];
+}
+
+unsigned SatAttractorFinder::getSearchedLength() const
+{
+    return mSearchedLength;
+}
+
+bool SatAttractorFinder::isComplete() const
+{
+    return mComplete;
+}
+
+unsigned long SatAttractorFinder::getConflictsNumber() const
+{
+    return mSolver.getConflictsNumber();
+}
@@ -0,0 +1,145 @@
+#ifndef SATATTRACTORFINDER_HPP_
+#define SATATTRACTORFINDER_HPP_
+
+#include "TruthTableNetwork.hpp"
+#include "SatSolver.hpp"
+#include "Exception.hpp"
+#include <vector>
+#include <stdint.h>
+
+/**
+ * Bounded attractor search with a SAT solver, for networks too large for
+ * the symbolic algorithms of RandomBooleanNetwork.
+ *
+ * The synchronous transition function is unrolled k steps: s_0, ..., s_k
+ * are copies of the state variables and every row of the truth table of a
+ * node gives a clause linking s_t to s_t+1. A model in which s_j = s_0
+ * for some 0 < j <= k is a state of a cycle of length <= k. The cycle is
+ * then walked with TruthTableNetwork::update() and all its states are
+ * excluded from s_0 with blocking clauses, until the formula becomes
+ * unsatisfiable: at that point all the attractors of length <= k have been
+ * found. The bound k starts from 1 (fixed points) and is doubled until
+ * every state is in one of the attractors found after k steps, i.e. until
+ * there is no model in which s_k is outside them: then no attractor is
+ * missing, whatever its length.
+ *
+ * The solver is incremental: the unrolling, the learnt clauses and the
+ * blocking clauses are kept when k grows, and the disjunction of the
+ * cycle conditions of every bound is switched on by an activation literal.
+ * A node with K inputs gives 2^K clauses per step, so the encoding suits
+ * networks with many nodes and small in-degree.
+ */
+class SatAttractorFinder
+{
+private:
+
+    /** The network */
+    const TruthTableNetwork& mrNetwork;
+
+    /** The incremental solver */
+    SatSolver mSolver;
+
+    /** The i-th entry contains the variables of the state s_i */
+    std::vector<std::vector<int> > mStateVariables;
+
+    /** The j-th entry is a variable implying s_j+1 = s_0 */
+    std::vector<int> mCycleVariables;
+
+    /** The states of every attractor found, starting from the minimal one */
+    std::vector<std::vector<uint64_t> > mAttractors;
+
+    /** The lengths of the attractors found */
+    std::vector<unsigned> mAttractorLength;
+
+    /** All the attractors whose length is <= this bound have been found */
+    unsigned mSearchedLength;
+
+    /** Whether all the attractors have been found */
+    bool mComplete;
+
+    /**
+     * Add the state variables and the transition clauses up to s_steps.
+     *
+     * @param steps number of steps of the unrolling
+     */
+    void unroll(unsigned steps);
+
+    /**
+     * Find all the attractors of length <= a bound which have not been found yet.
+     *
+     * @param length the bound
+     *
+     * @return the number of new attractors.
+     */
+    unsigned searchLength(unsigned length);
+
+    /**
+     * Check whether every trajectory of a given length ends in one of the
+     * attractors found.
+     *
+     * @param length the length of the trajectories
+     *
+     * @return true if no attractor is missing.
+     */
+    bool checkCompleteness(unsigned length);
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rNetwork the network (it must live as long as this object)
+     */
+    SatAttractorFinder(const TruthTableNetwork& rNetwork);
+
+    /**
+     * Find all the fixed points of the network.
+     */
+    void findFixedPoints();
+
+    /**
+     * Find the attractors doubling the bound on their length, until all the
+     * attractors have been found or the maximum bound is reached. If the
+     * search is not complete, attractors longer than getSearchedLength()
+     * may be missing. The attractors of previous searches are kept.
+     *
+     * @param max_length maximum bound on the length of the attractors
+     */
+    void findAttractors(unsigned max_length);
+
+    /**
+     * @return the number of attractors found.
+     */
+    unsigned getAttractorsNumber() const;
+
+    /**
+     * @param index index of the attractor
+     *
+     * @return the length of the attractor.
+     */
+    unsigned getAttractorLength(unsigned index) const;
+
+    /**
+     * @param index index of the attractor
+     *
+     * @return the packed states of the cycle, starting from the minimal one.
+     */
+    const std::vector<uint64_t>& getAttractorStates(unsigned index) const;
+
+    /**
+     * @return the bound on the length for which the search is exhaustive.
+     */
+    unsigned getSearchedLength() const;
+
+    /**
+     * @return true if all the attractors of the network have been found.
+     */
+    bool isComplete() const;
+
+    /**
+     * @return the number of conflicts of the SAT solver so far.
+     */
+    unsigned long getConflictsNumber() const;
+};
+
+#endif /* SATATTRACTORFINDER_HPP_ */
@@ -0,0 +1,457 @@
+#include "SatSolver.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+
+/**
+ * The Luby sequence 1, 1, 2, 1, 1, 2, 4, 1, ... used for the restarts.
+ *
+ * @param index index in the sequence (from 0)
+ *
+ * @return the index-th element of the sequence.
+ */
+unsigned long getLubyValue(unsigned long index);
+
+/* Internal literals: 2*variable for the positive literal, 2*variable+1 for
+ * the negative one, with variables numbered from 0. */
+
+/**
+ * @param literal a DIMACS literal
+ *
+ * @return the internal literal.
+ */
+static inline int toInternalLiteral(int literal)
+{
+    return literal > 0 ? 2*(literal - 1) : 2*(-literal - 1) + 1;
+}
+
+SatSolver::SatSolver() :
+mActivityIncrement(1.0),
+mPropagationHead(0),
+mUnsatisfiable(false),
+mConflictsNumber(0)
+{
+}
+
+int SatSolver::newVariable()
+{
+    int variable = mValues.size();
+    mValues.push_back(0);
+    mLevels.push_back(0);
+    mReasons.push_back(-1);
+    mPolarity.push_back(false);
+    mActivity.push_back(0.0);
+    mHeapPosition.push_back(-1);
+    mSeen.push_back(false);
+    mWatches.resize(mWatches.size() + 2);
+    heapInsert(variable);
+    return variable + 1;
+}
+
+int SatSolver::getVariablesNumber() const
+{
+    return mValues.size();
+}
+
+int SatSolver::getLiteralValue(int literal) const
+{
+    int value = mValues[literal >> 1];
+    return (literal & 1) ? -value : value;
+}
+
+void SatSolver::enqueue(int literal, int reason)
+{
+    int variable = literal >> 1;
+    assert(mValues[variable] == 0);
+    mValues[variable] = (literal & 1) ? -1 : 1;
+    mLevels[variable] = mTrailLimits.size();
+    mReasons[variable] = reason;
+    mTrail.push_back(literal);
+}
+
+int SatSolver::attachClause(const std::vector<int>& rLiterals)
+{
+    assert(rLiterals.size() >= 2);
+    int index = mClauses.size();
+    mClauses.push_back(rLiterals);
+    mWatches[rLiterals[0]].push_back(index);
+    mWatches[rLiterals[1]].push_back(index);
+    return index;
+}
+
+bool SatSolver::addClause(const std::vector<int>& literals)
+{
+    assert(mTrailLimits.empty());
+    if (mUnsatisfiable) return false;
+
+    std::vector<int> clause;
+    for (unsigned i=0; i<literals.size(); i++)
+    {
+        assert(literals[i] != 0 && std::abs(literals[i]) <= (int) mValues.size());
+        clause.push_back(toInternalLiteral(literals[i]));
+    }
+    std::sort(clause.begin(), clause.end());
+    clause.erase(std::unique(clause.begin(), clause.end()), clause.end());
+
+    /* Literals false at level 0 are dropped; tautologies and satisfied
+     * clauses are ignored. */
+    unsigned size = 0;
+    for (unsigned i=0; i<clause.size(); i++)
+    {
+        if (i > 0 && clause[i] == (clause[i-1] ^ 1)) return true;
+        int value = getLiteralValue(clause[i]);
+        if (value > 0) return true;
+        if (value == 0) clause[size++] = clause[i];
+    }
+    clause.resize(size);
+
+    if (clause.empty())
+    {
+        mUnsatisfiable = true;
+    }
+    else if (clause.size() == 1)
+    {
+        enqueue(clause[0], -1);
+        mUnsatisfiable = propagate() >= 0;
+    }
+    else
+    {
+        attachClause(clause);
+    }
+    return !mUnsatisfiable;
+}
+
+int SatSolver::propagate()
+{
+    int conflict = -1;
+    while (mPropagationHead < mTrail.size() && conflict < 0)
+    {
+        int false_literal = mTrail[mPropagationHead++] ^ 1;
+        std::vector<int>& r_watches = mWatches[false_literal];
+        unsigned kept = 0;
+        unsigned i = 0;
+        for ( ; i<r_watches.size(); i++)
+        {
+            int index = r_watches[i];
+            std::vector<int>& r_clause = mClauses[index];
+            /* The false literal is moved in the second position. */
+            if (r_clause[0] == false_literal)
+            {
+                std::swap(r_clause[0], r_clause[1]);
+            }
+            if (getLiteralValue(r_clause[0]) > 0)
+            {
+                r_watches[kept++] = index;
+                continue;
+            }
+            bool moved = false;
+            for (unsigned k=2; k<r_clause.size(); k++)
+            {
+                if (getLiteralValue(r_clause[k]) >= 0)
+                {
+                    std::swap(r_clause[1], r_clause[k]);
+                    mWatches[r_clause[1]].push_back(index);
+                    moved = true;
+                    break;
+                }
+            }
+            if (moved) continue;
+
+            r_watches[kept++] = index;
+            if (getLiteralValue(r_clause[0]) < 0)
+            {
+                conflict = index;
+                i++;
+                break;
+            }
+            enqueue(r_clause[0], index);
+        }
+        for ( ; i<r_watches.size(); i++)
+        {
+            r_watches[kept++] = r_watches[i];
+        }
+        r_watches.resize(kept);
+    }
+    return conflict;
+}
+
+int SatSolver::analyse(int conflict, std::vector<int>& rLearnt)
+{
+    int level = mTrailLimits.size();
+    rLearnt.assign(1, -1);
+    int paths_number = 0;
+    int literal = -1;
+    int trail_index = mTrail.size() - 1;
+    do
+    {
+        assert(conflict >= 0);
+        const std::vector<int>& r_clause = mClauses[conflict];
+        /* The first literal of a reason clause is the implied one. */
+        for (unsigned i=(literal < 0 ? 0 : 1); i<r_clause.size(); i++)
+        {
+            int variable = r_clause[i] >> 1;
+            if (mSeen[variable] || mLevels[variable] == 0) continue;
+            mSeen[variable] = true;
+            bumpActivity(variable);
+            if (mLevels[variable] == level)
+            {
+                paths_number++;
+            }
+            else
+            {
+                rLearnt.push_back(r_clause[i]);
+            }
+        }
+        while (!mSeen[mTrail[trail_index] >> 1])
+        {
+            trail_index--;
+        }
+        literal = mTrail[trail_index--];
+        conflict = mReasons[literal >> 1];
+        mSeen[literal >> 1] = false;
+        paths_number--;
+    } while (paths_number > 0);
+    rLearnt[0] = literal ^ 1;
+
+    /* The literal with the highest level is watched with the asserting one. */
+    int backtrack_level = 0;
+    for (unsigned i=1; i<rLearnt.size(); i++)
+    {
+        mSeen[rLearnt[i] >> 1] = false;
+        if (mLevels[rLearnt[i] >> 1] > backtrack_level)
+        {
+            backtrack_level = mLevels[rLearnt[i] >> 1];
+            std::swap(rLearnt[1], rLearnt[i]);
+        }
+    }
+    return backtrack_level;
+}
+
+void SatSolver::backtrack(int level)
+{
+    if ((int) mTrailLimits.size() <= level) return;
+    for (int i=mTrail.size()-1; i>=mTrailLimits[level]; i--)
+    {
+        int variable = mTrail[i] >> 1;
+        mPolarity[variable] = mValues[variable] > 0;
+        mValues[variable] = 0;
+        mReasons[variable] = -1;
+        if (mHeapPosition[variable] < 0)
+        {
+            heapInsert(variable);
+        }
+    }
+    mTrail.resize(mTrailLimits[level]);
+    mTrailLimits.resize(level);
+    mPropagationHead = mTrail.size();
+}
+
+void SatSolver::bumpActivity(int variable)
+{
+    mActivity[variable] += mActivityIncrement;
+    if (mActivity[variable] > 1e100)
+    {
+        /* Rescaling keeps the order of the heap. */
+        for (unsigned i=0; i<mActivity.size(); i++)
+        {
+            mActivity[i] *= 1e-100;
+        }
+        mActivityIncrement *= 1e-100;
+    }
+    if (mHeapPosition[variable] >= 0)
+    {
+        heapUp(mHeapPosition[variable]);
+    }
+}
+
+int SatSolver::pickBranchVariable()
+{
+    while (!mHeap.empty())
+    {
+        int variable = mHeap[0];
+        mHeap[0] = mHeap.back();
+        mHeapPosition[mHeap[0]] = 0;
+        mHeap.pop_back();
+        mHeapPosition[variable] = -1;
+        if (!mHeap.empty())
+        {
+            heapDown(0);
+        }
+        if (mValues[variable] == 0)
+        {
+            return variable;
+        }
+    }
+    return -1;
+}
+
+void SatSolver::heapInsert(int variable)
+{
+    mHeapPosition[variable] = mHeap.size();
+    mHeap.push_back(variable);
+    heapUp(mHeap.size() - 1);
+}
+
+void SatSolver::heapUp(int position)
+{
+    int variable = mHeap[position];
+    while (position > 0)
+    {
+        int parent = (position - 1) / 2;
+        if (mActivity[mHeap[parent]] >= mActivity[variable]) break;
+        mHeap[position] = mHeap[parent];
+        mHeapPosition[mHeap[position]] = position;
+        position = parent;
+    }
+    mHeap[position] = variable;
+    mHeapPosition[variable] = position;
+}
+
+void SatSolver::heapDown(int position)
+{
+    int variable = mHeap[position];
+    int size = mHeap.size();
+    while (2*position + 1 < size)
+    {
+        int child = 2*position + 1;
+        if (child + 1 < size && mActivity[mHeap[child + 1]] > mActivity[mHeap[child]])
+        {
+            child++;
+        }
+        if (mActivity[mHeap[child]] <= mActivity[variable]) break;
+        mHeap[position] = mHeap[child];
+        mHeapPosition[mHeap[position]] = position;
+        position = child;
+    }
+    mHeap[position] = variable;
+    mHeapPosition[variable] = position;
+}
+
+int SatSolver::search(unsigned long conflicts_limit, const std::vector<int>& rAssumptions)
+{
+    unsigned long conflicts_number = 0;
+    std::vector<int> learnt;
+    while (true)
+    {
+        int conflict = propagate();
+        if (conflict >= 0)
+        {
+            conflicts_number++;
+            mConflictsNumber++;
+            if (mTrailLimits.empty())
+            {
+                mUnsatisfiable = true;
+                return 0;
+            }
+            int backtrack_level = analyse(conflict, learnt);
+            backtrack(backtrack_level);
+            if (learnt.size() == 1)
+            {
+                enqueue(learnt[0], -1);
+            }
+            else
+            {
+                enqueue(learnt[0], attachClause(learnt));
+            }
+            mActivityIncrement /= 0.95;
+            continue;
+        }
+
+        if (conflicts_number >= conflicts_limit)
+        {
+            backtrack(0);
+            return -1;
+        }
+
+        /* The assumptions are the first decisions; an assumption already
+         * true opens an empty level. */
+        int decision = -1;
+        while (mTrailLimits.size() < rAssumptions.size())
+        {
+            int literal = rAssumptions[mTrailLimits.size()];
+            int value = getLiteralValue(literal);
+            if (value > 0)
+            {
+                mTrailLimits.push_back(mTrail.size());
+            }
+            else if (value < 0)
+            {
+                return 0;
+            }
+            else
+            {
+                decision = literal;
+                break;
+            }
+        }
+        if (decision < 0)
+        {
+            int variable = pickBranchVariable();
+            if (variable < 0)
+            {
+                return 1;
+            }
+            decision = 2*variable + (mPolarity[variable] ? 0 : 1);
+        }
+        mTrailLimits.push_back(mTrail.size());
+        enqueue(decision, -1);
+    }
+}
+
+bool SatSolver::solve(const std::vector<int>& assumptions)
+{
+    assert(mTrailLimits.empty());
+    if (mUnsatisfiable) return false;
+
+    std::vector<int> internal_assumptions;
+    for (unsigned i=0; i<assumptions.size(); i++)
+    {
+        internal_assumptions.push_back(toInternalLiteral(assumptions[i]));
+    }
+
+    int status = -1;
+    for (unsigned long restart=0; status < 0; restart++)
+    {
+        status = search(100*getLubyValue(restart), internal_assumptions);
+    }
+    if (status > 0)
+    {
+        mModel.resize(mValues.size());
+        for (unsigned i=0; i<mValues.size(); i++)
+        {
+            mModel[i] = mValues[i] > 0;
+        }
+    }
+    backtrack(0);
+    return status > 0;
+}
+
+bool SatSolver::getModelValue(int variable) const
+{
+    assert(variable > 0 && variable <= (int) mModel.size());
+    return mModel[variable - 1];
+}
+
+unsigned long SatSolver::getConflictsNumber() const
+{
+    return mConflictsNumber;
+}
+
+unsigned long getLubyValue(unsigned long index)
+{
+    /* Find the finite subsequence containing the index and its position. */
+    unsigned long size = 1;
+    unsigned sequence = 0;
+    while (size < index + 1)
+    {
+        sequence++;
+        size = 2*size + 1;
+    }
+    while (size - 1 != index)
+    {
+        size = (size - 1) >> 1;
+        sequence--;
+        index = index % size;
+    }
+    return 1ul << sequence;
+}
@@ -0,0 +1,202 @@
+#ifndef SATSOLVER_HPP_
+#define SATSOLVER_HPP_
+
+#include <vector>
+
+/**
+ * A small incremental CDCL SAT solver: two watched literals, VSIDS
+ * branching with phase saving, first-UIP clause learning and Luby
+ * restarts. Clauses can be added between calls to solve(), and solve()
+ * accepts assumptions, so activation literals can switch groups of
+ * clauses on and off.
+ *
+ * Variables are numbered from 1 and literals use the DIMACS convention:
+ * v is the positive literal of variable v, -v the negative one.
+ */
+class SatSolver
+{
+private:
+
+    /** The clauses (original and learnt), as internal literals */
+    std::vector<std::vector<int> > mClauses;
+
+    /** For every internal literal, the clauses in which it is watched */
+    std::vector<std::vector<int> > mWatches;
+
+    /** The value of every variable: 1 true, -1 false, 0 unassigned */
+    std::vector<signed char> mValues;
+
+    /** The decision level at which every variable was assigned */
+    std::vector<int> mLevels;
+
+    /** The clause which implied every variable, or -1 */
+    std::vector<int> mReasons;
+
+    /** The last value of every variable (phase saving) */
+    std::vector<bool> mPolarity;
+
+    /** The VSIDS activity of every variable */
+    std::vector<double> mActivity;
+
+    /** Amount added to the activity of a variable in a conflict */
+    double mActivityIncrement;
+
+    /** Binary heap of variables ordered by activity */
+    std::vector<int> mHeap;
+
+    /** The position of every variable in mHeap, or -1 */
+    std::vector<int> mHeapPosition;
+
+    /** Assigned literals in chronological order */
+    std::vector<int> mTrail;
+
+    /** The position in mTrail of the first literal of every decision level */
+    std::vector<int> mTrailLimits;
+
+    /** The next literal of mTrail to propagate */
+    unsigned mPropagationHead;
+
+    /** Marks used by the conflict analysis */
+    std::vector<bool> mSeen;
+
+    /** The values of the variables in the last model */
+    std::vector<bool> mModel;
+
+    /** Whether the clauses are unsatisfiable without any assumption */
+    bool mUnsatisfiable;
+
+    /** The number of conflicts so far */
+    unsigned long mConflictsNumber;
+
+    /**
+     * @param literal an internal literal
+     *
+     * @return 1 if the literal is true, -1 if false, 0 if unassigned.
+     */
+    int getLiteralValue(int literal) const;
+
+    /**
+     * Assign a literal.
+     *
+     * @param literal the internal literal
+     * @param reason the clause implying it, or -1 for decisions
+     */
+    void enqueue(int literal, int reason);
+
+    /**
+     * Propagate the assigned literals with the watched literals.
+     *
+     * @return the index of a conflicting clause, or -1.
+     */
+    int propagate();
+
+    /**
+     * First-UIP conflict analysis.
+     *
+     * @param conflict the conflicting clause
+     * @param rLearnt filled with the learnt clause, the asserting literal first
+     *
+     * @return the decision level to backtrack to.
+     */
+    int analyse(int conflict, std::vector<int>& rLearnt);
+
+    /**
+     * Undo all the assignments above a decision level.
+     *
+     * @param level the decision level
+     */
+    void backtrack(int level);
+
+    /**
+     * Add a clause and watch its first two literals.
+     *
+     * @param rLiterals the internal literals (at least two)
+     *
+     * @return the index of the clause.
+     */
+    int attachClause(const std::vector<int>& rLiterals);
+
+    /**
+     * Increase the activity of a variable.
+     *
+     * @param variable the (internal) variable
+     */
+    void bumpActivity(int variable);
+
+    /**
+     * @return the unassigned variable with highest activity, or -1.
+     */
+    int pickBranchVariable();
+
+    /** Insert a variable in the heap */
+    void heapInsert(int variable);
+
+    /** Move a variable towards the root of the heap */
+    void heapUp(int position);
+
+    /** Move a variable towards the leaves of the heap */
+    void heapDown(int position);
+
+    /**
+     * Run CDCL until a model, a conflict at level 0, a false assumption or
+     * the conflicts limit.
+     *
+     * @param conflicts_limit maximum number of conflicts
+     * @param rAssumptions the internal literals assumed true
+     *
+     * @return 1 if satisfiable, 0 if unsatisfiable, -1 to restart.
+     */
+    int search(unsigned long conflicts_limit, const std::vector<int>& rAssumptions);
+
+public:
+
+    /**
+     * Constructor: an empty formula.
+     */
+    SatSolver();
+
+    /**
+     * Add a variable.
+     *
+     * @return the new variable (DIMACS numbering).
+     */
+    int newVariable();
+
+    /**
+     * @return the number of variables.
+     */
+    int getVariablesNumber() const;
+
+    /**
+     * Add a clause. Duplicated literals are removed and tautologies are
+     * ignored. It must not be called during solve().
+     *
+     * @param literals the DIMACS literals of the clause
+     *
+     * @return false if the formula became unsatisfiable.
+     */
+    bool addClause(const std::vector<int>& literals);
+
+    /**
+     * Solve the formula under some assumptions.
+     *
+     * @param assumptions DIMACS literals assumed true for this call only
+     *
+     * @return true if a model exists.
+     */
+    bool solve(const std::vector<int>& assumptions = std::vector<int>());
+
+    /**
+     * @param variable a variable (DIMACS numbering)
+     *
+     * @return the value of the variable in the last model.
+     */
+    bool getModelValue(int variable) const;
+
+    /**
+     * @return the number of conflicts so far.
+     */
+    unsigned long getConflictsNumber() const;
+};
+
+#endif /* SATSOLVER_HPP_ */
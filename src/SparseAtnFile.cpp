@@ -0,0 +1,453 @@
+#include "SparseAtnFile.hpp"
+#include "OutputFileHandler.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/** The magic characters of the binary format */
+static const char BINARY_MAGIC[8] = {'C', 'O', 'G', 'N', 'A', 'C', 'B', '1'};
+
+/** Written in the binary format to detect the byte order */
+static const unsigned BYTE_ORDER_MARK = 0x01020304;
+
+/** The size of the buffer of the text writer */
+static const unsigned WRITE_BUFFER_SIZE = 1 << 16;
+
+/**
+ * A file mapped in memory, read only; it is unmapped and closed by the
+ * destructor.
+ */
+class MemoryMappedFile
+{
+private:
+
+    /** The file descriptor */
+    int mFile;
+
+    /** The first byte of the map, or NULL */
+    const char* mpData;
+
+    /** The size of the file */
+    size_t mSize;
+
+public:
+
+    /**
+     * Constructor: it opens and maps the file.
+     *
+     * @param rFilePath the path of the file
+     */
+    MemoryMappedFile(const std::string& rFilePath) :
+    mFile(open(rFilePath.c_str(), O_RDONLY)),
+    mpData(NULL),
+    mSize(0)
+    {
+        struct stat status;
+        if (mFile < 0 || fstat(mFile, &status) != 0)
+        {
+            if (mFile >= 0) close(mFile);
+            EXCEPTION("Not able to open the file.");
+        }
+        mSize = status.st_size;
+        if (mSize == 0) return;
+        void* p_map = mmap(NULL, mSize, PROT_READ, MAP_PRIVATE, mFile, 0);
+        if (p_map == MAP_FAILED)
+        {
+            close(mFile);
+            EXCEPTION("Not able to open the file.");
+        }
+        madvise(p_map, mSize, MADV_SEQUENTIAL);
+        mpData = static_cast<const char*>(p_map);
+    }
+
+    /**
+     * Destructor.
+     */
+    ~MemoryMappedFile()
+    {
+        if (mpData) munmap(const_cast<char*>(mpData), mSize);
+        close(mFile);
+    }
+
+    /**
+     * @return the first byte.
+     */
+    const char* begin() const
+    {
+        return mpData;
+    }
+
+    /**
+     * @return past the last byte.
+     */
+    const char* end() const
+    {
+        return mpData + mSize;
+    }
+};
+
+/**
+ * @param p the current character
+ * @param p_end past the last character
+ *
+ * @return the first character which is not a space or in a comment.
+ */
+static const char* skipSpaces(const char* p, const char* p_end)
+{
+    while (p < p_end)
+    {
+        if (*p == '#')
+        {
+            while (p < p_end && *p != '\n') p++;
+        }
+        else if (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') p++;
+        else break;
+    }
+    return p;
+}
+
+/**
+ * @param p the current character
+ * @param p_end past the last character
+ * @param p_word the word expected
+ *
+ * @return past the word, or NULL if it is not there.
+ */
+static const char* parseWord(const char* p, const char* p_end, const char* p_word)
+{
+    if (p == NULL) return NULL;
+    p = skipSpaces(p, p_end);
+    size_t length = strlen(p_word);
+    if ((size_t) (p_end - p) < length || strncmp(p, p_word, length) != 0) return NULL;
+    return p + length;
+}
+
+/**
+ * @param p the current character
+ * @param p_end past the last character
+ * @param rValue the number read
+ *
+ * @return past the number, or NULL if there is no unsigned number.
+ */
+static const char* parseUnsigned(const char* p, const char* p_end, unsigned& rValue)
+{
+    if (p == NULL) return NULL;
+    p = skipSpaces(p, p_end);
+    const char* p_start = p;
+    unsigned long long value = 0;
+    for (; p < p_end && *p >= '0' && *p <= '9'; p++)
+    {
+        value = value * 10 + (*p - '0');
+        if (value > UINT_MAX) return NULL;
+    }
+    if (p == p_start) return NULL;
+    rValue = (unsigned) value;
+    return p;
+}
+
+/**
+ * @param p the current character
+ * @param p_end past the last character
+ * @param rValue the number read
+ *
+ * @return past the number, or NULL if there is no number.
+ */
+static const char* parseDouble(const char* p, const char* p_end, double& rValue)
+{
+    if (p == NULL) return NULL;
+    p = skipSpaces(p, p_end);
+    /* The map is not terminated by '\0', so the number is copied. */
+    char p_token[64];
+    unsigned length = 0;
+    for (; p < p_end && length < sizeof(p_token) - 1 && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r'; p++)
+    {
+        p_token[length++] = *p;
+    }
+    /* A longer token is not a number, and it must not be read in pieces. */
+    if (length == sizeof(p_token) - 1) return NULL;
+    p_token[length] = '\0';
+    char* p_token_end;
+    rValue = strtod(p_token, &p_token_end);
+    if (length == 0 || p_token_end != p_token + length) return NULL;
+    return p;
+}
+
+/**
+ * @param value a value read from a file
+ *
+ * @return true if it can be a transition probability: NaN, infinities,
+ * negative values and values above 1 cannot.
+ */
+static bool isProbability(double value)
+{
+    return value >= 0.0 && value <= 1.0;
+}
+
+/**
+ * Remove the entries equal to 0 from a matrix in compressed rows, as the
+ * .dat reader does not store them.
+ *
+ * @param size the number of rows
+ * @param rRowOffsets the offsets of the rows (size + 1)
+ * @param rColumns the column of every entry
+ * @param rValues the value of every entry
+ */
+static void removeZeroEntries(unsigned size, std::vector<unsigned>& rRowOffsets, std::vector<unsigned>& rColumns,
+        std::vector<double>& rValues)
+{
+    unsigned kept = 0;
+    unsigned row_begin = 0;
+    for (unsigned i=0; i<size; i++)
+    {
+        unsigned row_end = rRowOffsets[i+1];
+        for (unsigned k=row_begin; k<row_end; k++)
+        {
+            if (rValues[k] == 0.0) continue;
+            rColumns[kept] = rColumns[k];
+            rValues[kept] = rValues[k];
+            kept++;
+        }
+        rRowOffsets[i+1] = kept;
+        row_begin = row_end;
+    }
+    rColumns.resize(kept);
+    rValues.resize(kept);
+}
+
+bool SparseAtnFile::parseText(const char* p_begin, const char* p_end, StochasticMatrix& rMatrix,
+        std::vector<unsigned>& rAttractorLength)
+{
+    unsigned size = 0;
+    unsigned entries = 0;
+    const char* p = parseWord(p_begin, p_end, "attractors");
+    p = parseUnsigned(p, p_end, size);
+    p = parseWord(p, p_end, "entries");
+    p = parseUnsigned(p, p_end, entries);
+    if (p == NULL) return false;
+    /* Every length takes at least 2 characters and every entry 6 (each
+     * number follows a separator): larger counts cannot fit in the file,
+     * and are rejected before anything is allocated. */
+    if ((unsigned long long) size * 2 + (unsigned long long) entries * 6 > (unsigned long long) (p_end - p))
+        return false;
+    std::vector<unsigned> attractor_length(size);
+    for (unsigned i=0; i<size && p; i++)
+    {
+        p = parseUnsigned(p, p_end, attractor_length[i]);
+    }
+
+    std::vector<unsigned> rows;
+    std::vector<unsigned> columns;
+    std::vector<double> values;
+    rows.reserve(entries);
+    columns.reserve(entries);
+    values.reserve(entries);
+    bool sorted = true;
+    for (unsigned k=0; k<entries && p; k++)
+    {
+        unsigned row = 0;
+        unsigned column = 0;
+        double value = 0.0;
+        p = parseUnsigned(p, p_end, row);
+        p = parseUnsigned(p, p_end, column);
+        p = parseDouble(p, p_end, value);
+        if (p == NULL || row >= size || column >= size || !isProbability(value)) return false;
+        if (k > 0 && (row < rows.back() || (row == rows.back() && column <= columns.back()))) sorted = false;
+        rows.push_back(row);
+        columns.push_back(column);
+        values.push_back(value);
+    }
+    if (p == NULL || skipSpaces(p, p_end) != p_end) return false;
+
+    if (!sorted)
+    {
+        std::vector<std::pair<std::pair<unsigned, unsigned>, double> > coordinates(entries);
+        for (unsigned k=0; k<entries; k++)
+        {
+            coordinates[k] = std::make_pair(std::make_pair(rows[k], columns[k]), values[k]);
+        }
+        std::sort(coordinates.begin(), coordinates.end());
+        for (unsigned k=0; k<entries; k++)
+        {
+            if (k > 0 && coordinates[k].first == coordinates[k-1].first) return false;
+            rows[k] = coordinates[k].first.first;
+            columns[k] = coordinates[k].first.second;
+            values[k] = coordinates[k].second;
+        }
+    }
+    std::vector<unsigned> row_offsets(size + 1, 0);
+    for (unsigned k=0; k<entries; k++)
+    {
+        row_offsets[rows[k] + 1]++;
+    }
+    for (unsigned i=0; i<size; i++)
+    {
+        row_offsets[i+1] += row_offsets[i];
+    }
+    removeZeroEntries(size, row_offsets, columns, values);
+    StochasticMatrix matrix(size, row_offsets, columns, values);
+    rMatrix.swap(matrix);
+    rAttractorLength.swap(attractor_length);
+    return true;
+}
+
+bool SparseAtnFile::parseBinary(const char* p_begin, const char* p_end, StochasticMatrix& rMatrix,
+        std::vector<unsigned>& rAttractorLength)
+{
+    unsigned header[3];
+    size_t file_size = p_end - p_begin;
+    if (file_size < sizeof(BINARY_MAGIC) + sizeof(header)
+            || memcmp(p_begin, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0) return false;
+    const char* p = p_begin + sizeof(BINARY_MAGIC);
+    memcpy(header, p, sizeof(header));
+    p += sizeof(header);
+    unsigned size = header[1];
+    unsigned entries = header[2];
+    unsigned long long expected_size = sizeof(BINARY_MAGIC) + sizeof(header)
+            + sizeof(unsigned) * (2ULL * size + 1 + entries) + sizeof(double) * (unsigned long long) entries;
+    if (header[0] != BYTE_ORDER_MARK || expected_size != file_size) return false;
+
+    std::vector<unsigned> attractor_length(size);
+    std::vector<unsigned> row_offsets(size + 1);
+    std::vector<unsigned> columns(entries);
+    std::vector<double> values(entries);
+    if (size > 0) memcpy(&attractor_length[0], p, sizeof(unsigned) * size);
+    p += sizeof(unsigned) * size;
+    memcpy(&row_offsets[0], p, sizeof(unsigned) * (size + 1));
+    p += sizeof(unsigned) * (size + 1);
+    if (entries > 0)
+    {
+        memcpy(&columns[0], p, sizeof(unsigned) * entries);
+        p += sizeof(unsigned) * entries;
+        memcpy(&values[0], p, sizeof(double) * entries);
+    }
+
+    if (row_offsets[0] != 0 || row_offsets[size] != entries) return false;
+    for (unsigned i=0; i<size; i++)
+    {
+        if (row_offsets[i+1] < row_offsets[i]) return false;
+        for (unsigned k=row_offsets[i]; k<row_offsets[i+1]; k++)
+        {
+            if (columns[k] >= size || (k > row_offsets[i] && columns[k] <= columns[k-1])) return false;
+            if (!isProbability(values[k])) return false;
+        }
+    }
+    removeZeroEntries(size, row_offsets, columns, values);
+    StochasticMatrix matrix(size, row_offsets, columns, values);
+    rMatrix.swap(matrix);
+    rAttractorLength.swap(attractor_length);
+    return true;
+}
+
+bool SparseAtnFile::isBinary(const std::string& rFileName)
+{
+    if (rFileName.size() > 5 && rFileName.compare(rFileName.size()-5,5,".atnb") == 0) return true;
+    if (rFileName.size() > 4 && rFileName.compare(rFileName.size()-4,4,".atn") == 0) return false;
+    EXCEPTION("File path not valid. It must terminate with '.atn' or '.atnb' extension.");
+}
+
+void SparseAtnFile::read(const std::string& rFilePath, StochasticMatrix& rMatrix,
+        std::vector<unsigned>& rAttractorLength)
+{
+    bool binary = isBinary(rFilePath);
+    MemoryMappedFile file(rFilePath);
+    bool parsed = binary ? parseBinary(file.begin(), file.end(), rMatrix, rAttractorLength)
+            : parseText(file.begin(), file.end(), rMatrix, rAttractorLength);
+    if (!parsed)
+        EXCEPTION("Error reading the file.");
+}
+
+void SparseAtnFile::writeText(std::ostream& rStream, const StochasticMatrix& rMatrix,
+        const std::vector<unsigned>& rAttractorLength)
+{
+    unsigned size = rMatrix.getSize();
+    if (rAttractorLength.size() != size)
+        EXCEPTION("Rows (and columns) in stochastic matrix must be equal to the number of attractors");
+
+    std::string buffer;
+    buffer.reserve(WRITE_BUFFER_SIZE + 64);
+    char p_line[64];
+    buffer += "#This file has been generated by CoGNaC\n";
+    buffer += "#Attractor transition network: attractor lengths, then row column value\n";
+    snprintf(p_line, sizeof(p_line), "attractors %u entries %u\n", size, rMatrix.getNonZerosNumber());
+    buffer += p_line;
+    for (unsigned i=0; i<size; i++)
+    {
+        snprintf(p_line, sizeof(p_line), i + 1 < size ? "%u " : "%u\n", rAttractorLength[i]);
+        buffer += p_line;
+        if (buffer.size() >= WRITE_BUFFER_SIZE)
+        {
+            rStream.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    }
+    const unsigned* p_row_offsets = rMatrix.getRowOffsets();
+    const unsigned* p_columns = rMatrix.getColumns();
+    const double* p_values = rMatrix.getValues();
+    for (unsigned row=0; row<size; row++)
+    {
+        for (unsigned entry=p_row_offsets[row]; entry<p_row_offsets[row+1]; entry++)
+        {
+            snprintf(p_line, sizeof(p_line), "%u %u %.17g\n", row, p_columns[entry], p_values[entry]);
+            buffer += p_line;
+            if (buffer.size() >= WRITE_BUFFER_SIZE)
+            {
+                rStream.write(buffer.data(), buffer.size());
+                buffer.clear();
+            }
+        }
+    }
+    rStream.write(buffer.data(), buffer.size());
+}
+
+void SparseAtnFile::writeBinary(std::ostream& rStream, const StochasticMatrix& rMatrix,
+        const std::vector<unsigned>& rAttractorLength)
+{
+    unsigned size = rMatrix.getSize();
+    if (rAttractorLength.size() != size)
+        EXCEPTION("Rows (and columns) in stochastic matrix must be equal to the number of attractors");
+
+    unsigned entries = rMatrix.getNonZerosNumber();
+    unsigned header[3] = {BYTE_ORDER_MARK, size, entries};
+    rStream.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    rStream.write(reinterpret_cast<const char*>(header), sizeof(header));
+    if (size > 0)
+    {
+        rStream.write(reinterpret_cast<const char*>(&rAttractorLength[0]), sizeof(unsigned) * size);
+    }
+    rStream.write(reinterpret_cast<const char*>(rMatrix.getRowOffsets()), sizeof(unsigned) * (size + 1));
+    if (entries > 0)
+    {
+        rStream.write(reinterpret_cast<const char*>(rMatrix.getColumns()), sizeof(unsigned) * entries);
+        rStream.write(reinterpret_cast<const char*>(rMatrix.getValues()), sizeof(double) * entries);
+    }
+}
+
+void SparseAtnFile::write(std::string directory, std::string filename, const StochasticMatrix& rMatrix,
+        const std::vector<unsigned>& rAttractorLength)
+{
+    if (directory.empty())
+        EXCEPTION("Directory name not valid.");
+    bool binary = isBinary(filename);
+
+    OutputFileHandler handler(directory,false);
+    out_stream p_file = handler.OpenOutputFile(filename,
+            binary ? std::ios::out | std::ios::trunc | std::ios::binary : std::ios::out | std::ios::trunc);
+    if (binary)
+    {
+        writeBinary(*p_file, rMatrix, rAttractorLength);
+    }
+    else
+    {
+        writeText(*p_file, rMatrix, rAttractorLength);
+    }
+    bool written = p_file->good();
+    p_file->close();
+    if (!written)
+        EXCEPTION("Error writing the file.");
+}
@@ -0,0 +1,115 @@
+#ifndef SPARSEATNFILE_HPP_
+#define SPARSEATNFILE_HPP_
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include "StochasticMatrix.hpp"
+#include "Exception.hpp"
+
+/**
+ * Sparse files of an ATN (the stochastic matrix and the lengths of the
+ * attractors), which replace the dense .dat files for large ATNs.
+ *
+ * The text format (.atn) is
+ *
+ *     #comment lines
+ *     attractors n entries m
+ *     length_1 ... length_n
+ *     row column value        (m lines, 0-based, by row and column)
+ *
+ * The binary format (.atnb) is the CSR form in the byte order of the
+ * machine: the 8 characters "COGNACB1", the 32-bit unsigned 0x01020304
+ * (to detect the byte order), n and m, the n lengths, the n + 1 row
+ * offsets, the m columns (all 32-bit unsigned) and the m values (64-bit
+ * doubles).
+ *
+ * In both formats the values must be in [0, 1]; the entries equal to 0
+ * are dropped, as in the .dat files.
+ *
+ * The files are read in one pass over a memory map, and written through
+ * a buffer.
+ */
+class SparseAtnFile
+{
+private:
+
+    /**
+     * Parse a text file.
+     *
+     * @param p_begin the first character
+     * @param p_end past the last character
+     * @param rMatrix filled with the stochastic matrix
+     * @param rAttractorLength filled with the lengths of the attractors
+     *
+     * @return false if the file is not correct.
+     */
+    static bool parseText(const char* p_begin, const char* p_end, StochasticMatrix& rMatrix,
+            std::vector<unsigned>& rAttractorLength);
+
+    /**
+     * Parse a binary file.
+     *
+     * @param p_begin the first byte
+     * @param p_end past the last byte
+     * @param rMatrix filled with the stochastic matrix
+     * @param rAttractorLength filled with the lengths of the attractors
+     *
+     * @return false if the file is not correct.
+     */
+    static bool parseBinary(const char* p_begin, const char* p_end, StochasticMatrix& rMatrix,
+            std::vector<unsigned>& rAttractorLength);
+
+    /**
+     * @param rFileName the name of a file
+     *
+     * @return true if the name terminates with '.atnb', false if it terminates
+     * with '.atn' (an exception is thrown otherwise).
+     */
+    static bool isBinary(const std::string& rFileName);
+
+public:
+
+    /**
+     * Read a .atn or .atnb file.
+     *
+     * @param rFilePath the path of the file
+     * @param rMatrix filled with the stochastic matrix
+     * @param rAttractorLength filled with the lengths of the attractors
+     */
+    static void read(const std::string& rFilePath, StochasticMatrix& rMatrix,
+            std::vector<unsigned>& rAttractorLength);
+
+    /**
+     * Write an ATN in the text format.
+     *
+     * @param rStream the output stream
+     * @param rMatrix the stochastic matrix
+     * @param rAttractorLength the lengths of the attractors
+     */
+    static void writeText(std::ostream& rStream, const StochasticMatrix& rMatrix,
+            const std::vector<unsigned>& rAttractorLength);
+
+    /**
+     * Write an ATN in the binary format (the stream must be binary).
+     *
+     * @param rStream the output stream
+     * @param rMatrix the stochastic matrix
+     * @param rAttractorLength the lengths of the attractors
+     */
+    static void writeBinary(std::ostream& rStream, const StochasticMatrix& rMatrix,
+            const std::vector<unsigned>& rAttractorLength);
+
+    /**
+     * Save an ATN in a .atn or .atnb file.
+     *
+     * @param directory the name of the subfolder of testoutput.
+     * @param filename the file name of the output file.
+     * @param rMatrix the stochastic matrix
+     * @param rAttractorLength the lengths of the attractors
+     */
+    static void write(std::string directory, std::string filename, const StochasticMatrix& rMatrix,
+            const std::vector<unsigned>& rAttractorLength);
+};
+
+#endif /* SPARSEATNFILE_HPP_ */
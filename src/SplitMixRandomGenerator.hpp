@@ -0,0 +1,63 @@
+#ifndef SPLITMIXRANDOMGENERATOR_HPP_
+#define SPLITMIXRANDOMGENERATOR_HPP_
+
+#include <stdint.h>
+
+/**
+ * Small pseudo-random generator (SplitMix64) for the explicit-state
+ * engines. Unlike the RandomNumberGenerator singleton, every thread (or
+ * batch) can own an instance, so parallel runs stay reproducible: the
+ * instance of a batch is seeded from a global seed and the batch index.
+ */
+class SplitMixRandomGenerator
+{
+private:
+
+    /** The state of the generator */
+    uint64_t mState;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param seed the seed
+     * @param stream index of the stream (e.g. the batch), mixed in the seed
+     */
+    SplitMixRandomGenerator(uint64_t seed, uint64_t stream = 0) :
+    mState(seed ^ (stream * 0xD1B54A32D192ED03ULL))
+    {
+        next();
+    }
+
+    /**
+     * @return 64 random bits.
+     */
+    uint64_t next()
+    {
+        uint64_t z = (mState += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * @return a random number uniformly distributed in [0,1).
+     */
+    double ranf()
+    {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    /**
+     * @param base upper bound (> 0)
+     *
+     * @return a random number uniformly distributed in [0,base).
+     */
+    unsigned randMod(unsigned base)
+    {
+        return (unsigned) (((next() >> 32) * base) >> 32);
+    }
+};
+
+#endif /* SPLITMIXRANDOMGENERATOR_HPP_ */
@@ -0,0 +1,207 @@
+#include "StationaryDistributionSolver.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+
+/**
+ * The dense row-major copy of the entries of a component.
+ *
+ * @param rRows the row of every entry
+ * @param rColumns the column of every entry
+ * @param rValues the value of every entry
+ * @param size the size of the component
+ * @param rMatrix filled with the dense matrix
+ */
+static void fillDenseMatrix(const std::vector<unsigned>& rRows, const std::vector<unsigned>& rColumns,
+        const std::vector<double>& rValues, unsigned size, std::vector<double>& rMatrix)
+{
+    rMatrix.assign((size_t) size * size, 0.0);
+    for (unsigned k=0; k<rValues.size(); k++)
+    {
+        rMatrix[(size_t) rRows[k] * size + rColumns[k]] = rValues[k];
+    }
+}
+
+StationaryDistributionSolver::StationaryDistributionSolver(unsigned direct_size_limit, double tolerance,
+        unsigned max_iterations) :
+mDirectSizeLimit(direct_size_limit),
+mTolerance(tolerance),
+mMaxIterations(max_iterations)
+{
+    if (tolerance <= 0.0 || max_iterations == 0)
+        EXCEPTION("The tolerance and the maximum number of iterations must be greater than 0.");
+}
+
+std::vector<double> StationaryDistributionSolver::solve(const StochasticMatrixView& rMatrix,
+        const std::vector<unsigned>& rComponent) const
+{
+    unsigned size = rComponent.size();
+    assert(size > 0);
+    std::vector<double> distribution;
+    if (size == 1)
+    {
+        distribution.assign(1, 1.0);
+        return distribution;
+    }
+
+    /* The entries of the component, with local indices. */
+    const unsigned* p_row_offsets = rMatrix.getMatrix().getRowOffsets();
+    const unsigned* p_columns = rMatrix.getMatrix().getColumns();
+    std::vector<unsigned> rows;
+    std::vector<unsigned> columns;
+    std::vector<double> values;
+    for (unsigned i=0; i<size; i++)
+    {
+        unsigned state = rComponent[i];
+        assert(i == 0 || state > rComponent[i-1]);
+        for (unsigned entry=p_row_offsets[state]; entry<p_row_offsets[state+1]; entry++)
+        {
+            if (!rMatrix.isKept(entry)) continue;
+            std::vector<unsigned>::const_iterator position =
+                    std::lower_bound(rComponent.begin(), rComponent.end(), p_columns[entry]);
+            if (position == rComponent.end() || *position != p_columns[entry]) continue;
+            rows.push_back(i);
+            columns.push_back(position - rComponent.begin());
+            values.push_back(rMatrix.getValue(state, entry));
+        }
+    }
+
+    std::vector<double> dense_matrix;
+    if (size <= mDirectSizeLimit)
+    {
+        fillDenseMatrix(rows, columns, values, size, dense_matrix);
+        if (solveDirect(dense_matrix, size, distribution)) return distribution;
+    }
+
+    /* The transpose without the diagonal, by counting sort on the columns. */
+    std::vector<unsigned> column_offsets(size + 1, 0);
+    std::vector<double> exit_rates(size, 0.0);
+    for (unsigned k=0; k<values.size(); k++)
+    {
+        if (rows[k] == columns[k]) continue;
+        column_offsets[columns[k] + 1]++;
+        exit_rates[rows[k]] += values[k];
+    }
+    for (unsigned j=0; j<size; j++)
+    {
+        column_offsets[j+1] += column_offsets[j];
+    }
+    std::vector<unsigned> position(column_offsets.begin(), column_offsets.end() - 1);
+    std::vector<unsigned> transpose_rows(column_offsets[size]);
+    std::vector<double> transpose_values(column_offsets[size]);
+    for (unsigned k=0; k<values.size(); k++)
+    {
+        if (rows[k] == columns[k]) continue;
+        transpose_rows[position[columns[k]]] = rows[k];
+        transpose_values[position[columns[k]]] = values[k];
+        position[columns[k]]++;
+    }
+    if (solveIterative(column_offsets, transpose_rows, transpose_values, exit_rates, distribution)) return distribution;
+
+    /* The sweeps converge very slowly on nearly decomposable chains, on
+     * which GTH elimination is still exact. */
+    if (size > mDirectSizeLimit)
+    {
+        fillDenseMatrix(rows, columns, values, size, dense_matrix);
+        if (solveDirect(dense_matrix, size, distribution)) return distribution;
+    }
+    EXCEPTION("The stationary distribution did not converge within the maximum number of iterations.");
+}
+
+bool StationaryDistributionSolver::solveDirect(std::vector<double>& rMatrix, unsigned size,
+        std::vector<double>& rDistribution)
+{
+    /* State n is censored out of the chain, from the last one. The
+     * diagonal is never used: the rate of leaving state n is the sum of
+     * its entries towards the states left. */
+    for (unsigned n=size-1; n>0; n--)
+    {
+        double* p_row_n = &rMatrix[n * size];
+        double exit_rate = 0.0;
+        for (unsigned j=0; j<n; j++)
+        {
+            exit_rate += p_row_n[j];
+        }
+        if (exit_rate <= 0.0) return false;
+        for (unsigned i=0; i<n; i++)
+        {
+            double* p_row_i = &rMatrix[i * size];
+            double factor = p_row_i[n] / exit_rate;
+            p_row_i[n] = factor;
+            if (factor == 0.0) continue;
+            for (unsigned j=0; j<n; j++)
+            {
+                p_row_i[j] += factor * p_row_n[j];
+            }
+        }
+    }
+
+    rDistribution.assign(size, 0.0);
+    rDistribution[0] = 1.0;
+    double sum = 1.0;
+    for (unsigned n=1; n<size; n++)
+    {
+        double value = 0.0;
+        for (unsigned i=0; i<n; i++)
+        {
+            value += rDistribution[i] * rMatrix[i * size + n];
+        }
+        rDistribution[n] = value;
+        sum += value;
+    }
+    for (unsigned n=0; n<size; n++)
+    {
+        rDistribution[n] /= sum;
+    }
+    return true;
+}
+
+bool StationaryDistributionSolver::solveIterative(const std::vector<unsigned>& rColumnOffsets,
+        const std::vector<unsigned>& rRows, const std::vector<double>& rValues,
+        const std::vector<double>& rExitRates, std::vector<double>& rDistribution) const
+{
+    /* pi_j * (sum of the exits of j) = sum over i != j of pi_i * p_ij */
+    unsigned size = rExitRates.size();
+    rDistribution.assign(size, 1.0 / size);
+    for (unsigned iteration=0; iteration<mMaxIterations; iteration++)
+    {
+        double sum = 0.0;
+        for (unsigned j=0; j<size; j++)
+        {
+            if (rExitRates[j] > 0.0)
+            {
+                double inflow = 0.0;
+                for (unsigned k=rColumnOffsets[j]; k<rColumnOffsets[j+1]; k++)
+                {
+                    inflow += rDistribution[rRows[k]] * rValues[k];
+                }
+                rDistribution[j] = inflow / rExitRates[j];
+            }
+            sum += rDistribution[j];
+        }
+        for (unsigned j=0; j<size; j++)
+        {
+            rDistribution[j] /= sum;
+        }
+
+        /* The change between sweeps can be tiny far from the solution if
+         * the chain mixes slowly, so the sweeps stop on ||pi P - pi||. */
+        double residual = 0.0;
+        for (unsigned j=0; j<size; j++)
+        {
+            double inflow = 0.0;
+            for (unsigned k=rColumnOffsets[j]; k<rColumnOffsets[j+1]; k++)
+            {
+                inflow += rDistribution[rRows[k]] * rValues[k];
+            }
+            residual += std::fabs(inflow - rDistribution[j] * rExitRates[j]);
+        }
+        if (residual < mTolerance) return true;
+    }
+    return false;
+}
+
+unsigned StationaryDistributionSolver::getDirectSizeLimit() const
+{
+    return mDirectSizeLimit;
+}
@@ -0,0 +1,89 @@
+#ifndef STATIONARYDISTRIBUTIONSOLVER_HPP_
+#define STATIONARYDISTRIBUTIONSOLVER_HPP_
+
+#include "StochasticMatrix.hpp"
+#include "Exception.hpp"
+#include <vector>
+
+/**
+ * The stationary distribution of the chain restricted to a component of
+ * a pruned ATN (a StochasticMatrixView), without PETSc.
+ *
+ * Components up to a size limit are solved by Grassmann-Taksar-Heyman
+ * elimination on a dense copy: it uses no subtractions, so it is
+ * accurate for stochastic matrices whatever their conditioning. Larger
+ * components are solved by Gauss-Seidel sweeps on the sparse transpose,
+ * or by GTH elimination as well if the sweeps do not converge, as on
+ * nearly decomposable chains.
+ * The entries leaving the component are ignored, i.e. every row is
+ * renormalised on the component.
+ *
+ * The solver has no state besides its parameters, so one object can be
+ * used by many threads at the same time.
+ */
+class StationaryDistributionSolver
+{
+private:
+
+    /** The largest component solved by GTH elimination */
+    unsigned mDirectSizeLimit;
+
+    /** The Gauss-Seidel sweeps stop when the L1 norm of pi P - pi is below this */
+    double mTolerance;
+
+    /** The maximum number of Gauss-Seidel sweeps */
+    unsigned mMaxIterations;
+
+    /**
+     * GTH elimination.
+     *
+     * @param rMatrix the dense row-major matrix of the component (it is overwritten)
+     * @param size the size of the component
+     * @param rDistribution filled with the stationary distribution
+     *
+     * @return false if the chain is reducible and the elimination stopped.
+     */
+    static bool solveDirect(std::vector<double>& rMatrix, unsigned size, std::vector<double>& rDistribution);
+
+    /**
+     * Gauss-Seidel sweeps from the uniform distribution.
+     *
+     * @param rColumnOffsets the offsets of the columns of the transpose (size + 1)
+     * @param rRows the row of every off-diagonal entry, by column
+     * @param rValues the value of every off-diagonal entry, by column
+     * @param rExitRates the sum of the off-diagonal entries of every row
+     * @param rDistribution filled with the stationary distribution
+     *
+     * @return false if the sweeps did not converge within mMaxIterations.
+     */
+    bool solveIterative(const std::vector<unsigned>& rColumnOffsets, const std::vector<unsigned>& rRows,
+            const std::vector<double>& rValues, const std::vector<double>& rExitRates,
+            std::vector<double>& rDistribution) const;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param direct_size_limit the largest component solved by GTH elimination
+     * @param tolerance the tolerance of the Gauss-Seidel sweeps
+     * @param max_iterations the maximum number of Gauss-Seidel sweeps
+     */
+    StationaryDistributionSolver(unsigned direct_size_limit = 256, double tolerance = 1e-13,
+            unsigned max_iterations = 100000);
+
+    /**
+     * @param rMatrix the pruned matrix
+     * @param rComponent the states of the component, in ascending order
+     *
+     * @return the stationary distribution, in the order of rComponent.
+     */
+    std::vector<double> solve(const StochasticMatrixView& rMatrix, const std::vector<unsigned>& rComponent) const;
+
+    /**
+     * @return the largest component solved by GTH elimination.
+     */
+    unsigned getDirectSizeLimit() const;
+};
+
+#endif /* STATIONARYDISTRIBUTIONSOLVER_HPP_ */
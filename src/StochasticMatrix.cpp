@@ -0,0 +1,181 @@
+#include "StochasticMatrix.hpp"
+#include <cassert>
+#include <cstddef>
+
+StochasticMatrix::StochasticMatrix() :
+mSize(0),
+mRowOffsets(1, 0)
+{
+}
+
+StochasticMatrix::StochasticMatrix(const std::vector<std::map<unsigned,double> >& rMatrix) :
+mSize(rMatrix.size())
+{
+    unsigned entries_number = 0;
+    for (unsigned row=0; row<mSize; row++)
+    {
+        entries_number += rMatrix[row].size();
+    }
+    mRowOffsets.reserve(mSize + 1);
+    mColumns.reserve(entries_number);
+    mValues.reserve(entries_number);
+    mRowOffsets.push_back(0);
+    for (unsigned row=0; row<mSize; row++)
+    {
+        std::map<unsigned,double>::const_iterator iterator;
+        for (iterator=rMatrix[row].begin(); iterator!=rMatrix[row].end(); ++iterator)
+        {
+            assert(iterator->first < mSize);
+            mColumns.push_back(iterator->first);
+            mValues.push_back(iterator->second);
+        }
+        mRowOffsets.push_back(mColumns.size());
+    }
+}
+
+StochasticMatrix::StochasticMatrix(unsigned size, std::vector<unsigned>& rRowOffsets,
+        std::vector<unsigned>& rColumns, std::vector<double>& rValues) :
+mSize(size)
+{
+    assert(rRowOffsets.size() == size + 1);
+    assert(rColumns.size() == rRowOffsets.back() && rValues.size() == rColumns.size());
+    mRowOffsets.swap(rRowOffsets);
+    mColumns.swap(rColumns);
+    mValues.swap(rValues);
+}
+
+void StochasticMatrix::swap(StochasticMatrix& rOther)
+{
+    std::swap(mSize, rOther.mSize);
+    mRowOffsets.swap(rOther.mRowOffsets);
+    mColumns.swap(rOther.mColumns);
+    mValues.swap(rOther.mValues);
+}
+
+unsigned StochasticMatrix::getSize() const
+{
+    return mSize;
+}
+
+unsigned StochasticMatrix::getNonZerosNumber() const
+{
+    return mColumns.size();
+}
+
+const unsigned* StochasticMatrix::getRowOffsets() const
+{
+    return &mRowOffsets[0];
+}
+
+const unsigned* StochasticMatrix::getColumns() const
+{
+    return mColumns.empty() ? NULL : &mColumns[0];
+}
+
+const double* StochasticMatrix::getValues() const
+{
+    return mValues.empty() ? NULL : &mValues[0];
+}
+
+std::vector<std::map<unsigned,double> > StochasticMatrix::getMapMatrix() const
+{
+    std::vector<std::map<unsigned,double> > matrix(mSize);
+    for (unsigned row=0; row<mSize; row++)
+    {
+        for (unsigned entry=mRowOffsets[row]; entry<mRowOffsets[row+1]; entry++)
+        {
+            matrix[row].insert(matrix[row].end(), std::pair<unsigned,double>(mColumns[entry], mValues[entry]));
+        }
+    }
+    return matrix;
+}
+
+StochasticMatrixView::StochasticMatrixView(const StochasticMatrix& rMatrix) :
+mpMatrix(&rMatrix),
+mThreshold(-1.0),
+mRowSums(rMatrix.getSize(), 1.0)
+{
+}
+
+StochasticMatrixView::StochasticMatrixView(const StochasticMatrix& rMatrix, double threshold) :
+mpMatrix(&rMatrix),
+mThreshold(threshold),
+mRowSums(rMatrix.getSize(), 0.0)
+{
+    /* The masking is branch free, so the loop over a row can be vectorised;
+     * the entries are added in order of column. */
+    const unsigned* p_row_offsets = rMatrix.getRowOffsets();
+    const double* p_values = rMatrix.getValues();
+    for (unsigned row=0; row<rMatrix.getSize(); row++)
+    {
+        double row_sum = 0.0;
+        for (unsigned entry=p_row_offsets[row]; entry<p_row_offsets[row+1]; entry++)
+        {
+            row_sum += (p_values[entry] > threshold) ? p_values[entry] : 0.0;
+        }
+        /* An empty row is left as it is. */
+        mRowSums[row] = (row_sum != 0.0) ? row_sum : 1.0;
+    }
+}
+
+const StochasticMatrix& StochasticMatrixView::getMatrix() const
+{
+    return *mpMatrix;
+}
+
+double StochasticMatrixView::getThreshold() const
+{
+    return mThreshold;
+}
+
+unsigned StochasticMatrixView::getSize() const
+{
+    return mpMatrix->getSize();
+}
+
+void StochasticMatrixView::getRowValues(unsigned row, double* p_values) const
+{
+    const unsigned* p_row_offsets = mpMatrix->getRowOffsets();
+    unsigned length = p_row_offsets[row+1] - p_row_offsets[row];
+    if (length == 0) return;
+    const double* p_matrix_values = mpMatrix->getValues() + p_row_offsets[row];
+    double row_sum = mRowSums[row];
+    double threshold = mThreshold;
+    for (unsigned i=0; i<length; i++)
+    {
+        p_values[i] = (p_matrix_values[i] > threshold) ? p_matrix_values[i] / row_sum : 0.0;
+    }
+}
+
+bool StochasticMatrixView::hasEmptyRow() const
+{
+    const unsigned* p_row_offsets = mpMatrix->getRowOffsets();
+    for (unsigned row=0; row<mpMatrix->getSize(); row++)
+    {
+        bool empty = true;
+        for (unsigned entry=p_row_offsets[row]; entry<p_row_offsets[row+1] && empty; entry++)
+        {
+            empty = !isKept(entry);
+        }
+        if (empty) return true;
+    }
+    return false;
+}
+
+std::vector<std::map<unsigned,double> > StochasticMatrixView::getMapMatrix() const
+{
+    std::vector<std::map<unsigned,double> > matrix(mpMatrix->getSize());
+    const unsigned* p_row_offsets = mpMatrix->getRowOffsets();
+    const unsigned* p_columns = mpMatrix->getColumns();
+    for (unsigned row=0; row<mpMatrix->getSize(); row++)
+    {
+        for (unsigned entry=p_row_offsets[row]; entry<p_row_offsets[row+1]; entry++)
+        {
+            if (isKept(entry))
+            {
+                matrix[row].insert(matrix[row].end(), std::pair<unsigned,double>(p_columns[entry], getValue(row, entry)));
+            }
+        }
+    }
+    return matrix;
+}
@@ -0,0 +1,190 @@
+#ifndef STOCHASTICMATRIX_HPP_
+#define STOCHASTICMATRIX_HPP_
+
+#include <vector>
+#include <map>
+#include <boost/utility.hpp>
+
+/**
+ * An immutable square sparse matrix in compressed sparse row (CSR) form,
+ * used for the ATN: the entries of row i are at the positions
+ * getRowOffsets()[i] ... getRowOffsets()[i+1]-1 of getColumns() and
+ * getValues(), in ascending order of column.
+ *
+ * The matrix cannot be copied: its arrays are passed with swap(), and the
+ * pruned matrices are StochasticMatrixView objects on it.
+ */
+class StochasticMatrix : private boost::noncopyable
+{
+private:
+
+    /** The number of rows (and columns) */
+    unsigned mSize;
+
+    /** The offsets of the rows (mSize + 1) */
+    std::vector<unsigned> mRowOffsets;
+
+    /** The column of every entry */
+    std::vector<unsigned> mColumns;
+
+    /** The value of every entry */
+    std::vector<double> mValues;
+
+public:
+
+    /**
+     * Constructor 1: an empty matrix.
+     */
+    StochasticMatrix();
+
+    /**
+     * Constructor 2: the matrix of a map in every row, as given by
+     * RandomBooleanNetwork::getAttractorMatrix().
+     *
+     * @param rMatrix the rows of the matrix
+     */
+    StochasticMatrix(const std::vector<std::map<unsigned,double> >& rMatrix);
+
+    /**
+     * Constructor 3: the matrix takes the CSR arrays, which are left empty.
+     *
+     * @param size the number of rows
+     * @param rRowOffsets the size + 1 offsets of the rows
+     * @param rColumns the column of every entry (ascending in every row)
+     * @param rValues the value of every entry
+     */
+    StochasticMatrix(unsigned size, std::vector<unsigned>& rRowOffsets, std::vector<unsigned>& rColumns,
+            std::vector<double>& rValues);
+
+    /**
+     * Exchange the contents of two matrices.
+     *
+     * @param rOther the other matrix
+     */
+    void swap(StochasticMatrix& rOther);
+
+    /**
+     * @return the number of rows (and columns).
+     */
+    unsigned getSize() const;
+
+    /**
+     * @return the number of entries.
+     */
+    unsigned getNonZerosNumber() const;
+
+    /**
+     * @return the getSize() + 1 offsets of the rows.
+     */
+    const unsigned* getRowOffsets() const;
+
+    /**
+     * @return the column of every entry (NULL if there are none).
+     */
+    const unsigned* getColumns() const;
+
+    /**
+     * @return the value of every entry (NULL if there are none).
+     */
+    const double* getValues() const;
+
+    /**
+     * @return the matrix as a map in every row.
+     */
+    std::vector<std::map<unsigned,double> > getMapMatrix() const;
+};
+
+/**
+ * The pruned matrix of a StochasticMatrix at a threshold: only the
+ * entries greater than the threshold are kept, and every row is
+ * normalised by the sum of its kept entries. Nothing is copied but the
+ * row sums, so the matrix must live as long as the view.
+ */
+class StochasticMatrixView
+{
+private:
+
+    /** The matrix */
+    const StochasticMatrix* mpMatrix;
+
+    /** The entries <= mThreshold are pruned */
+    double mThreshold;
+
+    /** The sum of the kept entries of every row (1 if the view is not normalised) */
+    std::vector<double> mRowSums;
+
+public:
+
+    /**
+     * Constructor 1: the matrix as it is (no entry is pruned, the rows
+     * are not normalised).
+     *
+     * @param rMatrix the matrix
+     */
+    StochasticMatrixView(const StochasticMatrix& rMatrix);
+
+    /**
+     * Constructor 2: the pruned and normalised matrix.
+     *
+     * @param rMatrix the matrix
+     * @param threshold the entries <= threshold are pruned
+     */
+    StochasticMatrixView(const StochasticMatrix& rMatrix, double threshold);
+
+    /**
+     * @return the matrix.
+     */
+    const StochasticMatrix& getMatrix() const;
+
+    /**
+     * @return the threshold.
+     */
+    double getThreshold() const;
+
+    /**
+     * @return the number of rows (and columns).
+     */
+    unsigned getSize() const;
+
+    /**
+     * @param entry the position of the entry in the matrix
+     *
+     * @return true if the entry is kept.
+     */
+    bool isKept(unsigned entry) const
+    {
+        return mpMatrix->getValues()[entry] > mThreshold;
+    }
+
+    /**
+     * @param row the row of the entry
+     * @param entry the position of the entry in the matrix
+     *
+     * @return the normalised value of the entry, or 0 if it is pruned.
+     */
+    double getValue(unsigned row, unsigned entry) const
+    {
+        return isKept(entry) ? mpMatrix->getValues()[entry] / mRowSums[row] : 0.0;
+    }
+
+    /**
+     * Write the normalised values of the entries of a row, 0 for the
+     * pruned ones.
+     *
+     * @param row the row
+     * @param p_values the output, one value for every entry of the row
+     */
+    void getRowValues(unsigned row, double* p_values) const;
+
+    /**
+     * @return true if a row has no kept entries.
+     */
+    bool hasEmptyRow() const;
+
+    /**
+     * @return the pruned and normalised matrix as a map in every row.
+     */
+    std::vector<std::map<unsigned,double> > getMapMatrix() const;
+};
+
+#endif /* STOCHASTICMATRIX_HPP_ */
@@ -0,0 +1,148 @@
+#include "StronglyConnectedComponents.hpp"
+#include <cassert>
+
+StronglyConnectedComponents::StronglyConnectedComponents(unsigned nodes_number, const unsigned* p_row_offsets,
+        const unsigned* p_columns, const double* p_weights, double threshold) :
+mComponents(nodes_number, 0),
+mComponentsNumber(0)
+{
+    /* Pearce's algorithm: rindex is 0 for the nodes not visited, the visit
+     * index for the nodes on the stacks and, once a component is closed,
+     * nodes_number - 1 - its id, which is greater than any visit index. The
+     * recursion is replaced by an explicit stack of (node, next edge). */
+    std::vector<unsigned>& rindex = mComponents;
+    std::vector<bool> is_root(nodes_number, false);
+    std::vector<unsigned> stack;
+    std::vector<std::pair<unsigned,unsigned> > call_stack;
+    unsigned index = 1;
+    unsigned component = nodes_number - 1;
+
+    for (unsigned root=0; root<nodes_number; root++)
+    {
+        if (rindex[root] != 0) continue;
+        rindex[root] = index++;
+        is_root[root] = true;
+        call_stack.push_back(std::pair<unsigned,unsigned>(root, p_row_offsets[root]));
+        while (!call_stack.empty())
+        {
+            unsigned node = call_stack.back().first;
+            unsigned edge = call_stack.back().second;
+            if (edge < p_row_offsets[node+1])
+            {
+                call_stack.back().second++;
+                if (p_weights != NULL && !(p_weights[edge] > threshold)) continue;
+                unsigned target = p_columns[edge];
+                assert(target < nodes_number);
+                if (rindex[target] == 0)
+                {
+                    rindex[target] = index++;
+                    is_root[target] = true;
+                    call_stack.push_back(std::pair<unsigned,unsigned>(target, p_row_offsets[target]));
+                }
+                else if (rindex[target] < rindex[node])
+                {
+                    rindex[node] = rindex[target];
+                    is_root[node] = false;
+                }
+            }
+            else
+            {
+                call_stack.pop_back();
+                if (is_root[node])
+                {
+                    index--;
+                    while (!stack.empty() && rindex[node] <= rindex[stack.back()])
+                    {
+                        rindex[stack.back()] = component;
+                        stack.pop_back();
+                        index--;
+                    }
+                    rindex[node] = component;
+                    component--;
+                    mComponentsNumber++;
+                }
+                else
+                {
+                    stack.push_back(node);
+                }
+                if (!call_stack.empty() && rindex[node] < rindex[call_stack.back().first])
+                {
+                    rindex[call_stack.back().first] = rindex[node];
+                    is_root[call_stack.back().first] = false;
+                }
+            }
+        }
+    }
+
+    for (unsigned node=0; node<nodes_number; node++)
+    {
+        mComponents[node] = nodes_number - 1 - rindex[node];
+    }
+
+    mTerminal.assign(mComponentsNumber, true);
+    for (unsigned node=0; node<nodes_number; node++)
+    {
+        for (unsigned edge=p_row_offsets[node]; edge<p_row_offsets[node+1]; edge++)
+        {
+            if (p_weights != NULL && !(p_weights[edge] > threshold)) continue;
+            if (mComponents[p_columns[edge]] != mComponents[node])
+            {
+                mTerminal[mComponents[node]] = false;
+            }
+        }
+    }
+}
+
+unsigned StronglyConnectedComponents::getComponentsNumber() const
+{
+    return mComponentsNumber;
+}
+
+const std::vector<unsigned>& StronglyConnectedComponents::getComponents() const
+{
+    return mComponents;
+}
+
+bool StronglyConnectedComponents::isTerminal(unsigned component) const
+{
+    assert(component < mComponentsNumber);
+    return mTerminal[component];
+}
+
+unsigned StronglyConnectedComponents::getTerminalNodesNumber() const
+{
+    unsigned nodes_number = 0;
+    for (unsigned node=0; node<mComponents.size(); node++)
+    {
+        if (mTerminal[mComponents[node]]) nodes_number++;
+    }
+    return nodes_number;
+}
+
+std::set<std::set<unsigned> > StronglyConnectedComponents::getTerminalComponentSets() const
+{
+    std::vector<std::set<unsigned> > components(mComponentsNumber);
+    for (unsigned node=0; node<mComponents.size(); node++)
+    {
+        if (mTerminal[mComponents[node]])
+        {
+            components[mComponents[node]].insert(components[mComponents[node]].end(), node);
+        }
+    }
+    std::set<std::set<unsigned> > terminal_components;
+    for (unsigned c=0; c<mComponentsNumber; c++)
+    {
+        if (mTerminal[c]) terminal_components.insert(components[c]);
+    }
+    return terminal_components;
+}
+
+std::set<std::set<unsigned> > StronglyConnectedComponents::getComponentSets() const
+{
+    std::vector<std::set<unsigned> > components(mComponentsNumber);
+    for (unsigned node=0; node<mComponents.size(); node++)
+    {
+        components[mComponents[node]].insert(components[mComponents[node]].end(), node);
+    }
+    return std::set<std::set<unsigned> >(components.begin(), components.end());
+}
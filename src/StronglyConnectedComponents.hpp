@@ -0,0 +1,83 @@
+#ifndef STRONGLYCONNECTEDCOMPONENTS_HPP_
+#define STRONGLYCONNECTEDCOMPONENTS_HPP_
+
+#include <vector>
+#include <set>
+#include <cstddef>
+
+/**
+ * The strongly connected components of a directed graph given in
+ * compressed sparse row (CSR) form: the edges leaving node i are
+ * p_columns[p_row_offsets[i]] ... p_columns[p_row_offsets[i+1]-1].
+ * The arrays are only read during the construction, never copied.
+ *
+ * The components are found by an iterative version of the Pearce's
+ * algorithm (one index array and one bit per node, no recursion, so it
+ * does not overflow the stack on large ATNs). They are numbered in the
+ * order they are closed: if an edge goes from a node of component a to a
+ * node of component b, then a >= b. So the first component is terminal.
+ *
+ * If an array of weights is given, only the edges with weight greater
+ * than the threshold are visited (the graph of the pruned matrix).
+ */
+class StronglyConnectedComponents
+{
+private:
+
+    /** The component of every node */
+    std::vector<unsigned> mComponents;
+
+    /** The number of components */
+    unsigned mComponentsNumber;
+
+    /** Whether no edge leaves every component */
+    std::vector<bool> mTerminal;
+
+public:
+
+    /**
+     * Constructor: it finds the components.
+     *
+     * @param nodes_number the number of nodes
+     * @param p_row_offsets the nodes_number + 1 offsets of the rows
+     * @param p_columns the target of every edge
+     * @param p_weights the weight of every edge, or NULL to visit all the edges
+     * @param threshold the edges with weight <= threshold are not visited
+     */
+    StronglyConnectedComponents(unsigned nodes_number, const unsigned* p_row_offsets, const unsigned* p_columns,
+            const double* p_weights = NULL, double threshold = 0.0);
+
+    /**
+     * @return the number of components.
+     */
+    unsigned getComponentsNumber() const;
+
+    /**
+     * @return the component of every node.
+     */
+    const std::vector<unsigned>& getComponents() const;
+
+    /**
+     * @param component the component id
+     *
+     * @return true if no edge leaves the component.
+     */
+    bool isTerminal(unsigned component) const;
+
+    /**
+     * @return the number of nodes which belong to terminal components.
+     */
+    unsigned getTerminalNodesNumber() const;
+
+    /**
+     * @return the nodes of every terminal component.
+     */
+    std::set<std::set<unsigned> > getTerminalComponentSets() const;
+
+    /**
+     * @return the nodes of every component.
+     */
+    std::set<std::set<unsigned> > getComponentSets() const;
+};
+
+#endif /* STRONGLYCONNECTEDCOMPONENTS_HPP_ */
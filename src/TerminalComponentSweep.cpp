@@ -0,0 +1,238 @@
+#include "TerminalComponentSweep.hpp"
+#include "StronglyConnectedComponents.hpp"
+#include <algorithm>
+#include <cassert>
+
+/**
+ * Order of the edges: ascending weight, then ascending position.
+ */
+class EdgeWeightComparator
+{
+private:
+
+    /** The weight of every edge */
+    const double* mpWeights;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param p_weights the weight of every edge
+     */
+    EdgeWeightComparator(const double* p_weights) : mpWeights(p_weights)
+    {
+    }
+
+    /**
+     * @param a an edge
+     * @param b an edge
+     *
+     * @return true if a comes before b.
+     */
+    bool operator()(unsigned a, unsigned b) const
+    {
+        return mpWeights[a] < mpWeights[b] || (mpWeights[a] == mpWeights[b] && a < b);
+    }
+};
+
+TerminalComponentSweep::TerminalComponentSweep(unsigned nodes_number, const unsigned* p_row_offsets,
+        const unsigned* p_columns, const double* p_weights) :
+mNodesNumber(nodes_number),
+mpRowOffsets(p_row_offsets),
+mpColumns(p_columns),
+mpWeights(p_weights),
+mNextEdge(0),
+mEmptyRowsNumber(0),
+mTerminalComponentsNumber(0),
+mTerminalNodesNumber(0),
+mTerminalChangesNumber(0),
+mLocalIndex(nodes_number, 0)
+{
+    unsigned edges_number = p_row_offsets[nodes_number];
+    mSources.resize(edges_number);
+    mEdgeOrder.resize(edges_number);
+    mNodeEdgesNumber.resize(nodes_number);
+    for (unsigned node=0; node<nodes_number; node++)
+    {
+        mNodeEdgesNumber[node] = p_row_offsets[node+1] - p_row_offsets[node];
+        if (mNodeEdgesNumber[node] == 0) mEmptyRowsNumber++;
+        for (unsigned edge=p_row_offsets[node]; edge<p_row_offsets[node+1]; edge++)
+        {
+            mSources[edge] = node;
+            mEdgeOrder[edge] = edge;
+        }
+    }
+    std::sort(mEdgeOrder.begin(), mEdgeOrder.end(), EdgeWeightComparator(p_weights));
+    mPresent.assign(edges_number, true);
+
+    StronglyConnectedComponents components(nodes_number, p_row_offsets, p_columns);
+    mComponents = components.getComponents();
+    mComponentNodes.resize(components.getComponentsNumber());
+    mLeavingEdgesNumber.assign(components.getComponentsNumber(), 0);
+    for (unsigned node=0; node<nodes_number; node++)
+    {
+        mComponentNodes[mComponents[node]].push_back(node);
+        for (unsigned edge=p_row_offsets[node]; edge<p_row_offsets[node+1]; edge++)
+        {
+            if (mComponents[p_columns[edge]] != mComponents[node]) mLeavingEdgesNumber[mComponents[node]]++;
+        }
+    }
+    for (unsigned c=0; c<mComponentNodes.size(); c++)
+    {
+        if (mLeavingEdgesNumber[c] == 0)
+        {
+            mTerminalComponentsNumber++;
+            mTerminalNodesNumber += mComponentNodes[c].size();
+        }
+    }
+}
+
+unsigned TerminalComponentSweep::removeEdges(double threshold)
+{
+    std::vector<unsigned> split_components;
+    std::vector<bool> to_split(mComponentNodes.size(), false);
+    unsigned removed_edges = 0;
+    for (; mNextEdge<mEdgeOrder.size() && mpWeights[mEdgeOrder[mNextEdge]] <= threshold; mNextEdge++)
+    {
+        unsigned edge = mEdgeOrder[mNextEdge];
+        unsigned source_component = mComponents[mSources[edge]];
+        mPresent[edge] = false;
+        removed_edges++;
+        if (--mNodeEdgesNumber[mSources[edge]] == 0) mEmptyRowsNumber++;
+        if (mComponents[mpColumns[edge]] != source_component)
+        {
+            if (--mLeavingEdgesNumber[source_component] == 0)
+            {
+                mTerminalChangesNumber++;
+                mTerminalComponentsNumber++;
+                mTerminalNodesNumber += mComponentNodes[source_component].size();
+            }
+        }
+        else if (!to_split[source_component] && mComponentNodes[source_component].size() > 1)
+        {
+            to_split[source_component] = true;
+            split_components.push_back(source_component);
+        }
+    }
+    for (unsigned i=0; i<split_components.size(); i++)
+    {
+        splitComponent(split_components[i]);
+    }
+    return removed_edges;
+}
+
+void TerminalComponentSweep::splitComponent(unsigned component)
+{
+    /* The graph induced by the component, with local node ids. */
+    std::vector<unsigned> nodes(mComponentNodes[component]);
+    for (unsigned i=0; i<nodes.size(); i++)
+    {
+        mLocalIndex[nodes[i]] = i;
+    }
+    std::vector<unsigned> row_offsets(1, 0);
+    std::vector<unsigned> columns;
+    for (unsigned i=0; i<nodes.size(); i++)
+    {
+        for (unsigned edge=mpRowOffsets[nodes[i]]; edge<mpRowOffsets[nodes[i]+1]; edge++)
+        {
+            if (mPresent[edge] && mComponents[mpColumns[edge]] == component)
+            {
+                columns.push_back(mLocalIndex[mpColumns[edge]]);
+            }
+        }
+        row_offsets.push_back(columns.size());
+    }
+    StronglyConnectedComponents parts(nodes.size(), &row_offsets[0], columns.empty() ? NULL : &columns[0]);
+    if (parts.getComponentsNumber() == 1) return;
+
+    bool terminal_change = mLeavingEdgesNumber[component] == 0;
+    if (terminal_change)
+    {
+        mTerminalComponentsNumber--;
+        mTerminalNodesNumber -= nodes.size();
+    }
+
+    /* Part 0 keeps the id of the component. */
+    unsigned first_new_id = mComponentNodes.size();
+    mComponentNodes.resize(first_new_id + parts.getComponentsNumber() - 1);
+    mLeavingEdgesNumber.resize(mComponentNodes.size(), 0);
+    mComponentNodes[component].clear();
+    mLeavingEdgesNumber[component] = 0;
+    for (unsigned i=0; i<nodes.size(); i++)
+    {
+        unsigned part = parts.getComponents()[i];
+        mComponents[nodes[i]] = (part == 0) ? component : first_new_id + part - 1;
+        mComponentNodes[mComponents[nodes[i]]].push_back(nodes[i]);
+    }
+    for (unsigned i=0; i<nodes.size(); i++)
+    {
+        for (unsigned edge=mpRowOffsets[nodes[i]]; edge<mpRowOffsets[nodes[i]+1]; edge++)
+        {
+            if (mPresent[edge] && mComponents[mpColumns[edge]] != mComponents[nodes[i]])
+            {
+                mLeavingEdgesNumber[mComponents[nodes[i]]]++;
+            }
+        }
+    }
+    for (unsigned part=0; part<parts.getComponentsNumber(); part++)
+    {
+        unsigned id = (part == 0) ? component : first_new_id + part - 1;
+        if (mLeavingEdgesNumber[id] == 0)
+        {
+            terminal_change = true;
+            mTerminalComponentsNumber++;
+            mTerminalNodesNumber += mComponentNodes[id].size();
+        }
+    }
+    if (terminal_change) mTerminalChangesNumber++;
+}
+
+bool TerminalComponentSweep::hasEmptyRow() const
+{
+    return mEmptyRowsNumber > 0;
+}
+
+unsigned TerminalComponentSweep::getComponentsNumber() const
+{
+    return mComponentNodes.size();
+}
+
+const std::vector<unsigned>& TerminalComponentSweep::getComponents() const
+{
+    return mComponents;
+}
+
+bool TerminalComponentSweep::isTerminal(unsigned component) const
+{
+    assert(component < mComponentNodes.size());
+    return mLeavingEdgesNumber[component] == 0;
+}
+
+unsigned TerminalComponentSweep::getTerminalComponentsNumber() const
+{
+    return mTerminalComponentsNumber;
+}
+
+unsigned TerminalComponentSweep::getTerminalNodesNumber() const
+{
+    return mTerminalNodesNumber;
+}
+
+unsigned TerminalComponentSweep::getTerminalChangesNumber() const
+{
+    return mTerminalChangesNumber;
+}
+
+std::set<std::set<unsigned> > TerminalComponentSweep::getTerminalComponentSets() const
+{
+    std::set<std::set<unsigned> > terminal_components;
+    for (unsigned c=0; c<mComponentNodes.size(); c++)
+    {
+        if (mLeavingEdgesNumber[c] == 0)
+        {
+            terminal_components.insert(std::set<unsigned>(mComponentNodes[c].begin(), mComponentNodes[c].end()));
+        }
+    }
+    return terminal_components;
+}
@@ -0,0 +1,157 @@
+#ifndef TERMINALCOMPONENTSWEEP_HPP_
+#define TERMINALCOMPONENTSWEEP_HPP_
+
+#include <vector>
+#include <set>
+
+/**
+ * The strongly connected components of a weighted graph in CSR form (as
+ * in StronglyConnectedComponents) while its edges are removed in
+ * ascending order of weight, i.e. the graphs of the pruned matrices at
+ * increasing thresholds.
+ *
+ * The edges are sorted once. Removing an edge between two components
+ * only updates the number of edges leaving the source component (so a
+ * component becomes terminal when its last one is removed); the
+ * components are searched again only inside the components which lost
+ * an internal edge, once per call to removeEdges().
+ *
+ * The arrays of the graph are not copied, so they must live as long as
+ * this object.
+ */
+class TerminalComponentSweep
+{
+private:
+
+    /** The number of nodes */
+    unsigned mNodesNumber;
+
+    /** The offsets of the rows of the graph */
+    const unsigned* mpRowOffsets;
+
+    /** The target of every edge */
+    const unsigned* mpColumns;
+
+    /** The weight of every edge */
+    const double* mpWeights;
+
+    /** The source of every edge */
+    std::vector<unsigned> mSources;
+
+    /** The edges in ascending order of weight */
+    std::vector<unsigned> mEdgeOrder;
+
+    /** The position in mEdgeOrder of the first edge not removed */
+    unsigned mNextEdge;
+
+    /** Whether every edge is still in the graph */
+    std::vector<bool> mPresent;
+
+    /** The number of edges leaving every node */
+    std::vector<unsigned> mNodeEdgesNumber;
+
+    /** The number of nodes without leaving edges */
+    unsigned mEmptyRowsNumber;
+
+    /** The component of every node */
+    std::vector<unsigned> mComponents;
+
+    /** The nodes of every component, in ascending order */
+    std::vector<std::vector<unsigned> > mComponentNodes;
+
+    /** The number of edges from every component to other components */
+    std::vector<unsigned> mLeavingEdgesNumber;
+
+    /** The number of terminal components */
+    unsigned mTerminalComponentsNumber;
+
+    /** The number of nodes in terminal components */
+    unsigned mTerminalNodesNumber;
+
+    /** The number of times the terminal components changed */
+    unsigned mTerminalChangesNumber;
+
+    /** The position of every node in its component (work space of splitComponent()) */
+    std::vector<unsigned> mLocalIndex;
+
+    /**
+     * Search the components again inside a component which lost some
+     * internal edges. The first part keeps the id, the others are
+     * appended.
+     *
+     * @param component the component id
+     */
+    void splitComponent(unsigned component);
+
+public:
+
+    /**
+     * Constructor: it finds the components of the whole graph.
+     *
+     * @param nodes_number the number of nodes
+     * @param p_row_offsets the nodes_number + 1 offsets of the rows
+     * @param p_columns the target of every edge
+     * @param p_weights the weight of every edge
+     */
+    TerminalComponentSweep(unsigned nodes_number, const unsigned* p_row_offsets, const unsigned* p_columns,
+            const double* p_weights);
+
+    /**
+     * Remove the edges with weight <= threshold (thresholds must be given
+     * in ascending order) and update the components.
+     *
+     * @param threshold the threshold
+     *
+     * @return the number of edges removed.
+     */
+    unsigned removeEdges(double threshold);
+
+    /**
+     * @return true if some node has no leaving edges.
+     */
+    bool hasEmptyRow() const;
+
+    /**
+     * @return the number of components.
+     */
+    unsigned getComponentsNumber() const;
+
+    /**
+     * @return the component of every node (ids are not in topological order).
+     */
+    const std::vector<unsigned>& getComponents() const;
+
+    /**
+     * @param component the component id
+     *
+     * @return true if no edge leaves the component.
+     */
+    bool isTerminal(unsigned component) const;
+
+    /**
+     * @return the number of terminal components.
+     */
+    unsigned getTerminalComponentsNumber() const;
+
+    /**
+     * @return the number of nodes which belong to terminal components.
+     */
+    unsigned getTerminalNodesNumber() const;
+
+    /**
+     * The terminal components change when a component becomes terminal
+     * or when a component split and it, or one of its parts, is
+     * terminal. Thresholds which leave this number as it is cannot change
+     * the TES.
+     *
+     * @return the number of times the terminal components changed.
+     */
+    unsigned getTerminalChangesNumber() const;
+
+    /**
+     * @return the nodes of every terminal component.
+     */
+    std::set<std::set<unsigned> > getTerminalComponentSets() const;
+};
+
+#endif /* TERMINALCOMPONENTSWEEP_HPP_ */
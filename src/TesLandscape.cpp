@@ -0,0 +1,131 @@
+#include "TesLandscape.hpp"
+#include "TerminalComponentSweep.hpp"
+#include "DenseTerminalComponentSweep.hpp"
+#include <algorithm>
+#include <cassert>
+
+TesLandscape::TesLandscape(const StochasticMatrix& rMatrix) :
+mSize(rMatrix.getSize())
+{
+    std::set<std::set<unsigned> > no_tes;
+    if (mSize == 0)
+    {
+        mIntervalStarts.push_back(0.0);
+        mTes.push_back(no_tes);
+        return;
+    }
+
+    if (DenseTerminalComponentSweep::isSuitable(rMatrix))
+    {
+        DenseTerminalComponentSweep sweep(rMatrix);
+        sweepThresholds(sweep, rMatrix);
+    }
+    else
+    {
+        TerminalComponentSweep sweep(mSize, rMatrix.getRowOffsets(), rMatrix.getColumns(), rMatrix.getValues());
+        sweepThresholds(sweep, rMatrix);
+    }
+}
+
+template<class SWEEP>
+void TesLandscape::sweepThresholds(SWEEP& sweep, const StochasticMatrix& rMatrix)
+{
+    std::set<std::set<unsigned> > no_tes;
+    const double* p_values = rMatrix.getValues();
+    std::set<double> thresholds(p_values, p_values + rMatrix.getNonZerosNumber());
+    double threshold = 0.0;
+    std::set<double>::iterator it = thresholds.begin();
+    bool empty_row = sweep.hasEmptyRow();
+    while (true)
+    {
+        /* A new interval starts only if the TES are not the same. */
+        const std::set<std::set<unsigned> >& r_tes = (!empty_row && sweep.getTerminalNodesNumber() == mSize) ?
+                sweep.getTerminalComponentSets() : no_tes;
+        if (mTes.empty() || r_tes != mTes.back())
+        {
+            mIntervalStarts.push_back(threshold);
+            mTes.push_back(r_tes);
+        }
+        if (empty_row || it == thresholds.end()) break;
+
+        /* The TES cannot change if the terminal components do not. */
+        unsigned terminal_changes = sweep.getTerminalChangesNumber();
+        do
+        {
+            threshold = *it;
+            ++it;
+            sweep.removeEdges(threshold);
+            empty_row = sweep.hasEmptyRow();
+        } while (!empty_row && it != thresholds.end() && sweep.getTerminalChangesNumber() == terminal_changes);
+    }
+}
+
+unsigned TesLandscape::getIntervalsNumber() const
+{
+    return mIntervalStarts.size();
+}
+
+double TesLandscape::getIntervalStart(unsigned interval) const
+{
+    assert(interval < mIntervalStarts.size());
+    return mIntervalStarts[interval];
+}
+
+const std::set<std::set<unsigned> >& TesLandscape::getTes(unsigned interval) const
+{
+    assert(interval < mTes.size());
+    return mTes[interval];
+}
+
+unsigned TesLandscape::findInterval(double threshold) const
+{
+    std::vector<double>::const_iterator position =
+            std::upper_bound(mIntervalStarts.begin(), mIntervalStarts.end(), threshold);
+    return position == mIntervalStarts.begin() ? 0 : (position - mIntervalStarts.begin()) - 1;
+}
+
+const std::set<std::set<unsigned> >& TesLandscape::getTesAt(double threshold) const
+{
+    return mTes[findInterval(threshold)];
+}
+
+void TesLandscape::printToCsvFile(std::string directory, std::string filename) const
+{
+    if (directory.empty())
+        EXCEPTION("Directory name not valid.");
+
+    if (filename.size() < 5 || filename.compare(filename.size()-4,4,".csv") != 0)
+        EXCEPTION("File path not valid. It must terminate with '.csv' extension.");
+
+    OutputFileHandler handler(directory,false);
+    out_stream p_file = handler.OpenOutputFile(filename);
+    p_file->precision(17);
+
+    *p_file << "threshold,tes_number";
+    for (unsigned i=0; i<mSize; i++)
+    {
+        *p_file << ",attractor" << i+1;
+    }
+    *p_file << "\n";
+    for (unsigned interval=0; interval<mIntervalStarts.size(); interval++)
+    {
+        std::vector<int> tes_of_attractor(mSize, -1);
+        int tes_id = 0;
+        for (std::set<std::set<unsigned> >::const_iterator tes_iterator = mTes[interval].begin();
+                tes_iterator != mTes[interval].end(); ++tes_iterator)
+        {
+            for (std::set<unsigned>::const_iterator state = tes_iterator->begin(); state != tes_iterator->end(); ++state)
+            {
+                tes_of_attractor[*state] = tes_id;
+            }
+            tes_id++;
+        }
+        *p_file << mIntervalStarts[interval] << "," << mTes[interval].size();
+        for (unsigned i=0; i<mSize; i++)
+        {
+            *p_file << "," << tes_of_attractor[i];
+        }
+        *p_file << "\n";
+    }
+    p_file->close();
+}
@@ -0,0 +1,101 @@
+#ifndef TESLANDSCAPE_HPP_
+#define TESLANDSCAPE_HPP_
+
+#include <vector>
+#include <set>
+#include <string>
+#include "StochasticMatrix.hpp"
+#include "OutputFileHandler.hpp"
+#include "Exception.hpp"
+
+/**
+ * The threshold ergodic sets (TES) of an ATN at every threshold, found
+ * in one sweep of the thresholds (see TerminalComponentSweep, and
+ * DenseTerminalComponentSweep for small and dense ATNs).
+ *
+ * The pruned matrix at threshold t keeps the entries > t, so the TES
+ * change only at the values of the matrix. The thresholds are split in
+ * intervals [start, next start) with the same TES; the first interval
+ * starts at 0 (nothing is pruned below the smallest value). There are no
+ * TES in an interval if some attractor is not in a terminal component,
+ * and from the first threshold which leaves a row of the matrix empty.
+ */
+class TesLandscape
+{
+private:
+
+    /** The number of attractors */
+    unsigned mSize;
+
+    /** The first threshold of every interval, in ascending order */
+    std::vector<double> mIntervalStarts;
+
+    /** The TES of every interval (empty if there are none) */
+    std::vector<std::set<std::set<unsigned> > > mTes;
+
+    /**
+     * Fill the intervals.
+     *
+     * @param sweep a TerminalComponentSweep or a DenseTerminalComponentSweep of the matrix
+     * @param rMatrix the stochastic matrix of the ATN
+     */
+    template<class SWEEP>
+    void sweepThresholds(SWEEP& sweep, const StochasticMatrix& rMatrix);
+
+public:
+
+    /**
+     * Constructor: it sweeps the thresholds of the matrix.
+     *
+     * @param rMatrix the stochastic matrix of the ATN
+     */
+    TesLandscape(const StochasticMatrix& rMatrix);
+
+    /**
+     * @return the number of intervals.
+     */
+    unsigned getIntervalsNumber() const;
+
+    /**
+     * @param interval the interval
+     *
+     * @return the first threshold of the interval.
+     */
+    double getIntervalStart(unsigned interval) const;
+
+    /**
+     * @param interval the interval
+     *
+     * @return the TES in the interval (empty if there are none).
+     */
+    const std::set<std::set<unsigned> >& getTes(unsigned interval) const;
+
+    /**
+     * Binary search of the interval of a threshold.
+     *
+     * @param threshold the threshold
+     *
+     * @return the interval which contains the threshold (0 if it is < 0).
+     */
+    unsigned findInterval(double threshold) const;
+
+    /**
+     * @param threshold the threshold
+     *
+     * @return the TES of the pruned matrix at the threshold (empty if there
+     * are none).
+     */
+    const std::set<std::set<unsigned> >& getTesAt(double threshold) const;
+
+    /**
+     * Save the landscape in a .csv file: a line for every interval with
+     * its first threshold, the number of TES and the TES of every
+     * attractor (-1 if there are none).
+     *
+     * @param directory the name of the subfolder of testoutput.
+     * @param filename the file name of the output file.
+     */
+    void printToCsvFile(std::string directory, std::string filename) const;
+};
+
+#endif /* TESLANDSCAPE_HPP_ */
@@ -1,40 +1,69 @@
 #include "ThresholdErgodicSetDifferentiationTree.hpp"
+#include "Instrumentation.hpp"
+#include "StronglyConnectedComponents.hpp"
+#include "TerminalComponentSweep.hpp"
+#include "DenseTerminalComponentSweep.hpp"
+#include "SparseAtnFile.hpp"
 #include <limits>
+#include <algorithm>
 #include <iostream>
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
 
 ThresholdErgodicSetDifferentiationTree::ThresholdErgodicSetDifferentiationTree(
-        std::vector<std::map<unsigned,double> > stochastic_matrix,
-        std::vector<unsigned> attractor_length) :
+        const std::vector<std::map<unsigned,double> >& stochastic_matrix,
+        const std::vector<unsigned>& attractor_length) :
 mStochasticMatrix(stochastic_matrix),
 mAttractorLength(attractor_length),
-mpBooleanNetwork(NULL)
+mpBooleanNetwork(NULL),
+mPrunedMatrixCache(mStochasticMatrix),
+mThresholdTolerance(0.0)
 {
     if (stochastic_matrix.size() != mAttractorLength.size())
         EXCEPTION("Rows (and columns) in stochastic matrix must be equal to the number of attractors");
 }
 
+ThresholdErgodicSetDifferentiationTree::ThresholdErgodicSetDifferentiationTree(
+        StochasticMatrix& rStochasticMatrix,
+        const std::vector<unsigned>& attractor_length) :
+mAttractorLength(attractor_length),
+mpBooleanNetwork(NULL),
+mPrunedMatrixCache(mStochasticMatrix),
+mThresholdTolerance(0.0)
+{
+    if (rStochasticMatrix.getSize() != mAttractorLength.size())
+        EXCEPTION("Rows (and columns) in stochastic matrix must be equal to the number of attractors");
+    mStochasticMatrix.swap(rStochasticMatrix);
+}
+
 ThresholdErgodicSetDifferentiationTree::ThresholdErgodicSetDifferentiationTree(unsigned nodes_number, unsigned avarage_input_number_per_node,
-            bool scale_free, double probability_canalyzing_function)
+            bool scale_free, double probability_canalyzing_function) :
+mPrunedMatrixCache(mStochasticMatrix),
+mThresholdTolerance(0.0)
 {
     mpBooleanNetwork = new RandomBooleanNetwork(nodes_number,avarage_input_number_per_node,
             scale_free,probability_canalyzing_function);
     mpBooleanNetwork->findAttractors();
-    mStochasticMatrix = mpBooleanNetwork->getAttractorMatrix();
+    StochasticMatrix stochastic_matrix(mpBooleanNetwork->getAttractorMatrix());
+    mStochasticMatrix.swap(stochastic_matrix);
     mAttractorLength = mpBooleanNetwork->getAttractorLength();
 }
 
-ThresholdErgodicSetDifferentiationTree::ThresholdErgodicSetDifferentiationTree(std::string file_path, double probability_canalyzing_function)
+ThresholdErgodicSetDifferentiationTree::ThresholdErgodicSetDifferentiationTree(std::string file_path, double probability_canalyzing_function) :
+mPrunedMatrixCache(mStochasticMatrix),
+mThresholdTolerance(0.0)
 {
 
     mpBooleanNetwork = new RandomBooleanNetwork(file_path, probability_canalyzing_function);
     mpBooleanNetwork->findAttractors();
-    mStochasticMatrix = mpBooleanNetwork->getAttractorMatrix();
+    StochasticMatrix stochastic_matrix(mpBooleanNetwork->getAttractorMatrix());
+    mStochasticMatrix.swap(stochastic_matrix);
     mAttractorLength = mpBooleanNetwork->getAttractorLength();
 }
 
-ThresholdErgodicSetDifferentiationTree::ThresholdErgodicSetDifferentiationTree(std::string file_path)
+ThresholdErgodicSetDifferentiationTree::ThresholdErgodicSetDifferentiationTree(std::string file_path) :
+mPrunedMatrixCache(mStochasticMatrix),
+mThresholdTolerance(0.0)
 {
 	if (file_path.size() > 4)
 	{
@@ -44,12 +73,15 @@ ThresholdErgodicSetDifferentiationTree::ThresholdErgodicSetDifferentiationTree(s
 			{
 				mpBooleanNetwork = new RandomBooleanNetwork(file_path);
 				mpBooleanNetwork->findAttractors();
-				mStochasticMatrix = mpBooleanNetwork->getAttractorMatrix();
+				StochasticMatrix stochastic_matrix(mpBooleanNetwork->getAttractorMatrix());
+				mStochasticMatrix.swap(stochastic_matrix);
 				mAttractorLength = mpBooleanNetwork->getAttractorLength();
 			}
 			else if (file_path.compare(file_path.size()-4,4,".dat") == 0)
 			{
-				std::vector<std::map<unsigned,double> > matrix;
+				std::vector<unsigned> row_offsets(1, 0);
+				std::vector<unsigned> columns;
+				std::vector<double> values;
 				std::vector<unsigned> attractor_length;
 
 			    std::vector<std::string> strs;
@@ -78,16 +110,16 @@ ThresholdErgodicSetDifferentiationTree::ThresholdErgodicSetDifferentiationTree(s
 								if (strs.size() != matrix_length) throw;
 							}
 							unsigned j=0;
-							std::map<unsigned,double> map;
-							matrix.push_back(map);
 							do {
 								value = boost::lexical_cast<double>(strs.at(j));
 								if (value != 0.0)
 								{
-									matrix.at(i).insert(std::pair<unsigned,double>(j,value));
+									columns.push_back(j);
+									values.push_back(value);
 								}
 								j++;
 							} while (j < matrix_length);
+							row_offsets.push_back(columns.size());
 							i++;
 						} while (i < matrix_length);
 					} else throw;
@@ -104,7 +136,8 @@ ThresholdErgodicSetDifferentiationTree::ThresholdErgodicSetDifferentiationTree(s
 						attractor_length.push_back(boost::lexical_cast<unsigned>(strs.at(j)));
 						j++;
 					} while (j < matrix_length);
-					mStochasticMatrix = matrix;
+					StochasticMatrix matrix(matrix_length, row_offsets, columns, values);
+					mStochasticMatrix.swap(matrix);
 					mAttractorLength = attractor_length;
 					mpBooleanNetwork = NULL;
 				} catch (const Exception&)
@@ -112,6 +145,12 @@ ThresholdErgodicSetDifferentiationTree::ThresholdErgodicSetDifferentiationTree(s
 					input_file.close();
 					throw;
 				}
+		} else if (file_path.compare(file_path.size()-4,4,".atn") == 0
+					||  file_path.compare(file_path.size()-4,4,"atnb") == 0)
+			{
+				mpBooleanNetwork = NULL;
+				SparseAtnFile::read(file_path, mStochasticMatrix, mAttractorLength);
+				if (mStochasticMatrix.getSize() == 0) EXCEPTION("The stochastic matrix is empty.");
 		} else EXCEPTION("File format is not correct.");
 		} catch (Exception& e)
 		{
@@ -126,26 +165,29 @@ ThresholdErgodicSetDifferentiationTree::~ThresholdErgodicSetDifferentiationTree(
     if (mpBooleanNetwork) delete mpBooleanNetwork;
 }
 
-DifferentiationTree* ThresholdErgodicSetDifferentiationTree::computeDifferentiationTree() const
+template<class SWEEP>
+DifferentiationTree* ThresholdErgodicSetDifferentiationTree::sweepThresholds(SWEEP& sweep) const
 {
     DifferentiationTree* differentiation_tree;
     unsigned step = 0;
     std::set<double> thresholds = getThresholdValues();
     unsigned number_of_previous_components = 0;
     double threshold = 0.0;
-    std::vector<std::map<unsigned,double> > current_stochastic_matrix(mStochasticMatrix);
     bool thresholds_ended = false;
     do
     {
-
-        std::set<std::set<unsigned> > terminal_sccs = getTerminalStronglyConnectedComponents(current_stochastic_matrix);
+        std::set<std::set<unsigned> > terminal_sccs;
         std::set<std::set<unsigned> >::iterator it_components;
 
-        bool isTes = isThresholdErgodicSet(current_stochastic_matrix, terminal_sccs);
+        bool isTes = sweep.getTerminalNodesNumber() == mStochasticMatrix.getSize();
+        if (isTes)
+        {
+            terminal_sccs = sweep.getTerminalComponentSets();
+        }
         if (step==0)
         {
 			std::set<unsigned> component_states;
-			for (unsigned i=0; i<mStochasticMatrix.size(); i++)
+			for (unsigned i=0; i<mStochasticMatrix.getSize(); i++)
 			{
 				component_states.insert(i);
 			}
@@ -185,297 +227,167 @@ DifferentiationTree* ThresholdErgodicSetDifferentiationTree::computeDifferentiat
 				number_of_previous_components = terminal_sccs.size();
 			}
 		}
-		if (thresholds.size()>0)
+		/* The TES and their number can change only if the terminal
+		 * components do, so the other thresholds are not evaluated. */
+		unsigned terminal_changes = sweep.getTerminalChangesNumber();
+		do
 		{
-			threshold = *thresholds.begin();
-			if (threshold != 1.0)
+			if (thresholds.empty() || *thresholds.begin() == 1.0)
 			{
-				thresholds.erase(thresholds.begin());
-				current_stochastic_matrix = getPrunedMatrix(threshold);
-				bool rows_equals_to_zero = false;
-				for (unsigned row=0; row< current_stochastic_matrix.size() && !rows_equals_to_zero; row++)
-				{
-					double row_sum = 0;
-					std::map<unsigned,double>::iterator iterator;
-					rows_equals_to_zero = current_stochastic_matrix.at(row).empty();
-					for (iterator=current_stochastic_matrix.at(row).begin(); iterator!=current_stochastic_matrix.at(row).end() && !rows_equals_to_zero; ++iterator)
-					{
-						row_sum += iterator->second;
-					}
-					if (row_sum < 0.99)
-					{
-						rows_equals_to_zero = true;
-					}
-				}
-				thresholds_ended = rows_equals_to_zero;
-			} else	thresholds_ended = true;
-		}
-		else
-		{
-			thresholds_ended = true;
-		}
+				thresholds_ended = true;
+				break;
+			}
+			threshold = *thresholds.begin();
+			thresholds.erase(thresholds.begin());
+			sweep.removeEdges(threshold);
+			thresholds_ended = sweep.hasEmptyRow();
+		} while (!thresholds_ended && sweep.getTerminalChangesNumber() == terminal_changes);
 		step++;
 	} while(!thresholds_ended);
-    assignProbabilitiesAndCellCycleLengths(differentiation_tree);
 	return differentiation_tree;
 }
 
-std::set<double> ThresholdErgodicSetDifferentiationTree::getThresholdValues() const
+DifferentiationTree* ThresholdErgodicSetDifferentiationTree::computeDifferentiationTree() const
 {
-    std::set<double> thresholds;
-    for (unsigned row=0; row< mStochasticMatrix.size(); row++)
+    ScopedPhase phase("computeDifferentiationTree");
+    DifferentiationTree* differentiation_tree;
+    /* The pruned matrices are not built: the edges are removed from the
+     * graph of the stochastic matrix in ascending order of weight.
+     * Normalisation does not change the graph, so a row of a pruned matrix
+     * sums to less than 1 only if it is empty. Small and dense ATNs are
+     * swept on a dense bit matrix, the others on the sparse graph, where
+     * the components are searched again only where an internal edge is
+     * gone. */
+    if (DenseTerminalComponentSweep::isSuitable(mStochasticMatrix))
     {
-        std::map<unsigned,double>::const_iterator iterator;
-        for (iterator=mStochasticMatrix.at(row).begin(); iterator!=mStochasticMatrix.at(row).end(); ++iterator)
-        {
-            thresholds.insert(iterator->second);
-        }
+        DenseTerminalComponentSweep sweep(mStochasticMatrix);
+        differentiation_tree = sweepThresholds(sweep);
     }
-    return thresholds;
-}
-
-std::vector<std::map<unsigned,double> > ThresholdErgodicSetDifferentiationTree::getPrunedMatrix(
-        double threshold) const
-{
-    std::vector<std::map<unsigned,double> > pruned_matrix;
-    for (unsigned row=0; row< mStochasticMatrix.size(); row++)
+    else
     {
-        std::map<unsigned,double> map;
-        pruned_matrix.push_back(map);
-        std::map<unsigned,double>::const_iterator iterator;
-        for (iterator=mStochasticMatrix.at(row).begin(); iterator!=mStochasticMatrix.at(row).end(); ++iterator)
-        {
-            if (iterator->second > threshold)
-            {
-                pruned_matrix.at(row).insert(std::pair<unsigned,double>(iterator->first,iterator->second));
-            }
-        }
+        TerminalComponentSweep sweep(mStochasticMatrix.getSize(), mStochasticMatrix.getRowOffsets(),
+                mStochasticMatrix.getColumns(), mStochasticMatrix.getValues());
+        differentiation_tree = sweepThresholds(sweep);
     }
-    normalizePrunedMatrix(pruned_matrix);
-    return pruned_matrix;
+    assignProbabilitiesAndCellCycleLengths(differentiation_tree);
+	return differentiation_tree;
 }
 
-void ThresholdErgodicSetDifferentiationTree::normalizePrunedMatrix(
-        std::vector<std::map<unsigned,double> > &matrix) const
+std::set<double> ThresholdErgodicSetDifferentiationTree::getThresholdValues() const
 {
-    for (unsigned row=0; row< matrix.size(); row++)
+    const double* p_values = mStochasticMatrix.getValues();
+    std::set<double> values(p_values, p_values + mStochasticMatrix.getNonZerosNumber());
+    if (mThresholdTolerance == 0.0) return values;
+
+    std::set<double> thresholds;
+    std::set<double>::iterator it = values.begin();
+    while (it != values.end())
     {
-        double row_sum = 0;
-        std::map<unsigned,double>::iterator iterator;
-        for (iterator=matrix.at(row).begin(); iterator!=matrix.at(row).end(); ++iterator)
-        {
-            row_sum += iterator->second;
-        }
-        if (row_sum != 0)
+        double group_start = *it;
+        double group_end = *it;
+        for (++it; it != values.end() && *it - group_start <= mThresholdTolerance; ++it)
         {
-        	for (iterator=matrix.at(row).begin(); iterator!=matrix.at(row).end(); ++iterator)
-            {
-                matrix.at(row).at(iterator->first) = iterator->second / row_sum;
-            }
+            group_end = *it;
         }
+        thresholds.insert(group_end);
     }
+    return thresholds;
 }
 
-std::set<std::set<unsigned> > ThresholdErgodicSetDifferentiationTree::getStronglyConnectedComponents(
-        std::vector<std::map<unsigned,double> > graph) const
+const StochasticMatrixView& ThresholdErgodicSetDifferentiationTree::getPrunedMatrix(double threshold) const
 {
-    unsigned number_of_nodes = graph.size();
-    unsigned time=0;
-    unsigned* lowlink = new unsigned[number_of_nodes];
-    bool* used = new bool[number_of_nodes];
-    for (unsigned i=0; i<number_of_nodes; i++)
-    {
-        used[i] = false;
-        lowlink[i] = 0;
-    }
-    std::vector<unsigned> stack;
-
-    std::set<std::set<unsigned> > components;
-    for (unsigned u=0; u<number_of_nodes; u++)
-    {
-        if (!used[u])
-        {
-            findComponentDepthFirstSearch(u, graph, lowlink,
-                                    used, stack, time, components);
-        }
-    }
-    delete[] used;
-    delete[] lowlink;
-
-    return components;
+    return mPrunedMatrixCache.getPrunedMatrix(threshold);
 }
 
-std::set<std::set<unsigned> > ThresholdErgodicSetDifferentiationTree::getTerminalStronglyConnectedComponents(
-        std::vector<std::map<unsigned,double> > graph) const
+std::set<std::set<unsigned> > ThresholdErgodicSetDifferentiationTree::getStronglyConnectedComponents(
+        const StochasticMatrixView& rMatrix) const
 {
-    unsigned number_of_nodes = graph.size();
-    unsigned time=0;
-    unsigned* lowlink = new unsigned[number_of_nodes];
-    bool* used = new bool[number_of_nodes];
-    for (unsigned i=0; i<number_of_nodes; i++)
-    {
-        used[i] = false;
-        lowlink[i] = 0;
-    }
-    std::vector<unsigned> stack;
-
-    std::set<std::set<unsigned> > components;
-    for (unsigned u=0; u<number_of_nodes; u++)
-    {
-        if (!used[u])
-        {
-            findComponentDepthFirstSearch(u, graph, lowlink,
-                                    used, stack, time, components);
-        }
-    }
-    delete[] used;
-    delete[] lowlink;
-
-    std::set<std::set<unsigned> >::iterator it_components;
-    std::set<unsigned>::iterator it_nodes;
-    for (it_components = components.begin(); it_components != components.end(); ++it_components)
-    {
-    	bool is_a_terminal_scc = true;
-
-    	for (it_nodes = it_components->begin(); it_nodes != it_components->end() && is_a_terminal_scc; ++it_nodes)
-		{
-    		std::map<unsigned,double> map = graph[*it_nodes];
-    		std::map<unsigned,double>::iterator it_map;
-
-    		for(it_map = map.begin();it_map!=map.end() && is_a_terminal_scc; ++it_map)
-    		{
-    			//each reachable node from a member of a terminal scc must be a member of the terminal scc
-    			if (it_components->find(it_map->first) == it_components->end())
-    			{
-    				is_a_terminal_scc = false;
-    			}
-    		}
-		}
-    	if (!is_a_terminal_scc)
-    	{
-    		components.erase(*it_components);
-    	}
-    }
-
-    return components;
+    const StochasticMatrix& r_matrix = rMatrix.getMatrix();
+    StronglyConnectedComponents components(r_matrix.getSize(), r_matrix.getRowOffsets(), r_matrix.getColumns(),
+            r_matrix.getValues(), rMatrix.getThreshold());
+    return components.getComponentSets();
 }
 
-void ThresholdErgodicSetDifferentiationTree::findComponentDepthFirstSearch(
-        unsigned u, std::vector<std::map<unsigned,double> > graph, unsigned* pLowlink,
-        bool* pUsed, std::vector<unsigned> &rStack, unsigned &rTime, std::set<std::set<unsigned> > &rComponents
-        ) const
+std::set<std::set<unsigned> > ThresholdErgodicSetDifferentiationTree::getTerminalStronglyConnectedComponents(
+        const StochasticMatrixView& rMatrix) const
 {
-    pLowlink[u] = rTime++;
-    pUsed[u] = true;
-    rStack.push_back(u);
-    bool is_component_root = true;
-
-    std::map<unsigned, double>::iterator iterator;
-    for (iterator = graph.at(u).begin(); iterator != graph.at(u).end(); ++iterator)
-    {
-        unsigned v = iterator->first;
-        if (!pUsed[v])
-        {
-            findComponentDepthFirstSearch(v, graph, pLowlink,
-                        pUsed, rStack, rTime, rComponents);
-        }
-        if (pLowlink[u] > pLowlink[v])
-        {
-            pLowlink[u] = pLowlink[v];
-            is_component_root = false;
-        }
-    }
-    if (is_component_root)
-    {
-        std::set<unsigned> component;
-        unsigned k = 0;
-        do {
-            k = rStack.back();
-            rStack.pop_back();
-            component.insert(k);
-            pLowlink[k] = std::numeric_limits<unsigned int>::max();
-        } while (k != u);
-        rComponents.insert(component);
-    }
+    const StochasticMatrix& r_matrix = rMatrix.getMatrix();
+    StronglyConnectedComponents components(r_matrix.getSize(), r_matrix.getRowOffsets(), r_matrix.getColumns(),
+            r_matrix.getValues(), rMatrix.getThreshold());
+    //each reachable node from a member of a terminal scc must be a member of the terminal scc
+    return components.getTerminalComponentSets();
 }
 
-std::vector<double> ThresholdErgodicSetDifferentiationTree::findStationaryDistribution(
-        std::vector<std::map<unsigned, double> > tes_map_matrix,
-        std::set<unsigned> component) const
+std::vector<const std::vector<double>*> ThresholdErgodicSetDifferentiationTree::findStationaryDistributions(
+        const std::vector<double>& rThresholds,
+        const std::vector<std::vector<unsigned> >& rComponents) const
 {
-	//Mat ergodic_matrix;
-	unsigned size = component.size();
-	if (size == 1)
+	ScopedPhase phase("findStationaryDistributions");
+	/* The cache is used by this thread only: the components to solve and
+	 * their pruned matrices are found before the parallel region, and the
+	 * solutions are stored after it. The jobs are (size, component). */
+	std::vector<const std::vector<double>*> distributions(rComponents.size(), NULL);
+	std::set<std::pair<double, std::vector<unsigned> > > new_components;
+	std::vector<std::pair<unsigned, unsigned> > jobs;
+	for (unsigned i=0; i<rComponents.size(); i++)
+	{
+		distributions[i] = mPrunedMatrixCache.findStationaryDistribution(rThresholds[i], rComponents[i]);
+		if (distributions[i] == NULL && new_components.insert(std::make_pair(rThresholds[i], rComponents[i])).second)
+		{
+			jobs.push_back(std::make_pair((unsigned) rComponents[i].size(), i));
+		}
+	}
+	std::sort(jobs.rbegin(), jobs.rend());
+	std::vector<const StochasticMatrixView*> views(jobs.size());
+	for (unsigned job=0; job<jobs.size(); job++)
 	{
-		std::vector<double> stationary_distribution(1,1.0);
-		return stationary_distribution;
+		views[job] = &mPrunedMatrixCache.getPrunedMatrix(rThresholds[jobs[job].second]);
 	}
-	LinearSystem ls(size, size);
-	ls.SetMatrixIsConstant(true);
 
-	std::set<unsigned>::iterator set_iterator;
-	unsigned row = 0;
-	for (set_iterator = component.begin(); set_iterator!=component.end(); ++set_iterator)
+	/* An exception must not leave the parallel region. */
+	std::vector<std::vector<double> > solutions(jobs.size());
+	std::vector<std::string> errors(jobs.size());
+	int jobs_number = jobs.size();
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(dynamic)
+#endif
+	for (int job=0; job<jobs_number; job++)
 	{
-		if (row != size - 1)
+		try
 		{
-			ls.SetRhsVectorElement(row,0.0);
+			solutions[job] = mStationaryDistributionSolver.solve(*views[job], rComponents[jobs[job].second]);
 		}
-		else
+		catch (Exception& e)
 		{
-			ls.SetRhsVectorElement(row,1.0);
+			errors[job] = e.GetShortMessage();
 		}
-		unsigned state_value = *set_iterator;
-		std::map<unsigned, double> map_row = tes_map_matrix.at(state_value);
-		std::map<unsigned, double>::iterator map_iterator = map_row.begin();
-		for(unsigned col = 0; col<size; col++)
+	}
+
+	for (unsigned job=0; job<jobs.size(); job++)
+	{
+		if (!errors[job].empty()) EXCEPTION(errors[job]);
+		unsigned i = jobs[job].second;
+		mPrunedMatrixCache.addStationaryDistribution(rThresholds[i], rComponents[i], solutions[job]);
+		if (rComponents[i].size() > 1)
 		{
-			if (col == size-1)
-			{
-				ls.SetMatrixElement(col, row, 1);
-			}
-			else
-			{
-				if (map_iterator != map_row.end() && map_iterator->first == col)
-				{
-					if (col == row)
-					{
-						ls.SetMatrixElement(col, row, map_iterator->second - 1.0);
-					}
-					else
-					{
-						ls.SetMatrixElement(col, row, map_iterator->second);
-					}
-					map_iterator++;
-				}
-				else
-				{
-					ls.SetMatrixElement(col, row, 0.0);
-				}
-			}
+			Instrumentation::increment(Instrumentation::LINEAR_SOLVES);
 		}
-		row++;
 	}
-	ls.AssembleFinalLinearSystem();
-	/* Visualization */
-	//ls.DisplayMatrix();
-	//ls.DisplayRhs();
-	/* End visualization */
-	Vec solution_vector;
-	solution_vector = ls.Solve();
-	double* p_solution_elements_array;
-	VecGetArray(solution_vector, &p_solution_elements_array);
-	std::vector<double> stationary_distribution(p_solution_elements_array, p_solution_elements_array + size);
-	VecRestoreArray(solution_vector, &p_solution_elements_array);
-	PetscTools::Destroy(solution_vector);
-	return stationary_distribution;
+	for (unsigned i=0; i<rComponents.size(); i++)
+	{
+		if (distributions[i] == NULL)
+		{
+			distributions[i] = mPrunedMatrixCache.findStationaryDistribution(rThresholds[i], rComponents[i]);
+		}
+	}
+	return distributions;
 }
 
 double ThresholdErgodicSetDifferentiationTree::getCellCycleLength(
-        std::vector<double> stationary_distribution, std::set<unsigned> component) const
+        const std::vector<double>& stationary_distribution, const std::set<unsigned>& component) const
 {
     double length = 0;
-    std::set<unsigned>::iterator set_iterator;
+    std::set<unsigned>::const_iterator set_iterator;
     unsigned i=0;
     for (set_iterator = component.begin(); set_iterator != component.end();++set_iterator)
     {
@@ -486,6 +398,18 @@ double ThresholdErgodicSetDifferentiationTree::getCellCycleLength(
     return length;
 }
 
+void ThresholdErgodicSetDifferentiationTree::setThresholdTolerance(double tolerance)
+{
+    if (tolerance < 0.0)
+        EXCEPTION("The threshold tolerance must be >= 0.");
+    mThresholdTolerance = tolerance;
+}
+
+double ThresholdErgodicSetDifferentiationTree::getThresholdTolerance() const
+{
+    return mThresholdTolerance;
+}
+
 const RandomBooleanNetwork* ThresholdErgodicSetDifferentiationTree::getBooleanNetwork() const
 {
     return mpBooleanNetwork;
@@ -495,7 +419,7 @@ std::vector<unsigned> ThresholdErgodicSetDifferentiationTree::getAttractorLength
 {
     return mAttractorLength;
 }
-std::vector<std::map<unsigned,double> > ThresholdErgodicSetDifferentiationTree::getStochasticMatrix() const
+const StochasticMatrix& ThresholdErgodicSetDifferentiationTree::getStochasticMatrix() const
 {
     return mStochasticMatrix;
 }
@@ -508,8 +432,8 @@ DifferentiationTree* ThresholdErgodicSetDifferentiationTree::getDifferentiationT
 }
 
 bool ThresholdErgodicSetDifferentiationTree::isThresholdErgodicSet(
-        std::vector<std::map<unsigned,double> > matrix,
-        const std::set<std::set<unsigned> > components
+        const StochasticMatrix& matrix,
+        const std::set<std::set<unsigned> >& components
         ) const
 {
     unsigned attractors_in_terminal_components = 0;
@@ -520,61 +444,74 @@ bool ThresholdErgodicSetDifferentiationTree::isThresholdErgodicSet(
     {
     	attractors_in_terminal_components += comp_iterator->size();
     }
-    return attractors_in_terminal_components==matrix.size();
+    return attractors_in_terminal_components==matrix.getSize();
 }
 
 void ThresholdErgodicSetDifferentiationTree::assignProbabilitiesAndCellCycleLengths(
 		DifferentiationTree* differentiation_tree) const
 {
+	ScopedPhase phase("assignProbabilitiesAndCellCycleLengths");
+	std::vector<unsigned> nodes;
+	std::vector<double> thresholds;
+	std::vector<std::vector<unsigned> > components;
 	for (unsigned i=0; i<differentiation_tree->size(); i++)
 	{
 		if (i==0 && differentiation_tree->hasFakeRoot()) continue;
-		double threshold = differentiation_tree->getNode(i)->getThreshold();
-	    std::vector<std::map<unsigned,double> > current_stochastic_matrix(mStochasticMatrix);
-	    if (threshold < 1.0)
+		std::set<unsigned> component_states = differentiation_tree->getNode(i)->getComponentStates();
+		nodes.push_back(i);
+		thresholds.push_back(differentiation_tree->getNode(i)->getThreshold());
+		components.push_back(std::vector<unsigned>(component_states.begin(), component_states.end()));
+	}
+	std::vector<const std::vector<double>*> distributions = findStationaryDistributions(thresholds, components);
+
+	/* The tree is only read by the threads. */
+	std::vector<double> cell_cycle_lengths(nodes.size());
+	std::vector<std::vector<double> > stoc_differentiation_vectors(nodes.size());
+	int nodes_number = nodes.size();
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(dynamic)
+#endif
+	for (int k=0; k<nodes_number; k++)
+	{
+		const std::vector<double>& stationary_distribution = *distributions[k];
+		const std::vector<unsigned>& component_states = components[k];
+		cell_cycle_lengths[k] = this->getCellCycleLength(stationary_distribution,
+				std::set<unsigned>(component_states.begin(), component_states.end()));
+		/* At threshold 1 (or more) there is no child. */
+		if (thresholds[k] >= 1.0) continue;
+		std::vector<unsigned> children = differentiation_tree->getNode(nodes[k])->getChildren();
+		for (unsigned child_count = 0; child_count<children.size();++child_count)
 		{
-			current_stochastic_matrix = getPrunedMatrix(threshold);
-			std::set<unsigned> component_states = differentiation_tree->getNode(i)->getComponentStates();
-			std::vector<double> stationary_distribution = findStationaryDistribution(current_stochastic_matrix, component_states);
-			double cell_cycle_length = this->getCellCycleLength(stationary_distribution, component_states);
-			std::vector<double> stoc_differentiation_vector;
-			std::vector<unsigned> children = differentiation_tree->getNode(i)->getChildren();
-			std::set<unsigned>::iterator child_iterator;
-			for (unsigned child_count = 0; child_count<children.size();++child_count)
+			double probability = 0.0;
+
+			/* The states of the child are a subset of the component, and
+			 * the distribution is in the order of the component. */
+			std::set<unsigned> component_states_child = differentiation_tree->getNode(children.at(child_count))->getComponentStates();
+			std::set<unsigned>::iterator set_iterator;
+			std::vector<unsigned>::const_iterator position = component_states.begin();
+			for (set_iterator = component_states_child.begin();
+					set_iterator!=component_states_child.end();
+					set_iterator++)
 			{
-				double probability = 0.0;
-
-				std::set<unsigned> component_states_child = differentiation_tree->getNode(children.at(child_count))->getComponentStates();
-				std::set<unsigned>::iterator set_iterator;
-				for (set_iterator = component_states_child.begin();
-						set_iterator!=component_states_child.end();
-						set_iterator++)
-				{
-					probability += stationary_distribution.at(*set_iterator);
-				}
-				stoc_differentiation_vector.push_back(probability);
+				position = std::lower_bound(position, component_states.end(), *set_iterator);
+				assert(position != component_states.end() && *position == *set_iterator);
+				probability += stationary_distribution[position - component_states.begin()];
 			}
-			differentiation_tree->setStationaryDistributionAndCellCycleLength(
-					i,
-					stationary_distribution,
-					cell_cycle_length);
+			stoc_differentiation_vectors[k].push_back(probability);
+		}
+	}
+
+	for (unsigned k=0; k<nodes.size(); k++)
+	{
+		differentiation_tree->setStationaryDistributionAndCellCycleLength(
+				nodes[k],
+				*distributions[k],
+				cell_cycle_lengths[k]);
+		if (thresholds[k] < 1.0)
+		{
 			differentiation_tree->setDifferentiationProbability(
-					i, stoc_differentiation_vector);
+					nodes[k], stoc_differentiation_vectors[k]);
 		}
-	    else
-	    {
-	    	std::set<unsigned> component_states = differentiation_tree->getNode(i)->getComponentStates();
-	    	std::vector<double> stationary_distribution = findStationaryDistribution(current_stochastic_matrix, component_states);
-	    	double cell_cycle_length = this->getCellCycleLength(stationary_distribution, component_states);
-			differentiation_tree->setStationaryDistributionAndCellCycleLength(
-					i,
-					stationary_distribution,
-					cell_cycle_length);
-			std::vector<double> stoc_differentiation_vector;
-			/** This is a fake probability. */
-			//stoc_differentiation_vector.push_back(1.0);
-			//differentiation_tree->setDifferentiationProbability(i, stoc_differentiation_vector);
-	    }
 	}
 }
 
@@ -590,22 +527,24 @@ void ThresholdErgodicSetDifferentiationTree::printStochasticMatrixAndAttractorLe
 	OutputFileHandler handler(directory,false);
 	out_stream p_file = handler.OpenOutputFile(filename);
 
-	for (unsigned row=0; row<mStochasticMatrix.size();row++)
+	const unsigned* p_row_offsets = mStochasticMatrix.getRowOffsets();
+	const unsigned* p_columns = mStochasticMatrix.getColumns();
+	const double* p_values = mStochasticMatrix.getValues();
+	for (unsigned row=0; row<mStochasticMatrix.getSize();row++)
 	{
 		unsigned col=0;
-        std::map<unsigned,double>::const_iterator iterator;
-        for (iterator=mStochasticMatrix.at(row).begin(); iterator!=mStochasticMatrix.at(row).end(); ++iterator)
+        for (unsigned entry=p_row_offsets[row]; entry<p_row_offsets[row+1]; entry++)
         {
-			for (;col<iterator->first;col++)
+			for (;col<p_columns[entry];col++)
 			{
 				if (col!=0) *p_file << ",";
 				*p_file << 0.0;
 			}
 			if (col!=0) *p_file << ",";
-			*p_file << iterator->second;
+			*p_file << p_values[entry];
 			col++;
 		}
-		for (;col<mStochasticMatrix.size();col++)
+		for (;col<mStochasticMatrix.getSize();col++)
 		{
 			if (col!=0) *p_file << ",";
 			*p_file << 0.0;
@@ -621,3 +560,9 @@ void ThresholdErgodicSetDifferentiationTree::printStochasticMatrixAndAttractorLe
 	*p_file << "\n";
 	p_file->close();
 }
+
+void ThresholdErgodicSetDifferentiationTree::printStochasticMatrixAndAttractorLengthsToSparseFile(
+		std::string directory, std::string filename) const
+{
+	SparseAtnFile::write(directory, filename, mStochasticMatrix, mAttractorLength);
+}
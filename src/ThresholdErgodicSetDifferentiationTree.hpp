@@ -6,18 +6,17 @@
 #include <set>
 #include "DifferentiationTree.hpp"
 #include "RandomBooleanNetwork.hpp"
+#include "StochasticMatrix.hpp"
+#include "StationaryDistributionSolver.hpp"
+#include "PrunedMatrixCache.hpp"
 #include "Exception.hpp"
-#include "LinearSystem.hpp"
-#include "PetscTools.hpp"
-#include "PetscVecTools.hpp"
-#include "PetscMatTools.hpp"
 
 
 class ThresholdErgodicSetDifferentiationTree
 {
 private:
     /** Stochastic matrix representing the ATN */
-    std::vector<std::map<unsigned,double> > mStochasticMatrix;
+    StochasticMatrix mStochasticMatrix;
 
     /**
      * A vector of the same size of the mAttractors in which the
@@ -28,86 +27,105 @@ private:
     /** A pointer to a Boolean Network */
     RandomBooleanNetwork* mpBooleanNetwork;
 
+    /** The solver of the stationary distributions of the components */
+    StationaryDistributionSolver mStationaryDistributionSolver;
+
+    /**
+     * The pruned matrices and the stationary distributions already
+     * computed, by threshold. The stochastic matrix never changes, so
+     * they are kept for the next trees.
+     */
+    mutable PrunedMatrixCache mPrunedMatrixCache;
+
+    /** Thresholds closer than this are merged (see getThresholdValues()) */
+    double mThresholdTolerance;
+
     /** A pointer to a DifferentiationTree */
     //DifferentiationTree* mpDifferentiationTree;
 
     /**
      * Method to compute a differentiation tree starting from a
-     * stochastic matrix and the attractor lengths.
+     * stochastic matrix and the attractor lengths. The thresholds are
+     * swept with a TerminalComponentSweep, so the components are not
+     * computed from scratch at every threshold, and the thresholds which
+     * do not change the terminal components are skipped. Small and dense
+     * ATNs (see DenseTerminalComponentSweep::isSuitable()) are swept on a
+     * dense matrix.
      */
     DifferentiationTree* computeDifferentiationTree() const;
 
     /**
-     * Return all the different values >= 0 conteined in the stochastic
-     * matrix.
+     * The sweep of the thresholds of computeDifferentiationTree(), without
+     * the probabilities.
      *
-     * @return a set of double, all the possible threshold candidates.
+     * @param sweep a TerminalComponentSweep or a DenseTerminalComponentSweep
+     * of mStochasticMatrix
+     *
+     * @return a pointer to a new DifferentiationTree.
      */
-    std::set<double> getThresholdValues() const;
+    template<class SWEEP>
+    DifferentiationTree* sweepThresholds(SWEEP& sweep) const;
 
     /**
-     * Normalize a pruned matrix in an ergodic matrix
+     * Return all the different values >= 0 conteined in the stochastic
+     * matrix. If the threshold tolerance is > 0, the values are grouped
+     * from the smallest one: a value within the tolerance from the
+     * smallest value of its group is merged into it, and every group is
+     * represented by its largest value, so that it is pruned at once.
      *
-     * @param matrix pruned matrix
+     * @return a set of double, all the possible threshold candidates.
      */
-    void normalizePrunedMatrix(std::vector<std::map<unsigned,double> > &matrix) const;
+    std::set<double> getThresholdValues() const;
 
     /**
-     * Get a pruned matrix from the stochastic matrix
+     * Get a pruned matrix from the stochastic matrix: the entries
+     * <= threshold are masked and the rows are normalised.
+     *
+     * The view is built once per threshold (see PrunedMatrixCache).
      *
      * @param threshold value
      *
-     * @return pruned matrix
+     * @return pruned matrix, as a view on mStochasticMatrix
      */
-    std::vector<std::map<unsigned,double> > getPrunedMatrix(double threshold) const;
+    const StochasticMatrixView& getPrunedMatrix(double threshold) const;
 
     /**
      * Get the strongly connected components from a matrix (see as
      * Adjacency table of a graph where exist an edge if the value
-     * matrix[i][j] is > 0), using the Tarjan's algorithm.
+     * matrix[i][j] is > 0), using StronglyConnectedComponents.
      *
-     * @param matrix
+     * @param rMatrix the matrix
      *
      * @return set of sets ssc of the graph.
      */
-    std::set<std::set<unsigned> > getStronglyConnectedComponents(std::vector<std::map<unsigned,double> > graph) const;
+    std::set<std::set<unsigned> > getStronglyConnectedComponents(const StochasticMatrixView& rMatrix) const;
 
     /**
-     * Get the strongly connected components from a matrix (see as
-     * Adjacency table of a graph where exist an edge if the value
-     * matrix[i][j] is > 0), using the Tarjan's algorithm.
+     * Get the terminal strongly connected components from a matrix (see
+     * as Adjacency table of a graph where exist an edge if the value
+     * matrix[i][j] is > 0), using StronglyConnectedComponents.
      *
-     * @param matrix
-     *
-     * @return set of sets ssc of the graph.
-     */
-    std::set<std::set<unsigned> > getTerminalStronglyConnectedComponents(std::vector<std::map<unsigned,double> > graph) const;
-
-    /**
-     * Helper of the getStronglyConnectedComponents() method. Find the
-     * components using depth first search.
+     * @param rMatrix the matrix
      *
-     * @param u
-     * @param graph
-     * @param lowlink
-     * @param used
-     * @param stack
-     * @param time
-     * @param components
+     * @return set of sets terminal ssc of the graph.
      */
-    void findComponentDepthFirstSearch(unsigned u, std::vector<std::map<unsigned,double> > graph, unsigned* lowlink,
-            bool* used, std::vector<unsigned> &stack, unsigned &time, std::set<std::set<unsigned> > &components) const;
+    std::set<std::set<unsigned> > getTerminalStronglyConnectedComponents(const StochasticMatrixView& rMatrix) const;
 
     /**
-     * Find the stationary distribution of the TES using the
-     * exact method.
+     * Find the stationary distributions of the TES using the
+     * exact method (GTH elimination, or Gauss-Seidel for large
+     * components: see StationaryDistributionSolver). A component is
+     * solved only the first time it is met at a threshold; the new
+     * components are solved in parallel, largest first.
      *
-     * @param tes_map_matrix
-     * @param component
+     * @param rThresholds the threshold of the pruned matrix of every component
+     * @param rComponents the components, each in ascending order
      *
-     * @return a stochastic vector containing the stationary distribution
+     * @return the stationary distribution of every component (owned by
+     * mPrunedMatrixCache).
      */
-    std::vector<double> findStationaryDistribution(std::vector<std::map<unsigned, double> > tes_map_matrix, std::set<unsigned> component) const;
+    std::vector<const std::vector<double>*> findStationaryDistributions(const std::vector<double>& rThresholds,
+            const std::vector<std::vector<unsigned> >& rComponents) const;
 
     /**
      * The length of the cell cycle of the TES is obtained by weighted sum
@@ -120,11 +138,14 @@ private:
      *
      * @return length of the cell cycle model
      */
-    double getCellCycleLength(std::vector<double> stationary_distribution, std::set<unsigned> component) const;
+    double getCellCycleLength(const std::vector<double>& stationary_distribution, const std::set<unsigned>& component) const;
 
     /**
      * This method assigns probabilities and a cell cycle length
-     * to each node of the tree.
+     * to each node of the tree. The nodes added at the same threshold
+     * share the pruned matrix. The nodes are independent, so they are
+     * processed in parallel; every value is computed by one thread, in
+     * the same order, so the results do not depend on the threads.
      *
      * @param a differentiation tree.
      */
@@ -139,8 +160,18 @@ public:
      * @param m_stochastic_matrix
      * @param m_attractor_length
      */
-    ThresholdErgodicSetDifferentiationTree(std::vector<std::map<unsigned,double> > m_stochastic_matrix,
-            std::vector<unsigned> m_attractor_length);
+    ThresholdErgodicSetDifferentiationTree(const std::vector<std::map<unsigned,double> >& m_stochastic_matrix,
+            const std::vector<unsigned>& m_attractor_length);
+
+    /**
+     * Constructor 5: as constructor 1, but the object takes the stochastic
+     * matrix, which is left empty (no copy).
+     *
+     * @param rStochasticMatrix the stochastic matrix
+     * @param m_attractor_length
+     */
+    ThresholdErgodicSetDifferentiationTree(StochasticMatrix& rStochasticMatrix,
+            const std::vector<unsigned>& m_attractor_length);
 
     /**
      * Constructor 2: create a RandomBooleanNetwork object and compute
@@ -171,6 +202,8 @@ public:
      * Constructor 4: create a RandomBooleanNetwork object and compute
      * the differentiation tree from the boolean network. This constructor
      * call the constructor 3 of the RandomBooleanNetwork class.
+     * A .dat (dense), .atn or .atnb (sparse, see SparseAtnFile) file
+     * contains the ATN itself, which is read without a network.
      *
      * @param file_path path of the file.
      *
@@ -183,6 +216,21 @@ public:
      */
     ~ThresholdErgodicSetDifferentiationTree();
 
+    /**
+     * Set the tolerance used to merge near-identical thresholds (0, the
+     * default, keeps every distinct value of the stochastic matrix).
+     *
+     * @param tolerance the tolerance, >= 0
+     */
+    void setThresholdTolerance(double tolerance);
+
+    /**
+     * getter of mThresholdTolerance.
+     *
+     * @return mThresholdTolerance.
+     */
+    double getThresholdTolerance() const;
+
     /**
      * getter of mpRandomBooleanNetwork.
      *
@@ -202,7 +250,7 @@ public:
      *
      * @return mStochasticMatrix.
      */
-    std::vector<std::map<unsigned,double> > getStochasticMatrix() const;
+    const StochasticMatrix& getStochasticMatrix() const;
 
     /**
      * Return a pointer to a DifferentiationTree. This tree is
@@ -232,16 +280,28 @@ public:
      *
      * @return bool true the matrix is a TES
      */
-    bool isThresholdErgodicSet(std::vector<std::map<unsigned,double> > matrix, const std::set<std::set<unsigned> > components) const;
+    bool isThresholdErgodicSet(const StochasticMatrix& matrix, const std::set<std::set<unsigned> >& components) const;
 
     /**
 	 * Save the stochastic matrix and the lengths of the attractors in a .dat file.
+	 * This dense format is kept for compatibility: for large ATNs use
+	 * printStochasticMatrixAndAttractorLengthsToSparseFile().
 	 *
 	 * @param directory the name of the subfolder of testoutput.
 	 * @param filename the file name of the output file.
      */
     void printStochasticMatrixAndAttractorLengthsToDatFile(std::string directory, std::string filename) const;
 
+    /**
+	 * Save the stochastic matrix and the lengths of the attractors in a
+	 * sparse .atn (text) or .atnb (binary) file (see SparseAtnFile), which
+	 * constructor 4 can read.
+	 *
+	 * @param directory the name of the subfolder of testoutput.
+	 * @param filename the file name of the output file.
+     */
+    void printStochasticMatrixAndAttractorLengthsToSparseFile(std::string directory, std::string filename) const;
+
 };
 
 #endif /* THRESHOLDERGODICSETDIFFERENTIATIONTREE_HPP_ */
@@ -0,0 +1,238 @@
+#include "TruthTableNetwork.hpp"
+#include <cassert>
+#include <cstdlib>
+#include <algorithm>
+#include <boost/lexical_cast.hpp>
+
+/**
+ * Gather the values of K inputs from a packed state into a truth table row.
+ * K is known at compile time, so the loop is unrolled.
+ *
+ * @param p_inputs the inputs of the node
+ * @param p_state the packed state
+ *
+ * @return the row of the truth table
+ */
+template<unsigned K>
+inline unsigned gatherInputs(const unsigned* p_inputs, const uint64_t* p_state)
+{
+    unsigned row = 0;
+    for (unsigned j=0; j<K; j++)
+    {
+        row |= ((unsigned) (p_state[p_inputs[j] >> 6] >> (p_inputs[j] & 63)) & 1u) << j;
+    }
+    return row;
+}
+
+TruthTableNetwork::TruthTableNetwork(const RandomBooleanNetwork& network)
+{
+    unsigned nodes_number = network.getNodesNumber();
+    std::vector<std::vector<unsigned> > inputs(nodes_number);
+    std::vector<std::vector<uint64_t> > truth_tables(nodes_number);
+    /* position[v] is the input index of the BDD variable v, or -1 */
+    std::vector<int> position(nodes_number * 2, -1);
+
+    for (unsigned node=0; node<nodes_number; node++)
+    {
+        inputs[node] = network.getGraph()->getIncomingVerticesById(node);
+        bdd function = network.getNodeFunction(node);
+
+        /* Generated canalyzing functions can read nodes which are not
+         * inputs in the graph: they are appended to the inputs. */
+        int* p_support_variables = NULL;
+        int support_size = 0;
+        bdd_scanset(bdd_support(function), p_support_variables, support_size);
+        for (int i=0; i<support_size; i++)
+        {
+            unsigned input = (unsigned) p_support_variables[i] / 2;
+            if (std::find(inputs[node].begin(), inputs[node].end(), input) == inputs[node].end())
+            {
+                inputs[node].push_back(input);
+            }
+        }
+        free(p_support_variables);
+
+        unsigned inputs_number = inputs[node].size();
+        if (inputs_number > MAX_INPUTS)
+            EXCEPTION("Node " + boost::lexical_cast<std::string>(node + 1) + " has too many inputs for a truth table.");
+        for (unsigned j=0; j<inputs_number; j++)
+        {
+            position[inputs[node][j] * 2] = (int) j;
+        }
+
+        unsigned rows = 1u << inputs_number;
+        truth_tables[node].assign(rows > 64 ? rows / 64 : 1, 0);
+        for (unsigned row=0; row<rows; row++)
+        {
+            /* Walk the BDD following the values of the inputs in this row. */
+            bdd current = function;
+            while (current != bddtrue && current != bddfalse)
+            {
+                int input = position[bdd_var(current)];
+                assert(input >= 0);
+                current = ((row >> input) & 1u) ? bdd_high(current) : bdd_low(current);
+            }
+            if (current == bddtrue)
+            {
+                truth_tables[node][row >> 6] |= ((uint64_t) 1) << (row & 63);
+            }
+        }
+        for (unsigned j=0; j<inputs_number; j++)
+        {
+            position[inputs[node][j] * 2] = -1;
+        }
+    }
+    initialise(inputs, truth_tables);
+}
+
+TruthTableNetwork::TruthTableNetwork(const std::vector<std::vector<unsigned> >& inputs,
+        const std::vector<std::vector<uint64_t> >& truth_tables)
+{
+    if (inputs.empty() || inputs.size() != truth_tables.size())
+        EXCEPTION("Inputs and truth tables must be given for every node.");
+    for (unsigned node=0; node<inputs.size(); node++)
+    {
+        if (inputs[node].size() > MAX_INPUTS)
+            EXCEPTION("Node " + boost::lexical_cast<std::string>(node + 1) + " has too many inputs for a truth table.");
+        unsigned rows = 1u << inputs[node].size();
+        if (truth_tables[node].size() != (rows > 64 ? rows / 64 : 1))
+            EXCEPTION("Truth table of node " + boost::lexical_cast<std::string>(node + 1) + " has a wrong size.");
+        for (unsigned j=0; j<inputs[node].size(); j++)
+        {
+            if (inputs[node][j] >= inputs.size())
+                EXCEPTION("Input node id value is greater or equal to the number of nodes.");
+        }
+    }
+    initialise(inputs, truth_tables);
+}
+
+void TruthTableNetwork::initialise(const std::vector<std::vector<unsigned> >& inputs,
+        const std::vector<std::vector<uint64_t> >& truth_tables)
+{
+    mNodesNumber = inputs.size();
+    mWordsPerState = (mNodesNumber + 63) / 64;
+    mInputsOffset.assign(1, 0);
+    mTruthTablesOffset.assign(1, 0);
+    mInputs.clear();
+    mTruthTables.clear();
+    mNodesByInputsNumber.assign(MAX_SINGLE_WORD_INPUTS + 2, std::vector<unsigned>());
+
+    for (unsigned node=0; node<mNodesNumber; node++)
+    {
+        mInputs.insert(mInputs.end(), inputs[node].begin(), inputs[node].end());
+        mInputsOffset.push_back(mInputs.size());
+        uint64_t rows_mask = ~((uint64_t) 0);
+        if (inputs[node].size() < MAX_SINGLE_WORD_INPUTS)
+        {
+            /* Unused rows are cleared, so tables can be compared word by word. */
+            rows_mask = (((uint64_t) 1) << (1u << inputs[node].size())) - 1;
+        }
+        mTruthTables.push_back(truth_tables[node][0] & rows_mask);
+        mTruthTables.insert(mTruthTables.end(), truth_tables[node].begin() + 1, truth_tables[node].end());
+        mTruthTablesOffset.push_back(mTruthTables.size());
+        mNodesByInputsNumber[std::min(inputs[node].size(), (size_t) MAX_SINGLE_WORD_INPUTS + 1)].push_back(node);
+    }
+}
+
+template<unsigned K>
+void TruthTableNetwork::updateNodes(const std::vector<unsigned>& nodes,
+        const uint64_t* p_current, uint64_t* p_next) const
+{
+    const unsigned* p_inputs = mInputs.empty() ? NULL : &mInputs[0];
+    const uint64_t* p_tables = &mTruthTables[0];
+    for (unsigned i=0; i<nodes.size(); i++)
+    {
+        unsigned node = nodes[i];
+        unsigned row = gatherInputs<K>(p_inputs + mInputsOffset[node], p_current);
+        p_next[node >> 6] |= ((p_tables[mTruthTablesOffset[node]] >> row) & 1u) << (node & 63);
+    }
+}
+
+void TruthTableNetwork::updateNodesGeneric(const std::vector<unsigned>& nodes,
+        const uint64_t* p_current, uint64_t* p_next) const
+{
+    for (unsigned i=0; i<nodes.size(); i++)
+    {
+        unsigned node = nodes[i];
+        p_next[node >> 6] |= ((uint64_t) evaluateNode(node, p_current)) << (node & 63);
+    }
+}
+
+void TruthTableNetwork::update(const uint64_t* p_current, uint64_t* p_next) const
+{
+    assert(p_current != p_next);
+    std::fill(p_next, p_next + mWordsPerState, (uint64_t) 0);
+    updateNodes<0>(mNodesByInputsNumber[0], p_current, p_next);
+    updateNodes<1>(mNodesByInputsNumber[1], p_current, p_next);
+    updateNodes<2>(mNodesByInputsNumber[2], p_current, p_next);
+    updateNodes<3>(mNodesByInputsNumber[3], p_current, p_next);
+    updateNodes<4>(mNodesByInputsNumber[4], p_current, p_next);
+    updateNodes<5>(mNodesByInputsNumber[5], p_current, p_next);
+    updateNodes<6>(mNodesByInputsNumber[6], p_current, p_next);
+    updateNodesGeneric(mNodesByInputsNumber[MAX_SINGLE_WORD_INPUTS + 1], p_current, p_next);
+}
+
+bool TruthTableNetwork::evaluateNode(unsigned node, const uint64_t* p_state) const
+{
+    assert(node < mNodesNumber);
+    unsigned row = 0;
+    for (unsigned j=mInputsOffset[node]; j<mInputsOffset[node+1]; j++)
+    {
+        row |= ((unsigned) getNodeValue(p_state, mInputs[j])) << (j - mInputsOffset[node]);
+    }
+    return getTruthTableValue(node, row);
+}
+
+unsigned TruthTableNetwork::getNodesNumber() const
+{
+    return mNodesNumber;
+}
+
+unsigned TruthTableNetwork::getWordsPerState() const
+{
+    return mWordsPerState;
+}
+
+unsigned TruthTableNetwork::getInputsNumber(unsigned node) const
+{
+    assert(node < mNodesNumber);
+    return mInputsOffset[node+1] - mInputsOffset[node];
+}
+
+const unsigned* TruthTableNetwork::getInputs(unsigned node) const
+{
+    assert(node < mNodesNumber);
+    return mInputs.empty() ? NULL : &mInputs[0] + mInputsOffset[node];
+}
+
+const uint64_t* TruthTableNetwork::getTruthTable(unsigned node) const
+{
+    assert(node < mNodesNumber);
+    return &mTruthTables[mTruthTablesOffset[node]];
+}
+
+bool TruthTableNetwork::getTruthTableValue(unsigned node, unsigned row) const
+{
+    assert(node < mNodesNumber);
+    return (mTruthTables[mTruthTablesOffset[node] + (row >> 6)] >> (row & 63)) & 1u;
+}
+
+double TruthTableNetwork::getNodeSensitivity(unsigned node) const
+{
+    assert(node < mNodesNumber);
+    unsigned inputs_number = getInputsNumber(node);
+    unsigned rows = 1u << inputs_number;
+    unsigned changes = 0;
+    for (unsigned row=0; row<rows; row++)
+    {
+        bool value = getTruthTableValue(node, row);
+        for (unsigned j=0; j<inputs_number; j++)
+        {
+            if (getTruthTableValue(node, row ^ (1u << j)) != value)
+            {
+                changes++;
+            }
+        }
+    }
+    return (double) changes / rows;
+}
@@ -0,0 +1,210 @@
+#ifndef TRUTHTABLENETWORK_HPP_
+#define TRUTHTABLENETWORK_HPP_
+
+#include "RandomBooleanNetwork.hpp"
+#include "Exception.hpp"
+#include <vector>
+#include <stdint.h>
+
+/**
+ * Explicit representation of a synchronous Boolean network, in which
+ * the function of every node is stored as a packed truth table.
+ *
+ * A state of the network is packed in getWordsPerState() 64-bit words:
+ * the value of node i is the bit (i % 64) of the word (i / 64).
+ *
+ * The row of the truth table of a node is obtained gathering its inputs:
+ * the value of the j-th input is the bit j of the row. Nodes with at most
+ * six inputs have their table in a single word, and the evaluator is
+ * specialised (templated) on the number of inputs, so gather and lookup are
+ * unrolled at compile time. Nodes with more inputs use 2^(K-6) words and a
+ * generic evaluator.
+ *
+ * This class is used by all the explicit-state engines (simulation,
+ * sampling, sensitivity) instead of evaluating BDDs.
+ */
+class TruthTableNetwork
+{
+private:
+
+    /** The number of nodes in the network */
+    unsigned mNodesNumber;
+
+    /** The number of 64-bit words used for a packed state */
+    unsigned mWordsPerState;
+
+    /** Offsets of the inputs of every node in mInputs (size mNodesNumber + 1) */
+    std::vector<unsigned> mInputsOffset;
+
+    /** Inputs of all the nodes, stored contiguously */
+    std::vector<unsigned> mInputs;
+
+    /** Offsets of the truth table of every node in mTruthTables (size mNodesNumber + 1) */
+    std::vector<unsigned> mTruthTablesOffset;
+
+    /** Truth tables of all the nodes, stored contiguously */
+    std::vector<uint64_t> mTruthTables;
+
+    /**
+     * Nodes grouped by number of inputs: the k-th entry (k <= 6) contains
+     * the nodes with k inputs, the last one the nodes with more than six.
+     */
+    std::vector<std::vector<unsigned> > mNodesByInputsNumber;
+
+    /**
+     * Fill the data structures from inputs and truth tables of every node.
+     *
+     * @param inputs the inputs of every node
+     * @param truth_tables the truth tables of every node
+     */
+    void initialise(const std::vector<std::vector<unsigned> >& inputs,
+            const std::vector<std::vector<uint64_t> >& truth_tables);
+
+    /**
+     * Compute the next value of a group of nodes having exactly K inputs
+     * (K <= 6), setting the bits in the next state.
+     *
+     * @param nodes the nodes of the group
+     * @param p_current the current packed state
+     * @param p_next the next packed state
+     */
+    template<unsigned K>
+    void updateNodes(const std::vector<unsigned>& nodes, const uint64_t* p_current, uint64_t* p_next) const;
+
+    /**
+     * Compute the next value of a group of nodes having any number of inputs.
+     *
+     * @param nodes the nodes of the group
+     * @param p_current the current packed state
+     * @param p_next the next packed state
+     */
+    void updateNodesGeneric(const std::vector<unsigned>& nodes, const uint64_t* p_current, uint64_t* p_next) const;
+
+public:
+
+    /** Maximum number of inputs for which the table of a node fits in one word */
+    static const unsigned MAX_SINGLE_WORD_INPUTS = 6;
+
+    /** Maximum number of inputs of a node supported by this representation */
+    static const unsigned MAX_INPUTS = 24;
+
+    /**
+     * Constructor 1: it builds the truth tables from the BDD functions
+     * of a RandomBooleanNetwork. The inputs of a node are the ones given by
+     * its incoming vertices in the graph (plus, if any, the other nodes read
+     * by its function).
+     *
+     * @param network the boolean network
+     */
+    TruthTableNetwork(const RandomBooleanNetwork& network);
+
+    /**
+     * Constructor 2: it builds the network from explicit inputs and truth
+     * tables. The truth table of a node with K inputs must have
+     * max(1, 2^(K-6)) words.
+     *
+     * @param inputs the inputs of every node
+     * @param truth_tables the truth tables of every node
+     */
+    TruthTableNetwork(const std::vector<std::vector<unsigned> >& inputs,
+            const std::vector<std::vector<uint64_t> >& truth_tables);
+
+    /**
+     * Compute the next state of the synchronous network.
+     *
+     * @param p_current the current packed state (getWordsPerState() words)
+     * @param p_next the next packed state (getWordsPerState() words)
+     */
+    void update(const uint64_t* p_current, uint64_t* p_next) const;
+
+    /**
+     * Evaluate the function of a node in a given state.
+     *
+     * @param node id of the node
+     * @param p_state the packed state
+     *
+     * @return the next value of the node
+     */
+    bool evaluateNode(unsigned node, const uint64_t* p_state) const;
+
+    /**
+     * @return the number of nodes of the network.
+     */
+    unsigned getNodesNumber() const;
+
+    /**
+     * @return the number of 64-bit words of a packed state.
+     */
+    unsigned getWordsPerState() const;
+
+    /**
+     * @param node id of the node
+     *
+     * @return the number of inputs of the node.
+     */
+    unsigned getInputsNumber(unsigned node) const;
+
+    /**
+     * @param node id of the node
+     *
+     * @return a pointer to the inputs of the node (getInputsNumber(node) entries).
+     */
+    const unsigned* getInputs(unsigned node) const;
+
+    /**
+     * @param node id of the node
+     *
+     * @return a pointer to the truth table of the node.
+     */
+    const uint64_t* getTruthTable(unsigned node) const;
+
+    /**
+     * @param node id of the node
+     * @param row row of the truth table (bit j is the value of the j-th input)
+     *
+     * @return the value of the truth table of the node in the given row.
+     */
+    bool getTruthTableValue(unsigned node, unsigned row) const;
+
+    /**
+     * The sensitivity of a node is the average number of inputs whose flip
+     * changes its output, over all the rows of its truth table.
+     *
+     * @param node id of the node
+     *
+     * @return the sensitivity of the node.
+     */
+    double getNodeSensitivity(unsigned node) const;
+
+    /**
+     * @param p_state the packed state
+     * @param node id of the node
+     *
+     * @return the value of the node in the state.
+     */
+    static bool getNodeValue(const uint64_t* p_state, unsigned node)
+    {
+        return (p_state[node >> 6] >> (node & 63)) & 1u;
+    }
+
+    /**
+     * Set the value of a node in a packed state.
+     *
+     * @param p_state the packed state
+     * @param node id of the node
+     * @param value the new value
+     */
+    static void setNodeValue(uint64_t* p_state, unsigned node, bool value)
+    {
+        if (value)
+        {
+            p_state[node >> 6] |= ((uint64_t) 1) << (node & 63);
+        }
+        else
+        {
+            p_state[node >> 6] &= ~(((uint64_t) 1) << (node & 63));
+        }
+    }
+};
+
+#endif /* TRUTHTABLENETWORK_HPP_ */
@@ -102,6 +102,36 @@ public:
         }
 
     }
+
+	/*
+	 * == Testing strongly connected components. ==
+	 *
+	 * EMPTYLINE
+	 */
+    void testStronglyConnectedComponents()
+    {
+    	/* We create a graph with two cycles, {0,1} and {2,3}, where
+    	 * the first one feeds the second one, plus an isolated node 4. */
+        ArrayDirectedGraph graph(5);
+        graph.addEdgeById(0,1);
+        graph.addEdgeById(1,0);
+        graph.addEdgeById(1,2);
+        graph.addEdgeById(2,3);
+        graph.addEdgeById(3,2);
+        graph.addEdgeById(4,4);
+
+        std::vector<unsigned> components;
+        TS_ASSERT_EQUALS(graph.getStronglyConnectedComponents(components), 3u);
+        TS_ASSERT_EQUALS(components.size(), 5u);
+
+        /* We test the members of each component and that the upstream
+         * component comes before the downstream one. */
+        TS_ASSERT_EQUALS(components[0], components[1]);
+        TS_ASSERT_EQUALS(components[2], components[3]);
+        TS_ASSERT_DIFFERS(components[0], components[4]);
+        TS_ASSERT_DIFFERS(components[2], components[4]);
+        TS_ASSERT_LESS_THAN(components[1], components[2]);
+    }
 };
 
 #endif /* TESTARRAYDIRECTEDGRAPH_HPP_ */
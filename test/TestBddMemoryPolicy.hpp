@@ -0,0 +1,142 @@
+#ifndef TESTBDDMEMORYPOLICY_HPP_
+#define TESTBDDMEMORYPOLICY_HPP_
+
+/*
+ * = Testing the class {{{BddMemoryPolicy}}} =
+ *
+ * == Introduction ==
+ *
+ * EMPTYLINE
+ *
+ * This class is used to test that the class {{{BddMemoryPolicy}}}, which
+ * sizes the node table of Buddy, adapts its growth and caps its memory,
+ * is implemented correctly.
+ *
+ * == Including header files ==
+ * We begin by including the necessary header files.
+*/
+
+#include <cxxtest/TestSuite.h>
+
+#include "RandomBooleanNetwork.hpp"
+#include "BddMemoryPolicy.hpp"
+
+/* The next header includes the Buddy library. */
+#include <bdd.h>
+//This test is always run sequentially (never in parallel)
+#include "FakePetscSetup.hpp"
+
+class TestBddMemoryPolicy : public CxxTest::TestSuite
+{
+public:
+
+	/*
+	 * == Estimate and growth policy ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * The estimated table grows with the network and is never smaller than
+	 * the table used by the tests. Frequent garbage collections make the
+	 * table grow faster; rare ones restore the defaults of Buddy.
+	 */
+    void testEstimateAndGrowth() throw (Exception)
+    {
+        TS_ASSERT_EQUALS(BddMemoryPolicy::estimateNodesNumber(1, 1), BddMemoryPolicy::MINIMUM_NODES);
+        TS_ASSERT_LESS_THAN(BddMemoryPolicy::estimateNodesNumber(1000, 8000),
+                BddMemoryPolicy::estimateNodesNumber(1000, 64000));
+        TS_ASSERT_LESS_THAN(BddMemoryPolicy::estimateNodesNumber(1000, 8000),
+                BddMemoryPolicy::estimateNodesNumber(2000, 8000));
+
+        TS_ASSERT_EQUALS(BddMemoryPolicy::getMaxIncrease(), BddMemoryPolicy::DEFAULT_MAX_INCREASE);
+        TS_ASSERT_EQUALS(BddMemoryPolicy::getMinFreeNodes(), BddMemoryPolicy::DEFAULT_MIN_FREE_NODES);
+        for (unsigned i=0; i<3; i++)
+        {
+            BddMemoryPolicy::adaptGrowth(0.5);
+        }
+        TS_ASSERT_EQUALS(BddMemoryPolicy::getMaxIncrease(), 8 * BddMemoryPolicy::DEFAULT_MAX_INCREASE);
+        TS_ASSERT_EQUALS(BddMemoryPolicy::getMinFreeNodes(), BddMemoryPolicy::DEFAULT_MIN_FREE_NODES + 30);
+
+        /* A moderate fraction keeps the policy. */
+        BddMemoryPolicy::adaptGrowth(0.1);
+        TS_ASSERT_EQUALS(BddMemoryPolicy::getMaxIncrease(), 8 * BddMemoryPolicy::DEFAULT_MAX_INCREASE);
+        for (unsigned i=0; i<5; i++)
+        {
+            BddMemoryPolicy::adaptGrowth(0.0);
+        }
+        TS_ASSERT_EQUALS(BddMemoryPolicy::getMaxIncrease(), BddMemoryPolicy::DEFAULT_MAX_INCREASE);
+        TS_ASSERT_EQUALS(BddMemoryPolicy::getMinFreeNodes(), BddMemoryPolicy::DEFAULT_MIN_FREE_NODES);
+
+        TS_ASSERT_THROWS_THIS(BddMemoryPolicy::setCacheRatio(0), "The cache ratio must be > 0.");
+    }
+
+	/*
+	 * == Automatic initialisation ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * A network can be built without calling {{{bdd_init}}}: Buddy is
+	 * initialised with a table sized from the network.
+	 */
+    void testAutomaticInitialisation() throw (Exception)
+    {
+        TS_ASSERT(!bdd_isrunning());
+        try
+        {
+            RandomBooleanNetwork rbn("projects/CoGNaC/networks_samples/mammalian.cnet");
+            TS_ASSERT(bdd_isrunning());
+            rbn.findAttractors();
+            TS_ASSERT(rbn.isAttractorSearchComplete());
+            TS_ASSERT_EQUALS(rbn.getAttractorsNumber(), 2u);
+        }
+        catch (Exception& e)
+        {
+            TS_FAIL(e.GetMessage());
+            bdd_done();
+        }
+        /* We release Buddy. */
+        bdd_done();
+    }
+
+	/*
+	 * == Memory limit ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * A limit smaller than the table caps it at its current size. The
+	 * attractor search does not abort when the table is full: it stops,
+	 * it is marked incomplete and it keeps only the attractors found
+	 * before the failed step. Without the limit the search completes.
+	 */
+    void testMemoryLimit() throw (Exception)
+    {
+    	/* First of all we initialise Buddy. */
+        bdd_init(1000,100);
+        try
+        {
+            RandomBooleanNetwork rbn(20, 3, false, 0.0);
+            BddMemoryPolicy::setMemoryLimit(1);
+            TS_ASSERT_EQUALS(BddMemoryPolicy::getMemoryLimit(), 1u);
+            rbn.findAttractors();
+            TS_ASSERT(BddMemoryPolicy::isNodesLimitReached());
+            TS_ASSERT(!rbn.isAttractorSearchComplete());
+            TS_ASSERT_THROWS_THIS(rbn.getAttractorMatrix(), "The attractor search is incomplete.");
+            unsigned partial_attractors_number = rbn.getAttractorsNumber();
+
+            BddMemoryPolicy::setMemoryLimit(0);
+            rbn.findAttractors();
+            TS_ASSERT(!BddMemoryPolicy::isNodesLimitReached());
+            TS_ASSERT(rbn.isAttractorSearchComplete());
+            TS_ASSERT_LESS_THAN_EQUALS(partial_attractors_number, rbn.getAttractorsNumber());
+        }
+        catch (Exception& e)
+        {
+            TS_FAIL(e.GetMessage());
+            bdd_done();
+        }
+        BddMemoryPolicy::setMemoryLimit(0);
+        /* We release Buddy. */
+        bdd_done();
+    }
+};
+
+#endif /* TESTBDDMEMORYPOLICY_HPP_ */
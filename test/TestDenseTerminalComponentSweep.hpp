@@ -0,0 +1,170 @@
+#ifndef TESTDENSETERMINALCOMPONENTSWEEP_HPP_
+#define TESTDENSETERMINALCOMPONENTSWEEP_HPP_
+
+/*
+ * = Testing the class {{{DenseTerminalComponentSweep}}} =
+ *
+ * == Introduction ==
+ *
+ * EMPTYLINE
+ *
+ * This class is used to test that the class {{{DenseTerminalComponentSweep}}},
+ * which finds the terminal components of the pruned matrices of a small
+ * ATN on a dense matrix, gives the same results as the sparse
+ * {{{TerminalComponentSweep}}}.
+ *
+ * == Including header files ==
+ * We begin by including the necessary header files.
+*/
+
+#include <cxxtest/TestSuite.h>
+
+#include <vector>
+#include <map>
+#include <set>
+
+#include "DenseTerminalComponentSweep.hpp"
+#include "TerminalComponentSweep.hpp"
+#include "StochasticMatrix.hpp"
+#include "RandomNumberGenerator.hpp"
+
+class TestDenseTerminalComponentSweep : public CxxTest::TestSuite
+{
+public:
+
+	/*
+	 * == A small matrix ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * The matrix has the terminal components {0,1} and {2}; 3 goes to
+	 * both. Pruning at 0.25 splits {0,1}, since 1 -> 0 has weight 0.2, and
+	 * pruning at 0.5 leaves row 3 empty.
+	 */
+    void testSmallMatrix()
+    {
+        std::vector<std::map<unsigned,double> > rows(4);
+        rows[0][0] = 0.6;
+        rows[0][1] = 0.4;
+        rows[1][0] = 0.2;
+        rows[1][1] = 0.8;
+        rows[2][2] = 1.0;
+        rows[3][0] = 0.5;
+        rows[3][2] = 0.5;
+        StochasticMatrix matrix(rows);
+
+        DenseTerminalComponentSweep sweep(matrix);
+        TS_ASSERT_EQUALS(sweep.getTerminalComponentsNumber(), 2u);
+        TS_ASSERT_EQUALS(sweep.getTerminalNodesNumber(), 3u);
+        TS_ASSERT(!sweep.hasEmptyRow());
+        std::set<unsigned> component;
+        component.insert(0);
+        component.insert(1);
+        TS_ASSERT_EQUALS(sweep.getTerminalComponentSets().count(component), 1u);
+
+        TS_ASSERT_EQUALS(sweep.removeEdges(0.25), 1u);
+        TS_ASSERT_EQUALS(sweep.getTerminalChangesNumber(), 1u);
+        TS_ASSERT_EQUALS(sweep.getTerminalComponentsNumber(), 2u);
+        TS_ASSERT_EQUALS(sweep.getTerminalNodesNumber(), 2u);
+        TS_ASSERT_EQUALS(sweep.removeEdges(0.25), 0u);
+
+        sweep.removeEdges(0.5);
+        TS_ASSERT(sweep.hasEmptyRow());
+    }
+
+	/*
+	 * == Random matrices ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * On random matrices, after every threshold the dense sweep must give
+	 * the terminal components, the empty rows and the terminal changes of
+	 * {{{TerminalComponentSweep}}}. The sizes go past 64 and 128 nodes, so
+	 * the rows of bits take more than one word. Some entries are stored
+	 * with weight 0: they are edges of the whole graph, so 0 -> 1 below
+	 * leaves {1} as the only terminal component until the threshold 0.
+	 */
+    void testRandomMatrices()
+    {
+        std::vector<std::map<unsigned,double> > zero_rows(2);
+        zero_rows[0][0] = 1.0;
+        zero_rows[0][1] = 0.0;
+        zero_rows[1][1] = 1.0;
+        StochasticMatrix zero_matrix(zero_rows);
+        DenseTerminalComponentSweep zero_sweep(zero_matrix);
+        TerminalComponentSweep sparse_zero_sweep(2, zero_matrix.getRowOffsets(), zero_matrix.getColumns(),
+                zero_matrix.getValues());
+        TS_ASSERT_EQUALS(zero_sweep.getTerminalComponentsNumber(), 1u);
+        TS_ASSERT(zero_sweep.getTerminalComponentSets() == sparse_zero_sweep.getTerminalComponentSets());
+        TS_ASSERT_EQUALS(zero_sweep.removeEdges(0.0), 1u);
+        TS_ASSERT_EQUALS(zero_sweep.getTerminalComponentsNumber(), 2u);
+
+        RandomNumberGenerator::Instance()->Reseed(0);
+        for (unsigned graph=0; graph<40; graph++)
+        {
+            unsigned size = 1 + RandomNumberGenerator::Instance()->randMod(graph < 30 ? 30 : 150);
+            unsigned density = 1 + RandomNumberGenerator::Instance()->randMod(5);
+            std::vector<std::map<unsigned,double> > rows(size);
+            for (unsigned i=0; i<size; i++)
+            {
+                rows[i][RandomNumberGenerator::Instance()->randMod(size)] = 0.05;
+                for (unsigned j=0; j<size; j++)
+                {
+                    if (RandomNumberGenerator::Instance()->randMod(density * 3) == 0)
+                    {
+                        rows[i][j] = RandomNumberGenerator::Instance()->randMod(21) / 20.0;
+                    }
+                }
+            }
+            StochasticMatrix matrix(rows);
+            const double* p_values = matrix.getValues();
+            std::set<double> thresholds(p_values, p_values + matrix.getNonZerosNumber());
+
+            DenseTerminalComponentSweep dense_sweep(matrix);
+            TerminalComponentSweep sweep(size, matrix.getRowOffsets(), matrix.getColumns(), p_values);
+            TS_ASSERT(dense_sweep.getTerminalComponentSets() == sweep.getTerminalComponentSets());
+            for (std::set<double>::iterator it=thresholds.begin(); it!=thresholds.end(); ++it)
+            {
+                unsigned dense_changes = dense_sweep.getTerminalChangesNumber();
+                unsigned changes = sweep.getTerminalChangesNumber();
+                TS_ASSERT_EQUALS(dense_sweep.removeEdges(*it), sweep.removeEdges(*it));
+                TS_ASSERT(dense_sweep.getTerminalComponentSets() == sweep.getTerminalComponentSets());
+                TS_ASSERT_EQUALS(dense_sweep.getTerminalComponentsNumber(), sweep.getTerminalComponentSets().size());
+                TS_ASSERT_EQUALS(dense_sweep.getTerminalNodesNumber(), sweep.getTerminalNodesNumber());
+                TS_ASSERT_EQUALS(dense_sweep.hasEmptyRow(), sweep.hasEmptyRow());
+                TS_ASSERT_EQUALS(dense_sweep.getTerminalChangesNumber() == dense_changes,
+                        sweep.getTerminalChangesNumber() == changes);
+            }
+        }
+    }
+
+	/*
+	 * == Choosing the sweep ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * The dense sweep is advisable only for small matrices with enough
+	 * non-zero entries.
+	 */
+    void testIsSuitable()
+    {
+        unsigned size = DenseTerminalComponentSweep::SIZE_LIMIT;
+        std::vector<std::map<unsigned,double> > cycle(size);
+        std::vector<std::map<unsigned,double> > dense(size);
+        for (unsigned i=0; i<size; i++)
+        {
+            cycle[i][(i + 1) % size] = 1.0;
+            for (unsigned j=0; j<size; j+=2)
+            {
+                dense[i][j] = 1.0;
+            }
+        }
+        TS_ASSERT(!DenseTerminalComponentSweep::isSuitable(StochasticMatrix(cycle)));
+        TS_ASSERT(DenseTerminalComponentSweep::isSuitable(StochasticMatrix(dense)));
+
+        dense.push_back(dense[0]);
+        TS_ASSERT(!DenseTerminalComponentSweep::isSuitable(StochasticMatrix(dense)));
+    }
+};
+
+#endif /* TESTDENSETERMINALCOMPONENTSWEEP_HPP_ */
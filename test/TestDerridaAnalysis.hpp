@@ -0,0 +1,155 @@
+#ifndef TESTDERRIDAANALYSIS_HPP_
+#define TESTDERRIDAANALYSIS_HPP_
+
+/*
+ * = Testing the class {{{DerridaAnalysis}}} =
+ *
+ * == Introduction ==
+ *
+ * EMPTYLINE
+ *
+ * This class is used to test that the class {{{DerridaAnalysis}}}, which
+ * computes Derrida maps and sensitivities of Boolean networks, is
+ * implemented correctly.
+ *
+ * == Including header files ==
+ * We begin by including the necessary header files.
+*/
+
+#include <cxxtest/TestSuite.h>
+
+#include <vector>
+#include <stdint.h>
+
+#include "RandomBooleanNetwork.hpp"
+#include "TruthTableNetwork.hpp"
+#include "DerridaAnalysis.hpp"
+#include "RandomNumberGenerator.hpp"
+
+/* The next header includes the Buddy library. */
+#include <bdd.h>
+//This test is always run sequentially (never in parallel)
+#include "FakePetscSetup.hpp"
+
+class TestDerridaAnalysis : public CxxTest::TestSuite
+{
+public:
+
+	/*
+	 * == Networks with a known Derrida map ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * In a ring in which every node copies the previous one the distance
+	 * between two states never changes, so the Derrida map is the identity
+	 * and every node has sensitivity 1. If every node is constant, two
+	 * states are equal after one step and the sensitivity is 0.
+	 */
+    void testKnownNetworks() throw (Exception)
+    {
+        unsigned nodes_number = 100;
+        std::vector<std::vector<unsigned> > inputs(nodes_number);
+        std::vector<std::vector<uint64_t> > copy_tables(nodes_number, std::vector<uint64_t>(1, 0x2));
+        std::vector<std::vector<uint64_t> > constant_tables(nodes_number, std::vector<uint64_t>(1, 0x1));
+        for (unsigned node=0; node<nodes_number; node++)
+        {
+            inputs[node].push_back((node + 1) % nodes_number);
+        }
+
+        TruthTableNetwork ring(inputs, copy_tables);
+        DerridaAnalysis ring_analysis(ring);
+        ring_analysis.computeDerridaCurve(nodes_number, 1000, 17);
+        TS_ASSERT_EQUALS(ring_analysis.getDerridaCurve().size(), nodes_number + 1);
+        for (unsigned distance=0; distance<=nodes_number; distance++)
+        {
+            TS_ASSERT_DELTA(ring_analysis.getDerridaCurve()[distance], (double) distance, 1e-12);
+        }
+        TS_ASSERT_DELTA(ring_analysis.computeAverageSensitivity(), 1.0, 1e-12);
+
+        std::vector<std::vector<unsigned> > no_inputs(nodes_number);
+        TruthTableNetwork constant(no_inputs, constant_tables);
+        DerridaAnalysis constant_analysis(constant);
+        constant_analysis.computeDerridaCurve(10, 100, 17);
+        TS_ASSERT_DELTA(constant_analysis.getDerridaCoefficient(), 0.0, 1e-12);
+        TS_ASSERT_DELTA(constant_analysis.computeAverageSensitivity(), 0.0, 1e-12);
+
+        TS_ASSERT_THROWS_THIS(constant_analysis.computeDerridaCurve(nodes_number + 1, 100),
+                "The maximum distance must be <= number of nodes.");
+    }
+
+	/*
+	 * == Critical random networks ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * Random functions with two inputs have expected sensitivity 1, so a
+	 * large network with K = 2 is critical. After one flip the mean distance
+	 * is the average sensitivity of the nodes reading the flipped one, so
+	 * the Derrida coefficient must be close to the average sensitivity.
+	 */
+    void testCriticalNetwork() throw (Exception)
+    {
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        p_gen->Reseed(11);
+        unsigned nodes_number = 2000;
+        std::vector<std::vector<unsigned> > inputs(nodes_number);
+        std::vector<std::vector<uint64_t> > truth_tables(nodes_number, std::vector<uint64_t>(1, 0));
+        for (unsigned node=0; node<nodes_number; node++)
+        {
+            inputs[node].push_back(p_gen->randMod(nodes_number));
+            inputs[node].push_back(p_gen->randMod(nodes_number));
+            truth_tables[node][0] = p_gen->randMod(16);
+        }
+        TruthTableNetwork network(inputs, truth_tables);
+        DerridaAnalysis analysis(network);
+        double sensitivity = analysis.computeAverageSensitivity();
+        TS_ASSERT_DELTA(sensitivity, 1.0, 0.1);
+
+        analysis.computeDerridaCurve(20, 20000, 5);
+        TS_ASSERT_DELTA(analysis.getDerridaCurve()[0], 0.0, 1e-12);
+        TS_ASSERT_DELTA(analysis.getDerridaCoefficient(), sensitivity, 0.05);
+
+        /* The same seed gives the same map. */
+        std::vector<double> curve = analysis.getDerridaCurve();
+        analysis.computeDerridaCurve(20, 20000, 5);
+        TS_ASSERT(curve == analysis.getDerridaCurve());
+    }
+
+	/*
+	 * == Networks from the generator ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * A network generated by {{{RandomBooleanNetwork}}} is converted to
+	 * truth tables and analysed; the Derrida map never exceeds the number
+	 * of nodes.
+	 */
+    void testGeneratedNetwork() throw (Exception)
+    {
+    	/* First of all we initialise Buddy. */
+        bdd_init(10000,1000);
+        try
+        {
+            RandomNumberGenerator::Instance()->Reseed(0);
+            RandomBooleanNetwork rbn(20, 2, false, 0.0);
+            TruthTableNetwork network(rbn);
+            DerridaAnalysis analysis(network);
+            analysis.computeDerridaCurve(20, 1000, 3);
+            TS_ASSERT_DELTA(analysis.getDerridaCurve()[0], 0.0, 1e-12);
+            for (unsigned distance=0; distance<=20; distance++)
+            {
+                TS_ASSERT_LESS_THAN_EQUALS(analysis.getDerridaCurve()[distance], 20.0);
+            }
+            TS_ASSERT_LESS_THAN_EQUALS(0.0, analysis.computeAverageSensitivity());
+        }
+        catch (Exception& e)
+        {
+            TS_FAIL(e.GetMessage());
+            bdd_done();
+        }
+        /* We release Buddy. */
+        bdd_done();
+    }
+};
+
+#endif /* TESTDERRIDAANALYSIS_HPP_ */
@@ -0,0 +1,154 @@
+#ifndef TESTINSTRUMENTATION_HPP_
+#define TESTINSTRUMENTATION_HPP_
+
+/*
+ * = Testing the class {{{Instrumentation}}} =
+ *
+ * == Introduction ==
+ *
+ * EMPTYLINE
+ *
+ * This class is used to test that the class {{{Instrumentation}}}, which
+ * collects timings, counters and BDD statistics per phase, is implemented
+ * correctly.
+ *
+ * == Including header files ==
+ * We begin by including the necessary header files.
+*/
+
+#include <cxxtest/TestSuite.h>
+
+#include <string>
+#include <fstream>
+#include <sstream>
+
+#include "RandomBooleanNetwork.hpp"
+#include "Instrumentation.hpp"
+#include "OutputFileHandler.hpp"
+
+/* The next header includes the Buddy library. */
+#include <bdd.h>
+//This test is always run sequentially (never in parallel)
+#include "FakePetscSetup.hpp"
+
+class TestInstrumentation : public CxxTest::TestSuite
+{
+public:
+
+	/*
+	 * == Phases and counters ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * Nothing is recorded while the instrumentation is disabled. Nested
+	 * phases are included in the enclosing ones, and a phase run twice is
+	 * aggregated in a single entry.
+	 */
+    void testPhasesAndCounters() throw (Exception)
+    {
+        Instrumentation::reset();
+        {
+            ScopedPhase phase("disabled");
+            Instrumentation::increment(Instrumentation::IMAGES);
+        }
+        TS_ASSERT(Instrumentation::getPhases().empty());
+
+        Instrumentation::enable();
+        for (unsigned i=0; i<2; i++)
+        {
+            ScopedPhase outer("outer");
+            Instrumentation::increment(Instrumentation::IMAGES, 3);
+            {
+                ScopedPhase inner("inner");
+                Instrumentation::increment(Instrumentation::LINEAR_SOLVES);
+            }
+        }
+        Instrumentation::disable();
+
+        TS_ASSERT_EQUALS(Instrumentation::getPhases().size(), 2u);
+        TS_ASSERT(Instrumentation::getPhase("disabled") == NULL);
+        const PhaseStatistics* p_outer = Instrumentation::getPhase("outer");
+        const PhaseStatistics* p_inner = Instrumentation::getPhase("inner");
+        TS_ASSERT(p_outer != NULL && p_inner != NULL);
+        TS_ASSERT_EQUALS(p_outer->calls, 2u);
+        TS_ASSERT_EQUALS(p_outer->counters[Instrumentation::IMAGES], 6u);
+        TS_ASSERT_EQUALS(p_outer->counters[Instrumentation::LINEAR_SOLVES], 2u);
+        TS_ASSERT_EQUALS(p_inner->counters[Instrumentation::IMAGES], 0u);
+        TS_ASSERT_EQUALS(p_inner->counters[Instrumentation::LINEAR_SOLVES], 2u);
+        TS_ASSERT_LESS_THAN_EQUALS(p_inner->seconds, p_outer->seconds);
+
+        std::stringstream json;
+        Instrumentation::writeJson(json);
+        TS_ASSERT(json.str().find("\"name\": \"outer\", \"calls\": 2") != std::string::npos);
+        TS_ASSERT(json.str().find("\"linear_solves\": 2") != std::string::npos);
+
+        /* Every call is an event of the trace. */
+        std::stringstream trace;
+        Instrumentation::writeChromeTrace(trace);
+        unsigned events = 0;
+        for (size_t position = trace.str().find("\"ph\": \"X\""); position != std::string::npos;
+                position = trace.str().find("\"ph\": \"X\"", position + 1))
+        {
+            events++;
+        }
+        TS_ASSERT_EQUALS(events, 4u);
+
+        /* The times are written with 17 digits, but the precision of the
+         * stream is restored. */
+        TS_ASSERT_EQUALS(trace.precision(), 6);
+        TS_ASSERT_EQUALS(json.precision(), 6);
+
+        Instrumentation::reset();
+        TS_ASSERT(Instrumentation::getPhases().empty());
+    }
+
+	/*
+	 * == Instrumenting the attractor search ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * The attractors and the ATN of 'fission_yeast.net' are computed with
+	 * the instrumentation enabled; the search needs preimages and the ATN
+	 * needs images, and the BDD nodes produced are recorded.
+	 */
+    void testAttractorSearch() throw (Exception)
+    {
+    	/* First of all we initialise Buddy. */
+        bdd_init(10000,1000);
+        try
+        {
+            Instrumentation::reset();
+            Instrumentation::enable();
+            RandomBooleanNetwork rbn("projects/CoGNaC/networks_samples/fission_yeast.net");
+            rbn.findAttractors();
+            rbn.getAttractorMatrix();
+            Instrumentation::disable();
+
+            const PhaseStatistics* p_search = Instrumentation::getPhase("findAttractors");
+            const PhaseStatistics* p_matrix = Instrumentation::getPhase("getAttractorMatrix");
+            TS_ASSERT(p_search != NULL && p_matrix != NULL);
+            TS_ASSERT_EQUALS(p_search->calls, 1u);
+            TS_ASSERT_LESS_THAN(0u, p_search->counters[Instrumentation::PREIMAGES]);
+            TS_ASSERT_LESS_THAN(0u, p_matrix->counters[Instrumentation::IMAGES]);
+            TS_ASSERT_LESS_THAN_EQUALS(0, p_search->bddNodesProduced);
+
+            Instrumentation::printJsonToFile("CoGNaC", "fission_yeast_phases.json");
+            Instrumentation::printChromeTraceToFile("CoGNaC", "fission_yeast_trace.json");
+            OutputFileHandler handler("CoGNaC", false);
+            std::ifstream file((handler.GetOutputDirectoryFullPath() + "fission_yeast_trace.json").c_str());
+            std::string line;
+            TS_ASSERT(std::getline(file, line));
+            TS_ASSERT_EQUALS(line.find("{\"displayTimeUnit\""), 0u);
+            Instrumentation::reset();
+        }
+        catch (Exception& e)
+        {
+            TS_FAIL(e.GetMessage());
+            bdd_done();
+        }
+        /* We release Buddy. */
+        bdd_done();
+    }
+};
+
+#endif /* TESTINSTRUMENTATION_HPP_ */
@@ -0,0 +1,202 @@
+#ifndef TESTMEMORYBUDGETSUPERVISOR_HPP_
+#define TESTMEMORYBUDGETSUPERVISOR_HPP_
+
+/*
+ * = Testing the class {{{MemoryBudgetSupervisor}}} =
+ *
+ * == Introduction ==
+ *
+ * EMPTYLINE
+ *
+ * This class is used to test that the class {{{MemoryBudgetSupervisor}}},
+ * which falls back to the explicit engines when the BDD node table exceeds
+ * a memory budget, is implemented correctly.
+ *
+ * == Including header files ==
+ * We begin by including the necessary header files.
+*/
+
+#include <cxxtest/TestSuite.h>
+
+#include <vector>
+#include <map>
+#include <set>
+#include <cmath>
+
+#include "RandomBooleanNetwork.hpp"
+#include "TruthTableNetwork.hpp"
+#include "MemoryBudgetSupervisor.hpp"
+#include "BddMemoryPolicy.hpp"
+
+/* The next header includes the Buddy library. */
+#include <bdd.h>
+//This test is always run sequentially (never in parallel)
+#include "FakePetscSetup.hpp"
+
+class TestMemoryBudgetSupervisor : public CxxTest::TestSuite
+{
+public:
+
+	/*
+	 * == Symbolic engine ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * Without a budget the symbolic engine gives all the attractors of
+	 * 'mammalian.cnet' and its ATN.
+	 */
+    void testSymbolicEngine() throw (Exception)
+    {
+    	/* First of all we initialise Buddy. */
+        bdd_init(10000,1000);
+        try
+        {
+            RandomBooleanNetwork rbn("projects/CoGNaC/networks_samples/mammalian.cnet");
+            MemoryBudgetSupervisor supervisor(rbn, 0);
+            SupervisedAnalysisResult result = supervisor.run();
+            TS_ASSERT(result.complete);
+            TS_ASSERT_EQUALS(result.attractorEngine, SYMBOLIC_ENGINE);
+            TS_ASSERT_EQUALS(result.attractorMatrixEngine, SYMBOLIC_ENGINE);
+            TS_ASSERT_EQUALS(result.symbolicAttractorsNumber, 2u);
+            TS_ASSERT(result.attractorLength == rbn.getAttractorLength());
+            for (unsigned i=0; i<result.attractorStates.size(); i++)
+            {
+                TS_ASSERT_EQUALS(result.attractorStates[i].size(), result.attractorLength[i]);
+            }
+            TS_ASSERT(result.attractorMatrix == rbn.getAttractorMatrix());
+        }
+        catch (Exception& e)
+        {
+            TS_FAIL(e.GetMessage());
+            bdd_done();
+        }
+        /* We release Buddy. */
+        bdd_done();
+    }
+
+	/*
+	 * == Explicit ATN ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * The explicit ATN of the attractors of 'fission_yeast.net' must be the
+	 * symbolic one. If only the first attractor is given, the others are
+	 * appended when they are reached by a flip.
+	 */
+    void testExplicitAttractorMatrix() throw (Exception)
+    {
+    	/* First of all we initialise Buddy. */
+        bdd_init(10000,1000);
+        try
+        {
+            RandomBooleanNetwork rbn("projects/CoGNaC/networks_samples/fission_yeast.net");
+            rbn.findAttractors();
+            std::vector<std::map<unsigned,double> > symbolic_matrix = rbn.getAttractorMatrix();
+
+            TruthTableNetwork network(rbn);
+            std::vector<std::vector<uint64_t> > attractor_states;
+            std::vector<unsigned> attractor_length = rbn.getAttractorLength();
+            for (unsigned i=0; i<rbn.getAttractorsNumber(); i++)
+            {
+                attractor_states.push_back(rbn.getAttractorStates(i));
+            }
+            std::vector<std::map<unsigned,double> > explicit_matrix =
+                    MemoryBudgetSupervisor::getExplicitAttractorMatrix(network, attractor_states, attractor_length, 1000);
+            TS_ASSERT_EQUALS(explicit_matrix.size(), symbolic_matrix.size());
+            for (unsigned i=0; i<symbolic_matrix.size(); i++)
+            {
+                TS_ASSERT_EQUALS(explicit_matrix[i].size(), symbolic_matrix[i].size());
+                for (std::map<unsigned,double>::iterator it=symbolic_matrix[i].begin(); it!=symbolic_matrix[i].end(); ++it)
+                {
+                    TS_ASSERT_DELTA(explicit_matrix[i][it->first], it->second, 1e-12);
+                }
+            }
+
+            attractor_states.resize(1);
+            attractor_length.resize(1);
+            explicit_matrix = MemoryBudgetSupervisor::getExplicitAttractorMatrix(network, attractor_states,
+                    attractor_length, 1000);
+            TS_ASSERT_LESS_THAN(1u, attractor_states.size());
+            TS_ASSERT_EQUALS(explicit_matrix.size(), attractor_states.size());
+            for (unsigned i=0; i<explicit_matrix.size(); i++)
+            {
+                double row_sum = 0.0;
+                for (std::map<unsigned,double>::iterator it=explicit_matrix[i].begin(); it!=explicit_matrix[i].end(); ++it)
+                {
+                    TS_ASSERT_LESS_THAN(it->first, explicit_matrix.size());
+                    row_sum += it->second;
+                }
+                TS_ASSERT_DELTA(row_sum, 1.0, 1e-12);
+            }
+        }
+        catch (Exception& e)
+        {
+            TS_FAIL(e.GetMessage());
+            bdd_done();
+        }
+        /* We release Buddy. */
+        bdd_done();
+    }
+
+	/*
+	 * == Fallback to the explicit engines ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * With a budget smaller than the node table the symbolic search stops.
+	 * The attractors found are kept, the others are sampled, and they are
+	 * all attractors of the network. The previous memory limit is restored.
+	 */
+    void testFallback() throw (Exception)
+    {
+    	/* First of all we initialise Buddy. */
+        bdd_init(1000,100);
+        try
+        {
+            RandomBooleanNetwork rbn(20, 3, false, 0.0);
+            MemoryBudgetSupervisor supervisor(rbn, 1);
+            supervisor.setSamplingOptions(2000, 100000, 7);
+            SupervisedAnalysisResult result = supervisor.run();
+            TS_ASSERT_EQUALS(BddMemoryPolicy::getMemoryLimit(), 0u);
+            TS_ASSERT(!result.complete);
+            TS_ASSERT_EQUALS(result.attractorEngine, EXPLICIT_ENGINE);
+            TS_ASSERT_EQUALS(result.attractorMatrixEngine, EXPLICIT_ENGINE);
+            TS_ASSERT_LESS_THAN(0u, result.attractorStates.size());
+            TS_ASSERT_EQUALS(result.attractorMatrix.size(), result.attractorStates.size());
+
+            /* Every attractor state is a state of an attractor of the full search. */
+            rbn.findAttractors();
+            TS_ASSERT(rbn.isAttractorSearchComplete());
+            std::set<std::vector<uint64_t> > all_states;
+            for (unsigned i=0; i<rbn.getAttractorsNumber(); i++)
+            {
+                std::vector<uint64_t> states = rbn.getAttractorStates(i);
+                for (unsigned s=0; s<states.size(); s++)
+                {
+                    all_states.insert(std::vector<uint64_t>(1, states[s]));
+                }
+            }
+            for (unsigned i=0; i<result.attractorStates.size(); i++)
+            {
+                TS_ASSERT_EQUALS(result.attractorStates[i].size(), result.attractorLength[i]);
+                for (unsigned s=0; s<result.attractorStates[i].size(); s++)
+                {
+                    TS_ASSERT(all_states.count(std::vector<uint64_t>(1, result.attractorStates[i][s])) == 1);
+                }
+            }
+            TS_ASSERT_LESS_THAN_EQUALS(result.attractorStates.size(), rbn.getAttractorsNumber());
+
+            TS_ASSERT_THROWS_THIS(supervisor.setSamplingOptions(0, 10),
+                    "The number of samples and the maximum number of steps must be greater than 0.");
+        }
+        catch (Exception& e)
+        {
+            TS_FAIL(e.GetMessage());
+            bdd_done();
+        }
+        /* We release Buddy. */
+        bdd_done();
+    }
+};
+
+#endif /* TESTMEMORYBUDGETSUPERVISOR_HPP_ */
@@ -0,0 +1,194 @@
+#ifndef TESTPERTURBATIONSCREEN_HPP_
+#define TESTPERTURBATIONSCREEN_HPP_
+
+/*
+ * = Testing the class {{{PerturbationScreen}}} =
+ *
+ * == Introduction ==
+ *
+ * EMPTYLINE
+ *
+ * This class is used to test that the class {{{PerturbationScreen}}}, which
+ * computes the attractors of knockout and over-expression mutants, is
+ * implemented correctly.
+ *
+ * == Including header files ==
+ * We begin by including the necessary header files.
+*/
+
+#include <cxxtest/TestSuite.h>
+
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <fstream>
+#include <stdint.h>
+
+#include "RandomBooleanNetwork.hpp"
+#include "TruthTableNetwork.hpp"
+#include "PerturbationScreen.hpp"
+#include "OutputFileHandler.hpp"
+
+/* The next header includes the Buddy library. */
+#include <bdd.h>
+//This test is always run sequentially (never in parallel)
+#include "FakePetscSetup.hpp"
+
+class TestPerturbationScreen : public CxxTest::TestSuite
+{
+private:
+
+    /*
+     * This method computes, by exhaustive simulation, the sorted lengths
+     * of the attractors of a network with less than 64 nodes in which some
+     * nodes are clamped.
+     */
+    std::multiset<unsigned> getClampedAttractorLengths(const TruthTableNetwork& rNetwork,
+            const std::vector<std::pair<unsigned,bool> >& rClampedNodes)
+    {
+        unsigned nodes_number = rNetwork.getNodesNumber();
+        std::vector<std::vector<unsigned> > inputs(nodes_number);
+        std::vector<std::vector<uint64_t> > truth_tables(nodes_number);
+        for (unsigned node=0; node<nodes_number; node++)
+        {
+            unsigned inputs_number = rNetwork.getInputsNumber(node);
+            inputs[node].assign(rNetwork.getInputs(node), rNetwork.getInputs(node) + inputs_number);
+            unsigned words = inputs_number > 6 ? 1u << (inputs_number - 6) : 1u;
+            truth_tables[node].assign(rNetwork.getTruthTable(node), rNetwork.getTruthTable(node) + words);
+        }
+        for (unsigned i=0; i<rClampedNodes.size(); i++)
+        {
+            inputs[rClampedNodes[i].first].clear();
+            truth_tables[rClampedNodes[i].first].assign(1, rClampedNodes[i].second ? 1u : 0u);
+        }
+        TruthTableNetwork mutant(inputs, truth_tables);
+
+        std::set<uint64_t> minimal_states;
+        std::multiset<unsigned> lengths;
+        for (uint64_t state=0; state<(((uint64_t) 1) << nodes_number); state++)
+        {
+            uint64_t current = state;
+            uint64_t next = 0;
+            for (unsigned step=0; step<(1u << nodes_number); step++)
+            {
+                mutant.update(&current, &next);
+                current = next;
+            }
+            /* Now the state is in the attractor: we walk the cycle once. */
+            uint64_t first_state = current;
+            uint64_t minimal_state = current;
+            unsigned length = 0;
+            do
+            {
+                mutant.update(&current, &next);
+                current = next;
+                minimal_state = std::min(minimal_state, current);
+                length++;
+            } while (current != first_state);
+            if (minimal_states.insert(minimal_state).second)
+            {
+                lengths.insert(length);
+            }
+        }
+        return lengths;
+    }
+
+public:
+
+	/*
+	 * == Single knockouts and over-expressions of 'fission_yeast.net' ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * We run all the single perturbations and we check the attractors of
+	 * every mutant against an exhaustive simulation of the mutant. The
+	 * wild-type attractors upstream of the clamped node must be reused.
+	 */
+    void testSinglePerturbations() throw (Exception)
+    {
+    	/* First of all we initialise Buddy. */
+        bdd_init(10000,1000);
+        try
+        {
+            RandomBooleanNetwork rbn("projects/CoGNaC/networks_samples/fission_yeast.net");
+            PerturbationScreen screen(rbn);
+            TS_ASSERT_EQUALS(screen.getWildTypeAttractors().size(), 13u);
+
+            screen.runScreen(true, true, false);
+            TS_ASSERT_EQUALS(screen.getResults().size(), 20u);
+
+            TruthTableNetwork network(rbn);
+            bool reused = false;
+            for (unsigned i=0; i<screen.getResults().size(); i++)
+            {
+                const PerturbationResult& r_result = screen.getResults()[i];
+                std::multiset<unsigned> lengths(r_result.attractorLength.begin(), r_result.attractorLength.end());
+                TS_ASSERT(lengths == getClampedAttractorLengths(network, r_result.clampedNodes));
+                TS_ASSERT_EQUALS(r_result.attractorMatrix.size(), r_result.attractorLength.size());
+                TS_ASSERT_LESS_THAN_EQUALS(r_result.lostAttractorsNumber, 13u);
+                reused = reused || r_result.reusedModulesNumber > 0;
+            }
+            TS_ASSERT(reused);
+
+            /* The table has a header of three lines and a row per mutant. */
+            screen.printResultsToFile("CoGNaC", "fission_yeast_screen.txt");
+            OutputFileHandler handler("CoGNaC", false);
+            std::ifstream file((handler.GetOutputDirectoryFullPath() + "fission_yeast_screen.txt").c_str());
+            std::string line;
+            unsigned lines = 0;
+            while (std::getline(file, line))
+            {
+                lines++;
+            }
+            TS_ASSERT_EQUALS(lines, 23u);
+
+            std::vector<std::pair<unsigned,bool> > wrong_nodes(1, std::make_pair(10u, false));
+            TS_ASSERT_THROWS_THIS(screen.runPerturbation(wrong_nodes), "Error, node id must be < number of nodes.");
+        }
+        catch (Exception& e)
+        {
+            TS_FAIL(e.GetMessage());
+            bdd_done();
+        }
+        /* We release Buddy. */
+        bdd_done();
+    }
+
+	/*
+	 * == Double knockouts of 'mammalian.cnet' ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * A few double knockouts are checked against an exhaustive simulation.
+	 */
+    void testDoublePerturbations() throw (Exception)
+    {
+    	/* First of all we initialise Buddy. */
+        bdd_init(10000,1000);
+        try
+        {
+            RandomBooleanNetwork rbn("projects/CoGNaC/networks_samples/mammalian.cnet");
+            PerturbationScreen screen(rbn, false);
+            TruthTableNetwork network(rbn);
+            for (unsigned node=1; node<rbn.getNodesNumber(); node+=3)
+            {
+                std::vector<std::pair<unsigned,bool> > clamped_nodes;
+                clamped_nodes.push_back(std::make_pair(0u, false));
+                clamped_nodes.push_back(std::make_pair(node, false));
+                PerturbationResult result = screen.runPerturbation(clamped_nodes);
+                std::multiset<unsigned> lengths(result.attractorLength.begin(), result.attractorLength.end());
+                TS_ASSERT(lengths == getClampedAttractorLengths(network, clamped_nodes));
+                TS_ASSERT(result.attractorMatrix.empty());
+            }
+        }
+        catch (Exception& e)
+        {
+            TS_FAIL(e.GetMessage());
+            bdd_done();
+        }
+        /* We release Buddy. */
+        bdd_done();
+    }
+};
+
+#endif /* TESTPERTURBATIONSCREEN_HPP_ */
@@ -0,0 +1,177 @@
+#ifndef TESTPIPELINEBENCHMARK_HPP_
+#define TESTPIPELINEBENCHMARK_HPP_
+
+/*
+ * = Benchmark of the pipeline =
+ *
+ * == Introduction ==
+ *
+ * EMPTYLINE
+ *
+ * This class runs the whole pipeline (parse, findAttractors,
+ * getAttractorMatrix, ThresholdErgodicSetDifferentiationTree,
+ * getDifferentiationTree) on the networks in 'networks_samples' and on a
+ * grid of random networks, and saves the time, peak RSS and BDD nodes of
+ * every stage in 'testoutput/CoGNaC/pipeline_benchmark.txt', with the
+ * gene updates per second of the bit-sliced kernel for every instruction
+ * set supported by the CPU. If the
+ * environment variable COGNAC_BENCHMARK_BASELINE is the path of a file
+ * saved by a previous run, the test fails when a stage is more than 25%
+ * worse than in that file.
+ *
+ * It is not part of the continuous test pack.
+ *
+ * == Including header files ==
+ * We begin by including the necessary header files.
+*/
+
+#include <cxxtest/TestSuite.h>
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdlib>
+
+#include "PipelineBenchmark.hpp"
+#include "BitSlicedNetworkKernel.hpp"
+#include "OutputFileHandler.hpp"
+
+/* The next header includes the Buddy library. */
+#include <bdd.h>
+//This test is always run sequentially (never in parallel)
+#include "FakePetscSetup.hpp"
+
+class TestPipelineBenchmark : public CxxTest::TestSuite
+{
+public:
+
+	/*
+	 * == Comparison with a baseline ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * A run compared with its own measures has no regression; a baseline
+	 * with fewer BDD nodes flags every stage which produced nodes, and a
+	 * baseline with a higher throughput flags every kernel stage.
+	 */
+    void testCompareWithBaseline() throw (Exception)
+    {
+    	/* First of all we initialise Buddy. */
+        bdd_init(10000,1000);
+        try
+        {
+            PipelineBenchmark benchmark;
+            benchmark.runNetworkFile("projects/CoGNaC/networks_samples/fission_yeast.net");
+            const std::vector<BenchmarkMeasure>& r_measures = benchmark.getMeasures();
+            unsigned kernel_stages = 1 + BitSlicedNetworkKernel::isInstructionSetSupported(BitSlicedNetworkKernel::AVX2)
+                    + BitSlicedNetworkKernel::isInstructionSetSupported(BitSlicedNetworkKernel::AVX512);
+            TS_ASSERT_EQUALS(r_measures.size(), 5u + kernel_stages);
+            TS_ASSERT_EQUALS(r_measures[0].stage, "parse");
+            TS_ASSERT_EQUALS(r_measures[4].stage, "getDifferentiationTree");
+            TS_ASSERT_EQUALS(r_measures[5].stage, "kernel_scalar");
+            TS_ASSERT_EQUALS(r_measures[1].network, "fission_yeast.net");
+            TS_ASSERT_EQUALS(r_measures[4].geneUpdatesPerSecond, 0.0);
+            for (unsigned i=5; i<r_measures.size(); i++)
+            {
+                TS_ASSERT_LESS_THAN_EQUALS(PipelineBenchmark::KERNEL_MILLISECONDS * 1e-3, r_measures[i].seconds);
+                TS_ASSERT_LESS_THAN(0.0, r_measures[i].geneUpdatesPerSecond);
+            }
+
+            benchmark.printMeasuresToFile("CoGNaC", "fission_yeast_benchmark.txt");
+            OutputFileHandler handler("CoGNaC", false);
+            std::string baseline_path = handler.GetOutputDirectoryFullPath() + "fission_yeast_benchmark.txt";
+            TS_ASSERT(benchmark.compareWithBaseline(baseline_path, 0.0, 1e10).empty());
+
+            unsigned stages_with_nodes = 0;
+            std::ofstream baseline((handler.GetOutputDirectoryFullPath() + "small_baseline.txt").c_str());
+            for (unsigned i=0; i<r_measures.size(); i++)
+            {
+                baseline << r_measures[i].network << "\t" << r_measures[i].stage << "\t0\t"
+                        << r_measures[i].peakRss << "\t0\t0\n";
+                stages_with_nodes += r_measures[i].bddNodesProduced > 0;
+            }
+            baseline.close();
+            TS_ASSERT_EQUALS(benchmark.compareWithBaseline(handler.GetOutputDirectoryFullPath() + "small_baseline.txt",
+                    0.25, 1e10).size(), stages_with_nodes);
+
+            /* The kernel stages are long enough to compare their throughput. */
+            std::ofstream fast_baseline((handler.GetOutputDirectoryFullPath() + "fast_baseline.txt").c_str());
+            for (unsigned i=0; i<r_measures.size(); i++)
+            {
+                fast_baseline << r_measures[i].network << "\t" << r_measures[i].stage << "\t" << r_measures[i].seconds
+                        << "\t" << r_measures[i].peakRss << "\t" << r_measures[i].bddNodesProduced << "\t0\t"
+                        << r_measures[i].geneUpdatesPerSecond * 2.0 << "\n";
+            }
+            fast_baseline.close();
+            TS_ASSERT_EQUALS(benchmark.compareWithBaseline(handler.GetOutputDirectoryFullPath() + "fast_baseline.txt",
+                    0.25).size(), kernel_stages);
+
+            TS_ASSERT_THROWS_THIS(benchmark.compareWithBaseline("missing_baseline.txt", 0.25),
+                    "Not able to open the file.");
+        }
+        catch (Exception& e)
+        {
+            TS_FAIL(e.GetMessage());
+            bdd_done();
+        }
+        /* We release Buddy. */
+        bdd_done();
+    }
+
+	/*
+	 * == The benchmark ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * All the sample networks and a grid of random networks with 10 and 20
+	 * nodes, K = 2 and 3, random and scale-free topologies and no, half or
+	 * only canalyzing functions.
+	 */
+    void testPipelineBenchmark() throw (Exception)
+    {
+    	/* First of all we initialise Buddy. */
+        bdd_init(100000,10000);
+        try
+        {
+            PipelineBenchmark benchmark;
+            benchmark.runNetworkFiles("projects/CoGNaC/networks_samples");
+
+            std::vector<unsigned> nodes_numbers;
+            nodes_numbers.push_back(10);
+            nodes_numbers.push_back(20);
+            std::vector<unsigned> avarage_inputs_per_node;
+            avarage_inputs_per_node.push_back(2);
+            avarage_inputs_per_node.push_back(3);
+            std::vector<bool> scale_free;
+            scale_free.push_back(false);
+            scale_free.push_back(true);
+            std::vector<double> probabilities_canalyzing_function;
+            probabilities_canalyzing_function.push_back(0.0);
+            probabilities_canalyzing_function.push_back(0.5);
+            probabilities_canalyzing_function.push_back(1.0);
+            benchmark.runRandomNetworkGrid(nodes_numbers, avarage_inputs_per_node, scale_free,
+                    probabilities_canalyzing_function, 1);
+            benchmark.printMeasuresToFile("CoGNaC", "pipeline_benchmark.txt");
+
+            const char* p_baseline = getenv("COGNAC_BENCHMARK_BASELINE");
+            if (p_baseline != NULL)
+            {
+                std::vector<std::string> regressions = benchmark.compareWithBaseline(p_baseline, 0.25);
+                for (unsigned i=0; i<regressions.size(); i++)
+                {
+                    TS_WARN(regressions[i]);
+                }
+                TS_ASSERT(regressions.empty());
+            }
+        }
+        catch (Exception& e)
+        {
+            TS_FAIL(e.GetMessage());
+            bdd_done();
+        }
+        /* We release Buddy. */
+        bdd_done();
+    }
+};
+
+#endif /* TESTPIPELINEBENCHMARK_HPP_ */
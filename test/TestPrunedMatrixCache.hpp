@@ -0,0 +1,89 @@
+#ifndef TESTPRUNEDMATRIXCACHE_HPP_
+#define TESTPRUNEDMATRIXCACHE_HPP_
+
+/*
+ * = Testing the class {{{PrunedMatrixCache}}} =
+ *
+ * == Introduction ==
+ *
+ * EMPTYLINE
+ *
+ * This class is used to test that the class {{{PrunedMatrixCache}}},
+ * which keeps the pruned matrices of an ATN and the stationary
+ * distributions of their components by threshold, is implemented correctly.
+ *
+ * == Including header files ==
+ * We begin by including the necessary header files.
+*/
+
+#include <cxxtest/TestSuite.h>
+
+#include <vector>
+#include <map>
+
+#include "PrunedMatrixCache.hpp"
+#include "StochasticMatrix.hpp"
+#include "StationaryDistributionSolver.hpp"
+
+class TestPrunedMatrixCache : public CxxTest::TestSuite
+{
+public:
+
+	/*
+	 * == Pruned matrices and distributions ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * Every threshold is pruned once, and every component is solved once
+	 * per threshold; the cached results are the same as the ones computed
+	 * directly. At threshold 1 the matrix is not pruned.
+	 */
+    void testCache()
+    {
+        std::vector<std::map<unsigned,double> > rows(3);
+        rows[0][0] = 0.7;
+        rows[0][1] = 0.3;
+        rows[1][0] = 0.1;
+        rows[1][1] = 0.8;
+        rows[1][2] = 0.1;
+        rows[2][1] = 0.5;
+        rows[2][2] = 0.5;
+        StochasticMatrix matrix(rows);
+        StationaryDistributionSolver solver;
+        PrunedMatrixCache cache(matrix);
+
+        const StochasticMatrixView& r_view = cache.getPrunedMatrix(0.05);
+        TS_ASSERT_EQUALS(&cache.getPrunedMatrix(0.05), &r_view);
+        TS_ASSERT_EQUALS(r_view.getThreshold(), 0.05);
+        TS_ASSERT_EQUALS(cache.getPrunedMatrix(1.0).getThreshold(), -1.0);
+        TS_ASSERT_EQUALS(cache.getPrunedMatricesNumber(), 2u);
+
+        std::vector<unsigned> component;
+        component.push_back(0);
+        component.push_back(1);
+        TS_ASSERT(cache.findStationaryDistribution(0.05, component) == NULL);
+        const std::vector<double>& r_distribution = cache.getStationaryDistribution(0.05, component, solver);
+        TS_ASSERT_EQUALS(cache.findStationaryDistribution(0.05, component), &r_distribution);
+        TS_ASSERT_EQUALS(&cache.getStationaryDistribution(0.05, component, solver), &r_distribution);
+        TS_ASSERT(cache.findStationaryDistribution(0.0, component) == NULL);
+        std::vector<double> direct = solver.solve(StochasticMatrixView(matrix, 0.05), component);
+        TS_ASSERT_EQUALS(r_distribution.size(), 2u);
+        TS_ASSERT_EQUALS(r_distribution[0], direct[0]);
+        TS_ASSERT_EQUALS(r_distribution[1], direct[1]);
+        TS_ASSERT_DELTA(r_distribution[0], 0.25, 1e-12);
+        TS_ASSERT_EQUALS(cache.getStationaryDistributionsNumber(), 1u);
+
+        std::vector<double> given(1, 1.0);
+        cache.addStationaryDistribution(0.05, std::vector<unsigned>(1, 2), given);
+        TS_ASSERT_EQUALS(cache.getStationaryDistributionsNumber(), 2u);
+        cache.addStationaryDistribution(0.05, std::vector<unsigned>(1, 2), given);
+        TS_ASSERT_EQUALS(cache.getStationaryDistributionsNumber(), 2u);
+
+        cache.clear();
+        TS_ASSERT_EQUALS(cache.getPrunedMatricesNumber(), 0u);
+        TS_ASSERT_EQUALS(cache.getStationaryDistributionsNumber(), 0u);
+        TS_ASSERT(cache.findStationaryDistribution(0.05, component) == NULL);
+    }
+};
+
+#endif /* TESTPRUNEDMATRIXCACHE_HPP_ */
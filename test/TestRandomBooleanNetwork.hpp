@@ -26,6 +26,7 @@
 #include "RandomBooleanNetwork.hpp"
 #include "ThresholdErgodicSetDifferentiationTree.hpp"
 #include "DifferentiationTree.hpp"
+#include "PerturbationScreen.hpp"
 
 /* The next header includes the Buddy library. */
 #include <bdd.h>
@@ -42,6 +43,27 @@
 //This test is always run sequentially (never in parallel)
 #include "FakePetscSetup.hpp"
 
+/*
+ * A monitor of the attractor search which records the progress and stops
+ * the search at a given step (never if 0).
+ */
+class StepLimitMonitor : public AbstractAttractorSearchMonitor
+{
+public:
+    std::vector<AttractorSearchProgress> mProgress;
+    unsigned mLastStep;
+
+    StepLimitMonitor(unsigned last_step) : mLastStep(last_step)
+    {
+    }
+
+    bool reportProgress(const AttractorSearchProgress& rProgress)
+    {
+        mProgress.push_back(rProgress);
+        return mLastStep == 0 || rProgress.step < mLastStep;
+    }
+};
+
 class TestRandomBooleanNetwork : public CxxTest::TestSuite
 {
 public:
@@ -91,6 +113,338 @@ public:
         bdd_done();
     }
 
+	/*
+	 * == Finding attractors with the modular algorithm ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * We test that the modular search, which visits the strongly connected
+	 * modules of the network one at a time, finds the same attractors
+	 * of the monolithic one.
+	 */
+
+    void testFindAttractorsModular() throw (Exception)
+    {
+    	/* First of all we initialise Buddy. */
+        bdd_init(10000,1000);
+        try
+        {
+        	/* The 'fission_yeast.net' network shows 13 fixed-point attractors. */
+            RandomBooleanNetwork rbn1("projects/CoGNaC/networks_samples/fission_yeast.net");
+            rbn1.findAttractorsModular();
+            TS_ASSERT_EQUALS(rbn1.getAttractorsNumber(), 13u);
+            std::vector<unsigned> attractors_lengths = rbn1.getAttractorLength();
+            for (unsigned i=0; i<attractors_lengths.size(); i++)
+            {
+                TS_ASSERT_EQUALS(attractors_lengths.at(i), 1u);
+            }
+
+            /* On 'mammalian.cnet' we compare the lengths with the ones
+             * found by {{{findAttractors}}}. */
+            RandomBooleanNetwork rbn2("projects/CoGNaC/networks_samples/mammalian.cnet");
+            RandomBooleanNetwork rbn3("projects/CoGNaC/networks_samples/mammalian.cnet");
+            rbn2.findAttractors();
+            rbn3.findAttractorsModular();
+            TS_ASSERT_EQUALS(rbn2.getAttractorsNumber(), rbn3.getAttractorsNumber());
+            std::multiset<unsigned> lengths2, lengths3;
+            for (unsigned i=0; i<rbn2.getAttractorsNumber(); i++)
+            {
+                lengths2.insert(rbn2.getAttractorLength().at(i));
+                lengths3.insert(rbn3.getAttractorLength().at(i));
+            }
+            TS_ASSERT(lengths2 == lengths3);
+
+            /* The ATN can also be computed from the modular attractors. */
+            std::vector<std::map<unsigned,double> > matrix = rbn3.getAttractorMatrix();
+            TS_ASSERT_EQUALS(matrix.size(), rbn3.getAttractorsNumber());
+        }
+        catch (Exception& e)
+        {
+            TS_FAIL(e.GetMessage());
+            bdd_done();
+        }
+        /* We release Buddy. */
+        bdd_done();
+    }
+
+	/*
+	 * == Monitoring and stopping the attractor search ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * The monitor sees the explored fraction of the state space grow until
+	 * 1. A search stopped by the monitor keeps the attractors found so far
+	 * and is marked incomplete, so the ATN cannot be computed; a new call
+	 * restarts it and finds all the attractors. The same holds for a search
+	 * cancelled before it starts.
+	 */
+
+    void testAttractorSearchMonitor() throw (Exception)
+    {
+    	/* First of all we initialise Buddy. */
+        bdd_init(10000,1000);
+        try
+        {
+            RandomBooleanNetwork rbn("projects/CoGNaC/networks_samples/mammalian.cnet");
+            StepLimitMonitor full_monitor(0);
+            rbn.setSearchMonitor(&full_monitor);
+            rbn.findAttractors();
+            TS_ASSERT(rbn.isAttractorSearchComplete());
+            unsigned attractors_number = rbn.getAttractorsNumber();
+            TS_ASSERT_LESS_THAN(1u, full_monitor.mProgress.size());
+            TS_ASSERT_DELTA(full_monitor.mProgress[0].exploredFraction, 0.0, 1e-12);
+            for (unsigned i=1; i<full_monitor.mProgress.size(); i++)
+            {
+                TS_ASSERT_LESS_THAN_EQUALS(full_monitor.mProgress[i-1].exploredFraction,
+                        full_monitor.mProgress[i].exploredFraction);
+                TS_ASSERT_LESS_THAN_EQUALS(full_monitor.mProgress[i].exploredFraction, 1.0);
+                TS_ASSERT_EQUALS(full_monitor.mProgress[i].step, full_monitor.mProgress[i-1].step + 1);
+            }
+
+            /* The attractor of length 7 is not found before step 7. */
+            RandomBooleanNetwork stopped_rbn("projects/CoGNaC/networks_samples/mammalian.cnet");
+            StepLimitMonitor stop_monitor(3);
+            stopped_rbn.setSearchMonitor(&stop_monitor);
+            stopped_rbn.findAttractors();
+            TS_ASSERT(!stopped_rbn.isAttractorSearchComplete());
+            TS_ASSERT_EQUALS(stop_monitor.mProgress.back().step, 3u);
+            TS_ASSERT_LESS_THAN(stopped_rbn.getAttractorsNumber(), attractors_number);
+            TS_ASSERT_THROWS_THIS(stopped_rbn.getAttractorMatrix(), "The attractor search is incomplete.");
+
+            stopped_rbn.setSearchMonitor(NULL);
+            stopped_rbn.findAttractors();
+            TS_ASSERT(stopped_rbn.isAttractorSearchComplete());
+            TS_ASSERT_EQUALS(stopped_rbn.getAttractorsNumber(), attractors_number);
+            TS_ASSERT_EQUALS(stopped_rbn.getAttractorMatrix().size(), attractors_number);
+
+            /* A cancellation requested before the search is not lost. */
+            RandomBooleanNetwork cancelled_rbn("projects/CoGNaC/networks_samples/mammalian.cnet");
+            cancelled_rbn.cancelSearch();
+            cancelled_rbn.findAttractors();
+            TS_ASSERT(!cancelled_rbn.isAttractorSearchComplete());
+            TS_ASSERT_EQUALS(cancelled_rbn.getAttractorsNumber(), 0u);
+            cancelled_rbn.findAttractors();
+            TS_ASSERT(cancelled_rbn.isAttractorSearchComplete());
+            TS_ASSERT_EQUALS(cancelled_rbn.getAttractorsNumber(), attractors_number);
+
+            TS_ASSERT_THROWS_THIS(stopped_rbn.setSearchTimeLimit(-1.0), "The time limit must be >= 0.");
+        }
+        catch (Exception& e)
+        {
+            TS_FAIL(e.GetMessage());
+            bdd_done();
+        }
+        /* We release Buddy. */
+        bdd_done();
+    }
+
+	/*
+	 * == Checkpoint and resume of the attractor search ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * A search stopped at step 3 writes its state in a checkpoint. Another
+	 * object resumes it and must find the same attractors, and the same ATN,
+	 * of a search never stopped. A checkpoint cannot be resumed by a
+	 * different network.
+	 */
+
+    void testAttractorSearchCheckpoint() throw (Exception)
+    {
+    	/* First of all we initialise Buddy. */
+        bdd_init(10000,1000);
+        try
+        {
+            RandomBooleanNetwork rbn("projects/CoGNaC/networks_samples/mammalian.cnet");
+            rbn.findAttractors();
+
+            OutputFileHandler handler("CoGNaC", false);
+            std::string checkpoint_path = handler.GetOutputDirectoryFullPath() + "mammalian_checkpoint.txt";
+            RandomBooleanNetwork stopped_rbn("projects/CoGNaC/networks_samples/mammalian.cnet");
+            StepLimitMonitor stop_monitor(3);
+            stopped_rbn.setSearchMonitor(&stop_monitor);
+            stopped_rbn.setSearchCheckpoint(checkpoint_path, 0.0);
+            stopped_rbn.findAttractors();
+            TS_ASSERT(!stopped_rbn.isAttractorSearchComplete());
+
+            RandomBooleanNetwork resumed_rbn("projects/CoGNaC/networks_samples/mammalian.cnet");
+            StepLimitMonitor resumed_monitor(0);
+            resumed_rbn.setSearchMonitor(&resumed_monitor);
+            resumed_rbn.resumeAttractorSearch(checkpoint_path);
+            TS_ASSERT(resumed_rbn.isAttractorSearchComplete());
+            TS_ASSERT_EQUALS(resumed_monitor.mProgress[0].step, 3u);
+            TS_ASSERT_EQUALS(resumed_monitor.mProgress[0].attractorsNumber, stopped_rbn.getAttractorsNumber());
+            TS_ASSERT(resumed_rbn.getAttractorLength() == rbn.getAttractorLength());
+            TS_ASSERT(resumed_rbn.getAttractorMatrix() == rbn.getAttractorMatrix());
+
+            RandomBooleanNetwork other_rbn("projects/CoGNaC/networks_samples/fission_yeast.net");
+            TS_ASSERT_THROWS_THIS(other_rbn.resumeAttractorSearch(checkpoint_path),
+                    "The checkpoint does not match the network.");
+            TS_ASSERT_THROWS_THIS(rbn.resumeAttractorSearch(checkpoint_path + ".missing"),
+                    "Not able to open the file.");
+            TS_ASSERT_THROWS_THIS(rbn.setSearchCheckpoint(checkpoint_path, -1.0),
+                    "The checkpoint interval must be >= 0.");
+        }
+        catch (Exception& e)
+        {
+            TS_FAIL(e.GetMessage());
+            bdd_done();
+        }
+        /* We release Buddy. */
+        bdd_done();
+    }
+
+	/*
+	 * == Attractors for all the input combinations ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * In 'mammalian.cnet' the first node (CycD) only reads itself, so every
+	 * attractor has a constant value of it. Using it as input, the projection
+	 * on each value must give the attractors of {{{findAttractors}}} with
+	 * that value. In 'thelper.net' the inputs (nodes 1, 3, 5 and 9) are
+	 * constant, and the projections must have the same attractors of the
+	 * mutants in which the inputs are clamped to the given values.
+	 */
+
+    void testParametrisedAttractors() throw (Exception)
+    {
+    	/* First of all we initialise Buddy. */
+        bdd_init(10000,1000);
+        try
+        {
+            RandomBooleanNetwork rbn1("projects/CoGNaC/networks_samples/mammalian.cnet");
+            rbn1.findAttractors();
+            std::vector<unsigned> input_nodes(1, 0u);
+            rbn1.findParametrisedAttractors(input_nodes);
+            unsigned projected_attractors = 0;
+            for (unsigned value=0; value<2; value++)
+            {
+                std::vector<unsigned> lengths;
+                std::vector<bdd> attractors = rbn1.getAttractorsForInputs(std::vector<bool>(1, value == 1), lengths);
+                projected_attractors += attractors.size();
+                for (unsigned i=0; i<attractors.size(); i++)
+                {
+                    TS_ASSERT(attractors[i] != bddfalse);
+                    TS_ASSERT((attractors[i] & (value == 1 ? bdd_nithvar(0) : bdd_ithvar(0))) == bddfalse);
+                }
+            }
+            TS_ASSERT_EQUALS(projected_attractors, rbn1.getAttractorsNumber());
+
+            RandomBooleanNetwork rbn2("projects/CoGNaC/networks_samples/thelper.net");
+            PerturbationScreen screen(rbn2, false);
+            std::vector<unsigned> thelper_inputs;
+            thelper_inputs.push_back(0);
+            thelper_inputs.push_back(2);
+            thelper_inputs.push_back(4);
+            thelper_inputs.push_back(8);
+            rbn2.findParametrisedAttractors(thelper_inputs);
+            /* Every input combination has at least an attractor. */
+            bdd covered_inputs = bddfalse;
+            for (unsigned i=0; i<rbn2.getParametrisedAttractorsNumber(); i++)
+            {
+                covered_inputs |= rbn2.getParametrisedAttractorInputs(i);
+            }
+            TS_ASSERT(covered_inputs == bddtrue);
+            for (unsigned combination=0; combination<16; combination++)
+            {
+                std::vector<bool> input_values;
+                std::vector<std::pair<unsigned,bool> > clamped_nodes;
+                for (unsigned i=0; i<4; i++)
+                {
+                    input_values.push_back((combination >> i) & 1u);
+                    clamped_nodes.push_back(std::make_pair(thelper_inputs[i], (bool) ((combination >> i) & 1u)));
+                }
+                std::vector<unsigned> lengths;
+                rbn2.getAttractorsForInputs(input_values, lengths);
+                PerturbationResult mutant = screen.runPerturbation(clamped_nodes);
+                std::multiset<unsigned> lengths1(lengths.begin(), lengths.end());
+                std::multiset<unsigned> lengths2(mutant.attractorLength.begin(), mutant.attractorLength.end());
+                TS_ASSERT(lengths1 == lengths2);
+            }
+
+            std::vector<unsigned> lengths;
+            TS_ASSERT_THROWS_THIS(rbn2.getAttractorsForInputs(std::vector<bool>(3, false), lengths),
+                    "A value must be given for every input node.");
+        }
+        catch (Exception& e)
+        {
+            TS_FAIL(e.GetMessage());
+            bdd_done();
+        }
+        /* We release Buddy. */
+        bdd_done();
+    }
+
+	/*
+	 * == Simulating trajectories from explicit states ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * We simulate all the 1024 states of 'fission_yeast.net' in batches of
+	 * 100 trajectories. After 20 steps every trajectory is in one of the 13
+	 * fixed points, so the recorded states of the last two steps are equal.
+	 * With noise, two runs with the same seed give the same trajectories.
+	 */
+
+    void testSimulate() throw (Exception)
+    {
+    	/* First of all we initialise Buddy. */
+        bdd_init(10000,1000);
+        try
+        {
+            RandomBooleanNetwork rbn("projects/CoGNaC/networks_samples/fission_yeast.net");
+            std::vector<uint64_t> states(1024);
+            for (unsigned i=0; i<states.size(); i++)
+            {
+                states[i] = i;
+            }
+
+            SimulationOptions options;
+            options.batchSize = 100;
+            options.recordInterval = 1;
+            std::vector<uint64_t> records(rbn.getRecordBufferSize(1024, 20, 1));
+            TS_ASSERT_EQUALS(records.size(), 20u * 1024u);
+            options.pRecordBuffer = &records[0];
+            options.recordBufferSize = records.size();
+            rbn.simulate(states, 20, options);
+
+            std::set<uint64_t> final_states(states.begin(), states.end());
+            TS_ASSERT_EQUALS(final_states.size(), 13u);
+            for (unsigned i=0; i<1024; i++)
+            {
+                TS_ASSERT_EQUALS(records[18 * 1024 + i], states[i]);
+                TS_ASSERT_EQUALS(records[19 * 1024 + i], states[i]);
+            }
+
+            /* A fixed point is left only because of the noise. */
+            std::vector<uint64_t> noisy_states1(1000, *final_states.begin());
+            std::vector<uint64_t> noisy_states2(noisy_states1);
+            SimulationOptions noise_options;
+            noise_options.noiseProbability = 0.05;
+            noise_options.seed = 42;
+            rbn.simulate(noisy_states1, 5, noise_options);
+            rbn.simulate(noisy_states2, 5, noise_options);
+            TS_ASSERT(noisy_states1 == noisy_states2);
+            TS_ASSERT(noisy_states1 != std::vector<uint64_t>(1000, *final_states.begin()));
+            for (unsigned i=0; i<noisy_states1.size(); i++)
+            {
+                TS_ASSERT(noisy_states1[i] < 1024u);
+            }
+
+            /* A record buffer too small is refused. */
+            options.recordBufferSize = 10;
+            TS_ASSERT_THROWS_THIS(rbn.simulate(states, 20, options), "The record buffer is too small.");
+        }
+        catch (Exception& e)
+        {
+            TS_FAIL(e.GetMessage());
+            bdd_done();
+        }
+        /* We release Buddy. */
+        bdd_done();
+    }
+
 	/*
 	 * == Testing input and output in {{{RandomBooleanNetwork}}} object ==
 	 *
@@ -243,6 +597,56 @@ public:
         TS_ASSERT_EQUALS(level_nodes.at(1).size(), 2u);
         TS_ASSERT_EQUALS(level_nodes.at(2).size(), 2u);
         TS_ASSERT_EQUALS(level_nodes.at(3).size(), 2u);
+
+        /* The same tree is obtained if the object takes the stochastic matrix. */
+        StochasticMatrix matrix(TES_tree.getStochasticMatrix().getMapMatrix());
+        ThresholdErgodicSetDifferentiationTree TES_tree_from_matrix(matrix, TES_tree.getAttractorLength());
+        TS_ASSERT_EQUALS(matrix.getSize(), 0u);
+        DifferentiationTree* diff_tree_from_matrix = TES_tree_from_matrix.getDifferentiationTree();
+        TS_ASSERT_EQUALS(diff_tree_from_matrix->size(), 7u);
+        diff_tree = TES_tree.getDifferentiationTree();
+        TS_ASSERT(diff_tree_from_matrix->topologyTreeCompare(diff_tree));
+
+        /* The second tree reuses the cached distributions, the other one is
+         * computed in parallel from scratch: the values are the same, bit
+         * for bit. */
+        for (unsigned i=0; i<diff_tree->size(); i++)
+        {
+            TS_ASSERT_EQUALS(diff_tree->getNode(i)->getCellCycleLength(),
+                    diff_tree_from_matrix->getNode(i)->getCellCycleLength());
+            TS_ASSERT(diff_tree->getNode(i)->getStationaryDistribution()
+                    == diff_tree_from_matrix->getNode(i)->getStationaryDistribution());
+            TS_ASSERT(diff_tree->getNode(i)->getDifferentiationProbability()
+                    == diff_tree_from_matrix->getNode(i)->getDifferentiationProbability());
+        }
+        delete diff_tree;
+        delete diff_tree_from_matrix;
+
+        /* The thresholds 0.05 and 0.0500000001 split {0,1,2} into {0,1}
+         * and {2}, and then {0,1} into {0} and {1}. With a tolerance of
+         * 1e-6 they are merged, so the three TES are children of the root. */
+        std::vector<std::map<unsigned,double> > rows(3);
+        rows[0][0] = 0.8999999999;
+        rows[0][1] = 0.0500000001;
+        rows[0][2] = 0.05;
+        rows[1][0] = 0.0500000001;
+        rows[1][1] = 0.8999999999;
+        rows[1][2] = 0.05;
+        rows[2][0] = 0.05;
+        rows[2][2] = 0.95;
+        ThresholdErgodicSetDifferentiationTree close_thresholds_tree(rows, std::vector<unsigned>(3, 1));
+        TS_ASSERT_EQUALS(close_thresholds_tree.getThresholdTolerance(), 0.0);
+        diff_tree = close_thresholds_tree.getDifferentiationTree();
+        TS_ASSERT_EQUALS(diff_tree->size(), 5u);
+        delete diff_tree;
+        close_thresholds_tree.setThresholdTolerance(1e-6);
+        diff_tree = close_thresholds_tree.getDifferentiationTree();
+        TS_ASSERT_EQUALS(diff_tree->size(), 4u);
+        TS_ASSERT_EQUALS(diff_tree->getRoot()->getNumberOfChildren(), 3u);
+        TS_ASSERT_EQUALS(diff_tree->getNode(1)->getThreshold(), 0.0500000001);
+        delete diff_tree;
+        TS_ASSERT_THROWS_THIS(close_thresholds_tree.setThresholdTolerance(-1.0),
+                "The threshold tolerance must be >= 0.");
     }
 
     /*
@@ -0,0 +1,154 @@
+#ifndef TESTSAMPLINGATTRACTORFINDER_HPP_
+#define TESTSAMPLINGATTRACTORFINDER_HPP_
+
+/*
+ * = Testing the class {{{SamplingAttractorFinder}}} =
+ *
+ * == Introduction ==
+ *
+ * EMPTYLINE
+ *
+ * This class is used to test that the class {{{SamplingAttractorFinder}}},
+ * the attractor search for very large networks, is implemented correctly.
+ *
+ * == Including header files ==
+ * We begin by including the necessary header files.
+*/
+
+#include <cxxtest/TestSuite.h>
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+#include "RandomBooleanNetwork.hpp"
+#include "TruthTableNetwork.hpp"
+#include "SamplingAttractorFinder.hpp"
+#include "RandomNumberGenerator.hpp"
+
+/* The next header includes the Buddy library. */
+#include <bdd.h>
+//This test is always run sequentially (never in parallel)
+#include "FakePetscSetup.hpp"
+
+class TestSamplingAttractorFinder : public CxxTest::TestSuite
+{
+public:
+
+	/*
+	 * == Sampling the attractors of 'mammalian.cnet' ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * Every attractor found by sampling must be one of the attractors
+	 * found by the exact symbolic search, so there cannot be more of them,
+	 * and each one must have the length of one of the exact ones.
+	 */
+    void testSamplingSmallNetwork() throw (Exception)
+    {
+    	/* First of all we initialise Buddy. */
+        bdd_init(10000,1000);
+        try
+        {
+            RandomBooleanNetwork rbn("projects/CoGNaC/networks_samples/mammalian.cnet");
+            rbn.findAttractors();
+            std::vector<unsigned> exact_lengths = rbn.getAttractorLength();
+
+            TruthTableNetwork network(rbn);
+            SamplingAttractorFinder finder(network);
+            finder.findAttractors(2000, 10000, 1234);
+            TS_ASSERT_EQUALS(finder.getSamplesNumber(), 2000u);
+            TS_ASSERT_EQUALS(finder.getUnresolvedSamplesNumber(), 0u);
+            TS_ASSERT_LESS_THAN_EQUALS(finder.getAttractors().size(), exact_lengths.size());
+
+            unsigned hits = 0;
+            for (unsigned i=0; i<finder.getAttractors().size(); i++)
+            {
+                const SampledAttractor& attractor = finder.getAttractors()[i];
+                hits += attractor.hits;
+                TS_ASSERT(std::find(exact_lengths.begin(), exact_lengths.end(), attractor.length) != exact_lengths.end());
+                if (i > 0)
+                {
+                    TS_ASSERT_LESS_THAN_EQUALS(attractor.hits, finder.getAttractors()[i-1].hits);
+                }
+            }
+            TS_ASSERT_EQUALS(hits, 2000u);
+        }
+        catch (Exception& e)
+        {
+            TS_FAIL(e.GetMessage());
+            bdd_done();
+        }
+        /* We release Buddy. */
+        bdd_done();
+    }
+
+	/*
+	 * == Sampling the attractors of a large critical network ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * We build, from explicit random truth tables, a network with 1000
+	 * nodes and two inputs per node, much larger than what the symbolic
+	 * search can handle. For every attractor found we check that its
+	 * states form a cycle and that the first one is the minimal one.
+	 * Two searches with the same seed must give the same attractors.
+	 */
+    void testSamplingLargeNetwork() throw (Exception)
+    {
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        p_gen->Reseed(3);
+        unsigned nodes_number = 1000;
+        std::vector<std::vector<unsigned> > inputs(nodes_number);
+        std::vector<std::vector<uint64_t> > truth_tables(nodes_number, std::vector<uint64_t>(1, 0));
+        for (unsigned node=0; node<nodes_number; node++)
+        {
+            inputs[node].push_back(p_gen->randMod(nodes_number));
+            inputs[node].push_back(p_gen->randMod(nodes_number));
+            truth_tables[node][0] = p_gen->randMod(16);
+        }
+        TruthTableNetwork network(inputs, truth_tables);
+
+        SamplingAttractorFinder finder(network);
+        finder.findAttractors(200, 100000, 99);
+        TS_ASSERT_EQUALS(finder.getUnresolvedSamplesNumber(), 0u);
+        TS_ASSERT(!finder.getAttractors().empty());
+
+        unsigned words_per_state = network.getWordsPerState();
+        for (unsigned i=0; i<finder.getAttractors().size(); i++)
+        {
+            std::vector<uint64_t> states = finder.getAttractorStates(i);
+            unsigned length = finder.getAttractors()[i].length;
+            TS_ASSERT_EQUALS(states.size(), length * words_per_state);
+            std::vector<uint64_t> next(words_per_state);
+            network.update(&states[(length-1) * words_per_state], &next[0]);
+            TS_ASSERT(std::equal(next.begin(), next.end(), states.begin()));
+            for (unsigned j=1; j<length; j++)
+            {
+                TS_ASSERT(SamplingAttractorFinder::isStateLess(&states[0], &states[j * words_per_state], words_per_state));
+            }
+        }
+
+        SamplingAttractorFinder other_finder(network);
+        other_finder.findAttractors(200, 100000, 99);
+        TS_ASSERT_EQUALS(other_finder.getAttractors().size(), finder.getAttractors().size());
+        for (unsigned i=0; i<finder.getAttractors().size(); i++)
+        {
+            TS_ASSERT(other_finder.getAttractors()[i].minimalState == finder.getAttractors()[i].minimalState);
+            TS_ASSERT_EQUALS(other_finder.getAttractors()[i].hits, finder.getAttractors()[i].hits);
+        }
+
+        /* With a single step only the samples starting in a fixed point are
+         * resolved, the other ones are counted as unresolved. */
+        finder.findAttractors(10, 1, 5);
+        unsigned hits = 0;
+        for (unsigned i=0; i<finder.getAttractors().size(); i++)
+        {
+            TS_ASSERT_EQUALS(finder.getAttractors()[i].length, 1u);
+            hits += finder.getAttractors()[i].hits;
+        }
+        TS_ASSERT_EQUALS(hits + finder.getUnresolvedSamplesNumber(), 10u);
+    }
+};
+
+#endif /* TESTSAMPLINGATTRACTORFINDER_HPP_ */
@@ -0,0 +1,256 @@
+#ifndef TESTSATATTRACTORFINDER_HPP_
+#define TESTSATATTRACTORFINDER_HPP_
+
+/*
+ * = Testing the classes {{{SatSolver}}} and {{{SatAttractorFinder}}} =
+ *
+ * == Introduction ==
+ *
+ * EMPTYLINE
+ *
+ * This class is used to test that the incremental SAT solver and the
+ * bounded attractor search built on it are implemented correctly.
+ *
+ * == Including header files ==
+ * We begin by including the necessary header files.
+*/
+
+#include <cxxtest/TestSuite.h>
+
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <stdint.h>
+
+#include "RandomBooleanNetwork.hpp"
+#include "TruthTableNetwork.hpp"
+#include "SatSolver.hpp"
+#include "SatAttractorFinder.hpp"
+#include "RandomNumberGenerator.hpp"
+
+/* The next header includes the Buddy library. */
+#include <bdd.h>
+//This test is always run sequentially (never in parallel)
+#include "FakePetscSetup.hpp"
+
+class TestSatAttractorFinder : public CxxTest::TestSuite
+{
+public:
+
+	/*
+	 * == The SAT solver ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * Five pigeons do not fit in four holes, but they fit if a hole is
+	 * added. Assumptions only hold for one call, and the models of random
+	 * satisfiable formulas must satisfy every clause.
+	 */
+    void testSatSolver() throw (Exception)
+    {
+        /* Variable p*5+h+1: pigeon p is in hole h. */
+        SatSolver solver;
+        for (unsigned i=0; i<25; i++)
+        {
+            solver.newVariable();
+        }
+        for (int pigeon=0; pigeon<5; pigeon++)
+        {
+            std::vector<int> clause;
+            for (int hole=0; hole<5; hole++)
+            {
+                clause.push_back(pigeon*5 + hole + 1);
+            }
+            solver.addClause(clause);
+        }
+        for (int hole=0; hole<5; hole++)
+        {
+            for (int pigeon1=0; pigeon1<5; pigeon1++)
+            {
+                for (int pigeon2=pigeon1+1; pigeon2<5; pigeon2++)
+                {
+                    std::vector<int> clause;
+                    clause.push_back(-(pigeon1*5 + hole + 1));
+                    clause.push_back(-(pigeon2*5 + hole + 1));
+                    solver.addClause(clause);
+                }
+            }
+        }
+        std::vector<int> no_last_hole;
+        for (int pigeon=0; pigeon<5; pigeon++)
+        {
+            no_last_hole.push_back(-(pigeon*5 + 5));
+        }
+        TS_ASSERT(!solver.solve(no_last_hole));
+        TS_ASSERT(solver.solve());
+        for (int hole=0; hole<5; hole++)
+        {
+            unsigned pigeons = 0;
+            for (int pigeon=0; pigeon<5; pigeon++)
+            {
+                pigeons += solver.getModelValue(pigeon*5 + hole + 1);
+            }
+            TS_ASSERT_LESS_THAN_EQUALS(pigeons, 1u);
+        }
+        TS_ASSERT(!solver.addClause(std::vector<int>()));
+        TS_ASSERT(!solver.solve());
+
+        /* Random 3-SAT below the threshold (ratio 3), with a planted model. */
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        p_gen->Reseed(3);
+        SatSolver random_solver;
+        std::vector<bool> planted(200);
+        for (unsigned i=0; i<200; i++)
+        {
+            random_solver.newVariable();
+            planted[i] = p_gen->randMod(2);
+        }
+        std::vector<std::vector<int> > clauses;
+        while (clauses.size() < 600)
+        {
+            std::vector<int> clause;
+            bool satisfied = false;
+            for (unsigned j=0; j<3; j++)
+            {
+                unsigned variable = p_gen->randMod(200);
+                bool positive = p_gen->randMod(2);
+                satisfied = satisfied || positive == planted[variable];
+                clause.push_back(positive ? (int) variable + 1 : -((int) variable + 1));
+            }
+            if (!satisfied) continue;
+            clauses.push_back(clause);
+            random_solver.addClause(clause);
+        }
+        TS_ASSERT(random_solver.solve());
+        for (unsigned i=0; i<clauses.size(); i++)
+        {
+            bool satisfied = false;
+            for (unsigned j=0; j<3; j++)
+            {
+                satisfied = satisfied || random_solver.getModelValue(std::abs(clauses[i][j])) == (clauses[i][j] > 0);
+            }
+            TS_ASSERT(satisfied);
+        }
+    }
+
+	/*
+	 * == Attractors of 'fission_yeast.net' and 'mammalian.cnet' ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * The lengths of the attractors found by the SAT search must be the
+	 * ones found by the symbolic search, and every attractor must be a
+	 * cycle starting from its minimal state. The search must stop because
+	 * it is complete, well before the maximum bound.
+	 */
+    void testCuratedNetworks() throw (Exception)
+    {
+    	/* First of all we initialise Buddy. */
+        bdd_init(10000,1000);
+        try
+        {
+            std::vector<std::string> files;
+            files.push_back("projects/CoGNaC/networks_samples/fission_yeast.net");
+            files.push_back("projects/CoGNaC/networks_samples/mammalian.cnet");
+            for (unsigned f=0; f<files.size(); f++)
+            {
+                RandomBooleanNetwork rbn(files[f]);
+                rbn.findAttractors();
+                std::vector<unsigned> exact_lengths = rbn.getAttractorLength();
+
+                TruthTableNetwork network(rbn);
+                SatAttractorFinder finder(network);
+                finder.findAttractors(64);
+                std::vector<unsigned> lengths;
+                for (unsigned i=0; i<finder.getAttractorsNumber(); i++)
+                {
+                    lengths.push_back(finder.getAttractorLength(i));
+                    const std::vector<uint64_t>& r_states = finder.getAttractorStates(i);
+                    TS_ASSERT_EQUALS(r_states.size(), finder.getAttractorLength(i));
+                    uint64_t next = 0;
+                    network.update(&r_states.back(), &next);
+                    TS_ASSERT_EQUALS(next, r_states[0]);
+                    TS_ASSERT_EQUALS(*std::min_element(r_states.begin(), r_states.end()), r_states[0]);
+                }
+                std::sort(lengths.begin(), lengths.end());
+                std::sort(exact_lengths.begin(), exact_lengths.end());
+                TS_ASSERT(lengths == exact_lengths);
+                TS_ASSERT(finder.isComplete());
+                TS_ASSERT_LESS_THAN_EQUALS(finder.getSearchedLength(), 32u);
+            }
+        }
+        catch (Exception& e)
+        {
+            TS_FAIL(e.GetMessage());
+            bdd_done();
+        }
+        /* We release Buddy. */
+        bdd_done();
+    }
+
+	/*
+	 * == Thousands of genes ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * In a ring of 3000 nodes copying the previous one the states rotate,
+	 * so the attractors of length <= 4 are the 2 constant states, the
+	 * alternating one, 2 cycles of length 3 and 3 of length 4. We also look
+	 * for the fixed points of a random network with 3000 nodes and two
+	 * inputs per node, and check that they are fixed.
+	 */
+    void testLargeNetworks() throw (Exception)
+    {
+        unsigned nodes_number = 3000;
+        std::vector<std::vector<unsigned> > inputs(nodes_number);
+        std::vector<std::vector<uint64_t> > copy_tables(nodes_number, std::vector<uint64_t>(1, 0x2));
+        for (unsigned node=0; node<nodes_number; node++)
+        {
+            inputs[node].push_back((node + 1) % nodes_number);
+        }
+        TruthTableNetwork ring(inputs, copy_tables);
+        SatAttractorFinder ring_finder(ring);
+        ring_finder.findFixedPoints();
+        TS_ASSERT_EQUALS(ring_finder.getAttractorsNumber(), 2u);
+        ring_finder.findAttractors(4);
+        TS_ASSERT_EQUALS(ring_finder.getSearchedLength(), 4u);
+        std::multiset<unsigned> lengths;
+        for (unsigned i=0; i<ring_finder.getAttractorsNumber(); i++)
+        {
+            lengths.insert(ring_finder.getAttractorLength(i));
+        }
+        TS_ASSERT_EQUALS(lengths.size(), 8u);
+        TS_ASSERT_EQUALS(lengths.count(1), 2u);
+        TS_ASSERT_EQUALS(lengths.count(2), 1u);
+        TS_ASSERT_EQUALS(lengths.count(3), 2u);
+        TS_ASSERT_EQUALS(lengths.count(4), 3u);
+        TS_ASSERT(!ring_finder.isComplete());
+        TS_ASSERT_THROWS_THIS(ring_finder.findAttractors(0), "The maximum length must be greater than 0.");
+
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        p_gen->Reseed(7);
+        std::vector<std::vector<uint64_t> > truth_tables(nodes_number, std::vector<uint64_t>(1, 0));
+        for (unsigned node=0; node<nodes_number; node++)
+        {
+            inputs[node].assign(1, p_gen->randMod(nodes_number));
+            inputs[node].push_back(p_gen->randMod(nodes_number));
+            truth_tables[node][0] = p_gen->randMod(16);
+        }
+        TruthTableNetwork network(inputs, truth_tables);
+        SatAttractorFinder finder(network);
+        finder.findFixedPoints();
+        TS_ASSERT_EQUALS(finder.getSearchedLength(), 1u);
+        std::set<std::vector<uint64_t> > fixed_points;
+        std::vector<uint64_t> next(network.getWordsPerState());
+        for (unsigned i=0; i<finder.getAttractorsNumber(); i++)
+        {
+            const std::vector<uint64_t>& r_state = finder.getAttractorStates(i);
+            network.update(&r_state[0], &next[0]);
+            TS_ASSERT(next == r_state);
+            fixed_points.insert(r_state);
+        }
+        TS_ASSERT_EQUALS(fixed_points.size(), finder.getAttractorsNumber());
+    }
+};
+
+#endif /* TESTSATATTRACTORFINDER_HPP_ */
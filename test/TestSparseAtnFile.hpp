@@ -0,0 +1,131 @@
+#ifndef TESTSPARSEATNFILE_HPP_
+#define TESTSPARSEATNFILE_HPP_
+
+/*
+ * = Testing the class {{{SparseAtnFile}}} =
+ *
+ * == Introduction ==
+ *
+ * EMPTYLINE
+ *
+ * This class is used to test that the class {{{SparseAtnFile}}}, which
+ * reads and writes ATNs in sparse text (.atn) and binary (.atnb) files,
+ * is implemented correctly.
+ *
+ * == Including header files ==
+ * We begin by including the necessary header files.
+*/
+
+#include <cxxtest/TestSuite.h>
+
+#include <vector>
+#include <map>
+#include <fstream>
+
+#include "SparseAtnFile.hpp"
+#include "StochasticMatrix.hpp"
+#include "ThresholdErgodicSetDifferentiationTree.hpp"
+#include "OutputFileHandler.hpp"
+
+class TestSparseAtnFile : public CxxTest::TestSuite
+{
+public:
+
+	/*
+	 * == Writing and reading ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * The ATN of {{{graudenzi_matrix.dat}}} is saved in both sparse
+	 * formats and read again: the matrix, the lengths and the tree are the
+	 * same.
+	 */
+    void testRoundTrip()
+    {
+    	ThresholdErgodicSetDifferentiationTree TES_tree("projects/CoGNaC/networks_samples/graudenzi_matrix.dat");
+        TES_tree.printStochasticMatrixAndAttractorLengthsToSparseFile("networks_generated", "graudenzi_matrix.atn");
+        TES_tree.printStochasticMatrixAndAttractorLengthsToSparseFile("networks_generated", "graudenzi_matrix.atnb");
+        TS_ASSERT_THROWS_THIS(TES_tree.printStochasticMatrixAndAttractorLengthsToSparseFile("networks_generated", "graudenzi_matrix.txt"),
+                "File path not valid. It must terminate with '.atn' or '.atnb' extension.");
+
+        OutputFileHandler handler("networks_generated", false);
+        std::string directory = handler.GetOutputDirectoryFullPath();
+        ThresholdErgodicSetDifferentiationTree text_tree(directory + "graudenzi_matrix.atn");
+        ThresholdErgodicSetDifferentiationTree binary_tree(directory + "graudenzi_matrix.atnb");
+        std::vector<std::map<unsigned,double> > matrix = TES_tree.getStochasticMatrix().getMapMatrix();
+        TS_ASSERT(text_tree.getStochasticMatrix().getMapMatrix() == matrix);
+        TS_ASSERT(binary_tree.getStochasticMatrix().getMapMatrix() == matrix);
+        TS_ASSERT(text_tree.getAttractorLength() == TES_tree.getAttractorLength());
+        TS_ASSERT(binary_tree.getAttractorLength() == TES_tree.getAttractorLength());
+
+        DifferentiationTree* diff_tree = TES_tree.getDifferentiationTree();
+        DifferentiationTree* text_diff_tree = text_tree.getDifferentiationTree();
+        TS_ASSERT(text_diff_tree->topologyTreeCompare(diff_tree));
+        delete diff_tree;
+        delete text_diff_tree;
+    }
+
+	/*
+	 * == Text files ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * The entries of a text file can be in any order, but not repeated.
+	 * Malformed headers and numbers are errors, and so are values which
+	 * are not probabilities; the entries equal to 0 are dropped.
+	 */
+    void testTextFiles()
+    {
+        OutputFileHandler handler("networks_generated", false);
+        std::string directory = handler.GetOutputDirectoryFullPath();
+        out_stream p_file = handler.OpenOutputFile("unsorted.atn");
+        *p_file << "# two attractors\nattractors 2 entries 3\n3 1\n1 0 0.5\n0 0 1\n1 1 0.5\n";
+        p_file->close();
+        StochasticMatrix matrix;
+        std::vector<unsigned> attractor_length;
+        SparseAtnFile::read(directory + "unsorted.atn", matrix, attractor_length);
+        TS_ASSERT_EQUALS(matrix.getSize(), 2u);
+        TS_ASSERT_EQUALS(matrix.getNonZerosNumber(), 3u);
+        TS_ASSERT_EQUALS(matrix.getMapMatrix()[1][0], 0.5);
+        TS_ASSERT_EQUALS(attractor_length[0], 3u);
+
+        p_file = handler.OpenOutputFile("repeated.atn");
+        *p_file << "attractors 2 entries 2\n1 1\n1 0 0.5\n1 0 0.5\n";
+        p_file->close();
+        TS_ASSERT_THROWS_THIS(SparseAtnFile::read(directory + "repeated.atn", matrix, attractor_length),
+                "Error reading the file.");
+        TS_ASSERT_THROWS_THIS(SparseAtnFile::read(directory + "missing.atn", matrix, attractor_length),
+                "Not able to open the file.");
+
+        /* Counts which do not fit in the file are rejected before the
+         * allocation, and so are numbers too long to be read. */
+        p_file = handler.OpenOutputFile("huge.atn");
+        *p_file << "attractors 4000000000 entries 1\n1\n0 0 1\n";
+        p_file->close();
+        TS_ASSERT_THROWS_THIS(SparseAtnFile::read(directory + "huge.atn", matrix, attractor_length),
+                "Error reading the file.");
+        p_file = handler.OpenOutputFile("long_value.atn");
+        *p_file << "attractors 2 entries 2\n1 1\n0 0 0." << std::string(61, '0') << "1 1 0.5\n";
+        p_file->close();
+        TS_ASSERT_THROWS_THIS(SparseAtnFile::read(directory + "long_value.atn", matrix, attractor_length),
+                "Error reading the file.");
+
+        const char* p_values[] = {"nan", "inf", "-0.5", "1.5"};
+        for (unsigned i=0; i<4; i++)
+        {
+            p_file = handler.OpenOutputFile("bad_value.atn");
+            *p_file << "attractors 2 entries 2\n1 1\n0 0 " << p_values[i] << "\n1 1 1\n";
+            p_file->close();
+            TS_ASSERT_THROWS_THIS(SparseAtnFile::read(directory + "bad_value.atn", matrix, attractor_length),
+                    "Error reading the file.");
+        }
+        p_file = handler.OpenOutputFile("zero.atn");
+        *p_file << "attractors 2 entries 3\n1 1\n0 0 1\n0 1 0\n1 1 1\n";
+        p_file->close();
+        SparseAtnFile::read(directory + "zero.atn", matrix, attractor_length);
+        TS_ASSERT_EQUALS(matrix.getNonZerosNumber(), 2u);
+        TS_ASSERT_EQUALS(matrix.getMapMatrix()[0].count(1), 0u);
+    }
+};
+
+#endif /* TESTSPARSEATNFILE_HPP_ */
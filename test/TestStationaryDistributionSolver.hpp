@@ -0,0 +1,185 @@
+#ifndef TESTSTATIONARYDISTRIBUTIONSOLVER_HPP_
+#define TESTSTATIONARYDISTRIBUTIONSOLVER_HPP_
+
+/*
+ * = Testing the class {{{StationaryDistributionSolver}}} =
+ *
+ * == Introduction ==
+ *
+ * EMPTYLINE
+ *
+ * This class is used to test that the class {{{StationaryDistributionSolver}}},
+ * which finds the stationary distribution of a component of a pruned ATN
+ * by GTH elimination or Gauss-Seidel sweeps, is implemented correctly.
+ *
+ * == Including header files ==
+ * We begin by including the necessary header files.
+*/
+
+#include <cxxtest/TestSuite.h>
+
+#include <vector>
+#include <map>
+#include <cmath>
+
+#include "StationaryDistributionSolver.hpp"
+#include "StochasticMatrix.hpp"
+#include "RandomNumberGenerator.hpp"
+
+class TestStationaryDistributionSolver : public CxxTest::TestSuite
+{
+public:
+
+	/*
+	 * == A two-state chain ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * The chain 0 -> 1 with probability 0.3 and 1 -> 0 with probability
+	 * 0.1 has stationary distribution (0.25, 0.75). State 2 is not in the
+	 * component, so the entry towards it is ignored; a periodic chain is
+	 * solved as well.
+	 */
+    void testTwoStates()
+    {
+        std::vector<std::map<unsigned,double> > rows(3);
+        rows[0][0] = 0.7;
+        rows[0][1] = 0.3;
+        rows[1][0] = 0.1;
+        rows[1][1] = 0.8;
+        rows[1][2] = 0.1;
+        rows[2][2] = 1.0;
+        StochasticMatrix matrix(rows);
+        StochasticMatrixView view(matrix);
+        std::vector<unsigned> component;
+        component.push_back(0);
+        component.push_back(1);
+
+        StationaryDistributionSolver direct_solver;
+        StationaryDistributionSolver iterative_solver(0);
+        std::vector<double> direct = direct_solver.solve(view, component);
+        std::vector<double> iterative = iterative_solver.solve(view, component);
+        TS_ASSERT_EQUALS(direct.size(), 2u);
+        TS_ASSERT_DELTA(direct[0], 0.25, 1e-12);
+        TS_ASSERT_DELTA(direct[0] + direct[1], 1.0, 1e-15);
+        TS_ASSERT_DELTA(iterative[0], direct[0], 1e-10);
+        TS_ASSERT_DELTA(iterative[1], direct[1], 1e-10);
+
+        std::vector<double> single = direct_solver.solve(view, std::vector<unsigned>(1, 2));
+        TS_ASSERT_EQUALS(single.size(), 1u);
+        TS_ASSERT_EQUALS(single[0], 1.0);
+
+        std::vector<std::map<unsigned,double> > periodic_rows(2);
+        periodic_rows[0][1] = 1.0;
+        periodic_rows[1][0] = 1.0;
+        StochasticMatrix periodic_matrix(periodic_rows);
+        iterative = iterative_solver.solve(StochasticMatrixView(periodic_matrix), component);
+        TS_ASSERT_DELTA(iterative[0], 0.5, 1e-12);
+        TS_ASSERT_DELTA(iterative[1], 0.5, 1e-12);
+
+        TS_ASSERT_THROWS_THIS(StationaryDistributionSolver(10, 0.0),
+                "The tolerance and the maximum number of iterations must be greater than 0.");
+    }
+
+	/*
+	 * == Random components ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * On random irreducible pruned matrices the distribution must be
+	 * stationary (pi P = pi on the component), non-negative and the same
+	 * for the two methods. The last chain is larger than the direct size
+	 * limit and nearly decomposable, two blocks joined by entries of 1e-5,
+	 * so the Gauss-Seidel sweeps do not converge and GTH elimination is
+	 * used instead.
+	 */
+    void testRandomComponents()
+    {
+        RandomNumberGenerator::Instance()->Reseed(0);
+        StationaryDistributionSolver direct_solver;
+        StationaryDistributionSolver iterative_solver(0);
+        for (unsigned trial=0; trial<20; trial++)
+        {
+            unsigned size = 2 + RandomNumberGenerator::Instance()->randMod(60);
+            std::vector<std::map<unsigned,double> > rows(size);
+            for (unsigned i=0; i<size; i++)
+            {
+                /* A cycle makes the chain irreducible; the small entries are pruned. */
+                rows[i][(i + 1) % size] = 1.0;
+                for (unsigned k=0; k<4; k++)
+                {
+                    rows[i][RandomNumberGenerator::Instance()->randMod(size)] += 0.5 * RandomNumberGenerator::Instance()->ranf();
+                }
+                rows[i][RandomNumberGenerator::Instance()->randMod(size)] += 0.001;
+            }
+            StochasticMatrix matrix(rows);
+            StochasticMatrixView view(matrix, 0.01);
+            std::vector<unsigned> component;
+            for (unsigned i=0; i<size; i++)
+            {
+                component.push_back(i);
+            }
+
+            std::vector<double> direct = direct_solver.solve(view, component);
+            std::vector<double> iterative = iterative_solver.solve(view, component);
+            std::vector<std::map<unsigned,double> > pruned_rows = view.getMapMatrix();
+            std::vector<double> product(size, 0.0);
+            double sum = 0.0;
+            for (unsigned i=0; i<size; i++)
+            {
+                TS_ASSERT_LESS_THAN_EQUALS(0.0, direct[i]);
+                TS_ASSERT_DELTA(iterative[i], direct[i], 1e-9);
+                sum += direct[i];
+                for (std::map<unsigned,double>::iterator it=pruned_rows[i].begin(); it!=pruned_rows[i].end(); ++it)
+                {
+                    product[it->first] += direct[i] * it->second;
+                }
+            }
+            TS_ASSERT_DELTA(sum, 1.0, 1e-12);
+            for (unsigned i=0; i<size; i++)
+            {
+                TS_ASSERT_DELTA(product[i], direct[i], 1e-12);
+            }
+        }
+
+        unsigned size = 300;
+        unsigned block_size = size / 2;
+        std::vector<std::map<unsigned,double> > rows(size);
+        for (unsigned i=0; i<size; i++)
+        {
+            unsigned block = i / block_size * block_size;
+            rows[i][block + (i + 1) % block_size] = 1.0;
+            for (unsigned k=0; k<4; k++)
+            {
+                rows[i][block + RandomNumberGenerator::Instance()->randMod(block_size)] += RandomNumberGenerator::Instance()->ranf();
+            }
+            rows[i][(block + block_size + RandomNumberGenerator::Instance()->randMod(block_size)) % size] += 1e-5;
+        }
+        StochasticMatrix matrix(rows);
+        StochasticMatrixView view(matrix, 0.0);
+        std::vector<unsigned> component;
+        for (unsigned i=0; i<size; i++)
+        {
+            component.push_back(i);
+        }
+        TS_ASSERT_LESS_THAN(direct_solver.getDirectSizeLimit(), size);
+        std::vector<double> distribution = direct_solver.solve(view, component);
+        std::vector<double> exact = StationaryDistributionSolver(size).solve(view, component);
+        std::vector<std::map<unsigned,double> > view_rows = view.getMapMatrix();
+        std::vector<double> product(size, 0.0);
+        for (unsigned i=0; i<size; i++)
+        {
+            TS_ASSERT_DELTA(distribution[i], exact[i], 1e-12 * exact[i]);
+            for (std::map<unsigned,double>::iterator it=view_rows[i].begin(); it!=view_rows[i].end(); ++it)
+            {
+                product[it->first] += exact[i] * it->second;
+            }
+        }
+        for (unsigned i=0; i<size; i++)
+        {
+            TS_ASSERT_DELTA(product[i], exact[i], 1e-12);
+        }
+    }
+};
+
+#endif /* TESTSTATIONARYDISTRIBUTIONSOLVER_HPP_ */
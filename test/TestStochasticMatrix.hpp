@@ -0,0 +1,121 @@
+#ifndef TESTSTOCHASTICMATRIX_HPP_
+#define TESTSTOCHASTICMATRIX_HPP_
+
+/*
+ * = Testing the classes {{{StochasticMatrix}}} and {{{StochasticMatrixView}}} =
+ *
+ * == Introduction ==
+ *
+ * EMPTYLINE
+ *
+ * This class is used to test that the class {{{StochasticMatrix}}}, the
+ * CSR representation of the ATN, and its pruned views are implemented
+ * correctly.
+ *
+ * == Including header files ==
+ * We begin by including the necessary header files.
+*/
+
+#include <cxxtest/TestSuite.h>
+
+#include <vector>
+#include <map>
+
+#include "StochasticMatrix.hpp"
+
+class TestStochasticMatrix : public CxxTest::TestSuite
+{
+public:
+
+	/*
+	 * == Construction and ownership ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * A matrix built from maps gives back the same maps. A matrix built
+	 * from CSR arrays takes them, and swap() moves the arrays between
+	 * matrices.
+	 */
+    void testConstruction()
+    {
+        std::vector<std::map<unsigned,double> > rows(3);
+        rows[0][0] = 0.5;
+        rows[0][2] = 0.5;
+        rows[1][1] = 1.0;
+        rows[2][0] = 0.25;
+        rows[2][1] = 0.75;
+        StochasticMatrix matrix(rows);
+        TS_ASSERT_EQUALS(matrix.getSize(), 3u);
+        TS_ASSERT_EQUALS(matrix.getNonZerosNumber(), 5u);
+        TS_ASSERT_EQUALS(matrix.getRowOffsets()[3], 5u);
+        TS_ASSERT_EQUALS(matrix.getColumns()[1], 2u);
+        TS_ASSERT(matrix.getMapMatrix() == rows);
+
+        std::vector<unsigned> row_offsets(3);
+        row_offsets[0] = 0;
+        row_offsets[1] = 1;
+        row_offsets[2] = 2;
+        std::vector<unsigned> columns(2, 1);
+        columns[1] = 0;
+        std::vector<double> values(2, 1.0);
+        StochasticMatrix csr_matrix(2, row_offsets, columns, values);
+        TS_ASSERT(row_offsets.empty() && columns.empty() && values.empty());
+        TS_ASSERT_EQUALS(csr_matrix.getSize(), 2u);
+
+        StochasticMatrix empty_matrix;
+        TS_ASSERT_EQUALS(empty_matrix.getSize(), 0u);
+        TS_ASSERT(empty_matrix.getValues() == NULL);
+        empty_matrix.swap(matrix);
+        TS_ASSERT_EQUALS(matrix.getSize(), 0u);
+        TS_ASSERT(empty_matrix.getMapMatrix() == rows);
+    }
+
+	/*
+	 * == Pruned views ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * The view at a threshold keeps the entries greater than the
+	 * threshold and normalises the rows; a row with no entries left is
+	 * reported.
+	 */
+    void testView()
+    {
+        std::vector<std::map<unsigned,double> > rows(2);
+        rows[0][0] = 0.2;
+        rows[0][1] = 0.3;
+        rows[0][2] = 0.5;
+        rows[1][0] = 0.1;
+        rows[1][2] = 0.9;
+        rows.resize(3);
+        rows[2][2] = 1.0;
+        StochasticMatrix matrix(rows);
+
+        StochasticMatrixView unpruned_view(matrix);
+        TS_ASSERT(unpruned_view.getMapMatrix() == rows);
+        TS_ASSERT(!unpruned_view.hasEmptyRow());
+
+        StochasticMatrixView view(matrix, 0.2);
+        TS_ASSERT_EQUALS(view.getSize(), 3u);
+        TS_ASSERT(!view.isKept(0));
+        TS_ASSERT(view.isKept(1));
+        TS_ASSERT_DELTA(view.getValue(0, 1), 0.375, 1e-12);
+        TS_ASSERT_DELTA(view.getValue(0, 2), 0.625, 1e-12);
+        TS_ASSERT_EQUALS(view.getValue(0, 0), 0.0);
+        TS_ASSERT_EQUALS(view.getValue(1, 4), 1.0);
+        double row_values[3];
+        view.getRowValues(0, row_values);
+        TS_ASSERT_EQUALS(row_values[0], 0.0);
+        TS_ASSERT_DELTA(row_values[1] + row_values[2], 1.0, 1e-12);
+        std::vector<std::map<unsigned,double> > pruned_rows = view.getMapMatrix();
+        TS_ASSERT_EQUALS(pruned_rows[0].size(), 2u);
+        TS_ASSERT_EQUALS(pruned_rows[1].size(), 1u);
+        TS_ASSERT(!view.hasEmptyRow());
+
+        StochasticMatrixView empty_row_view(matrix, 0.5);
+        TS_ASSERT(empty_row_view.hasEmptyRow());
+        TS_ASSERT(empty_row_view.getMapMatrix()[0].empty());
+    }
+};
+
+#endif /* TESTSTOCHASTICMATRIX_HPP_ */
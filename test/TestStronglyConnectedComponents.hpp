@@ -0,0 +1,173 @@
+#ifndef TESTSTRONGLYCONNECTEDCOMPONENTS_HPP_
+#define TESTSTRONGLYCONNECTEDCOMPONENTS_HPP_
+
+/*
+ * = Testing the classes {{{StronglyConnectedComponents}}} and {{{TerminalComponentSweep}}} =
+ *
+ * == Introduction ==
+ *
+ * EMPTYLINE
+ *
+ * This class is used to test that the class {{{StronglyConnectedComponents}}},
+ * which finds the strongly connected components of a graph in CSR form
+ * without recursion, and the class {{{TerminalComponentSweep}}}, which
+ * updates them while the edges are removed by weight, are implemented
+ * correctly.
+ *
+ * == Including header files ==
+ * We begin by including the necessary header files.
+*/
+
+#include <cxxtest/TestSuite.h>
+
+#include <vector>
+#include <set>
+
+#include "StronglyConnectedComponents.hpp"
+#include "TerminalComponentSweep.hpp"
+#include "RandomNumberGenerator.hpp"
+
+class TestStronglyConnectedComponents : public CxxTest::TestSuite
+{
+public:
+
+	/*
+	 * == Components of a small graph ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * The graph 0 <-> 1 -> 2 <-> 3, 4 -> 4, 5 -> 0 has the components
+	 * {0,1}, {2,3}, {4} and {5}; {2,3} and {4} are terminal. Pruning the
+	 * edges with weight <= 0.3 removes 3 -> 2 and splits {2,3}.
+	 */
+    void testSmallGraph()
+    {
+        unsigned row_offsets[] = {0, 1, 3, 4, 5, 6, 7};
+        unsigned columns[] = {1, 0, 2, 3, 2, 4, 0};
+        double weights[] = {1.0, 0.5, 0.5, 1.0, 0.2, 1.0, 1.0};
+
+        StronglyConnectedComponents components(6, row_offsets, columns);
+        TS_ASSERT_EQUALS(components.getComponentsNumber(), 4u);
+        const std::vector<unsigned>& ids = components.getComponents();
+        TS_ASSERT_EQUALS(ids[0], ids[1]);
+        TS_ASSERT_EQUALS(ids[2], ids[3]);
+        TS_ASSERT_DIFFERS(ids[0], ids[2]);
+        TS_ASSERT_DIFFERS(ids[4], ids[5]);
+
+        /* Components are closed after the components they reach. */
+        TS_ASSERT_LESS_THAN(ids[2], ids[1]);
+        TS_ASSERT_LESS_THAN(ids[0], ids[5]);
+
+        TS_ASSERT(!components.isTerminal(ids[0]));
+        TS_ASSERT(components.isTerminal(ids[2]));
+        TS_ASSERT(components.isTerminal(ids[4]));
+        TS_ASSERT(!components.isTerminal(ids[5]));
+        TS_ASSERT_EQUALS(components.getTerminalNodesNumber(), 3u);
+
+        std::set<std::set<unsigned> > terminal_components = components.getTerminalComponentSets();
+        TS_ASSERT_EQUALS(terminal_components.size(), 2u);
+        std::set<unsigned> component;
+        component.insert(2);
+        component.insert(3);
+        TS_ASSERT_EQUALS(terminal_components.count(component), 1u);
+        TS_ASSERT_EQUALS(components.getComponentSets().size(), 4u);
+
+        StronglyConnectedComponents pruned_components(6, row_offsets, columns, weights, 0.3);
+        TS_ASSERT_EQUALS(pruned_components.getComponentsNumber(), 5u);
+        TS_ASSERT(pruned_components.isTerminal(pruned_components.getComponents()[3]));
+        TS_ASSERT(!pruned_components.isTerminal(pruned_components.getComponents()[2]));
+        TS_ASSERT_EQUALS(pruned_components.getTerminalNodesNumber(), 2u);
+    }
+
+	/*
+	 * == Long cycle ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * A cycle of a million nodes is a single terminal component: the
+	 * depth of the search does not overflow the stack.
+	 */
+    void testLongCycle()
+    {
+        unsigned nodes_number = 1000000;
+        std::vector<unsigned> row_offsets(nodes_number + 1);
+        std::vector<unsigned> columns(nodes_number);
+        for (unsigned i=0; i<nodes_number; i++)
+        {
+            row_offsets[i] = i;
+            columns[i] = (i + 1) % nodes_number;
+        }
+        row_offsets[nodes_number] = nodes_number;
+
+        StronglyConnectedComponents components(nodes_number, &row_offsets[0], &columns[0]);
+        TS_ASSERT_EQUALS(components.getComponentsNumber(), 1u);
+        TS_ASSERT(components.isTerminal(0));
+        TS_ASSERT_EQUALS(components.getTerminalNodesNumber(), nodes_number);
+    }
+
+	/*
+	 * == Sweeping the thresholds ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * On random weighted graphs, after removing the edges up to every
+	 * weight the sweep must give the terminal components found from
+	 * scratch on the pruned graph, and count a change whenever they change.
+	 */
+    void testTerminalComponentSweep()
+    {
+        RandomNumberGenerator::Instance()->Reseed(0);
+        for (unsigned graph=0; graph<50; graph++)
+        {
+            unsigned nodes_number = 2 + RandomNumberGenerator::Instance()->randMod(30);
+            std::vector<unsigned> row_offsets(1, 0);
+            std::vector<unsigned> columns;
+            std::vector<double> weights;
+            std::set<double> thresholds;
+            for (unsigned node=0; node<nodes_number; node++)
+            {
+                for (unsigned target=0; target<nodes_number; target++)
+                {
+                    if (RandomNumberGenerator::Instance()->randMod(5) == 0)
+                    {
+                        columns.push_back(target);
+                        weights.push_back((1 + RandomNumberGenerator::Instance()->randMod(10)) / 10.0);
+                        thresholds.insert(weights.back());
+                    }
+                }
+                row_offsets.push_back(columns.size());
+            }
+            if (columns.empty()) continue;
+
+            TerminalComponentSweep sweep(nodes_number, &row_offsets[0], &columns[0], &weights[0]);
+            std::set<std::set<unsigned> > terminal_components = sweep.getTerminalComponentSets();
+            for (std::set<double>::iterator it=thresholds.begin(); it!=thresholds.end(); ++it)
+            {
+                StronglyConnectedComponents components(nodes_number, &row_offsets[0], &columns[0], &weights[0], *it);
+                unsigned terminal_changes = sweep.getTerminalChangesNumber();
+                sweep.removeEdges(*it);
+                TS_ASSERT(sweep.getTerminalComponentSets() == components.getTerminalComponentSets());
+                if (sweep.getTerminalComponentSets() != terminal_components)
+                {
+                    TS_ASSERT_LESS_THAN(terminal_changes, sweep.getTerminalChangesNumber());
+                }
+                terminal_components = sweep.getTerminalComponentSets();
+                TS_ASSERT_EQUALS(sweep.getTerminalNodesNumber(), components.getTerminalNodesNumber());
+                TS_ASSERT_EQUALS(sweep.getComponentsNumber(), components.getComponentsNumber());
+                bool empty_row = false;
+                for (unsigned node=0; node<nodes_number; node++)
+                {
+                    bool edges = false;
+                    for (unsigned edge=row_offsets[node]; edge<row_offsets[node+1]; edge++)
+                    {
+                        edges = edges || weights[edge] > *it;
+                    }
+                    empty_row = empty_row || !edges;
+                }
+                TS_ASSERT_EQUALS(sweep.hasEmptyRow(), empty_row);
+            }
+        }
+    }
+};
+
+#endif /* TESTSTRONGLYCONNECTEDCOMPONENTS_HPP_ */
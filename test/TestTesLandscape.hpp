@@ -0,0 +1,135 @@
+#ifndef TESTTESLANDSCAPE_HPP_
+#define TESTTESLANDSCAPE_HPP_
+
+/*
+ * = Testing the class {{{TesLandscape}}} =
+ *
+ * == Introduction ==
+ *
+ * EMPTYLINE
+ *
+ * This class is used to test that the class {{{TesLandscape}}}, which
+ * finds the threshold ergodic sets of an ATN at every threshold in one
+ * sweep, is implemented correctly.
+ *
+ * == Including header files ==
+ * We begin by including the necessary header files.
+*/
+
+#include <cxxtest/TestSuite.h>
+
+#include <vector>
+#include <map>
+#include <set>
+
+#include "TesLandscape.hpp"
+#include "StochasticMatrix.hpp"
+#include "StronglyConnectedComponents.hpp"
+#include "RandomNumberGenerator.hpp"
+
+class TestTesLandscape : public CxxTest::TestSuite
+{
+public:
+
+	/*
+	 * == A small ATN ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * The TES are {0,1,2} below 0.1, {0,1} and {2} up to 0.2, {0}, {1} and
+	 * {2} up to 0.7, where the rows of 0 and 1 become empty.
+	 */
+    void testSmallLandscape()
+    {
+        std::vector<std::map<unsigned,double> > rows(3);
+        rows[0][0] = 0.7;
+        rows[0][1] = 0.2;
+        rows[0][2] = 0.1;
+        rows[1][0] = 0.2;
+        rows[1][1] = 0.7;
+        rows[1][2] = 0.1;
+        rows[2][0] = 0.1;
+        rows[2][2] = 0.9;
+        StochasticMatrix matrix(rows);
+        TesLandscape landscape(matrix);
+
+        TS_ASSERT_EQUALS(landscape.getIntervalsNumber(), 4u);
+        TS_ASSERT_EQUALS(landscape.getIntervalStart(0), 0.0);
+        TS_ASSERT_EQUALS(landscape.getIntervalStart(1), 0.1);
+        TS_ASSERT_EQUALS(landscape.getIntervalStart(3), 0.7);
+        TS_ASSERT_EQUALS(landscape.getTesAt(-1.0).size(), 1u);
+        TS_ASSERT_EQUALS(landscape.getTesAt(0.05).size(), 1u);
+        TS_ASSERT_EQUALS(landscape.getTesAt(0.1).size(), 2u);
+        TS_ASSERT_EQUALS(landscape.getTesAt(0.15).size(), 2u);
+        TS_ASSERT_EQUALS(landscape.getTesAt(0.5).size(), 3u);
+        TS_ASSERT(landscape.getTesAt(0.8).empty());
+        TS_ASSERT_EQUALS(landscape.findInterval(0.15), 1u);
+
+        std::set<unsigned> tes;
+        tes.insert(0);
+        tes.insert(1);
+        TS_ASSERT_EQUALS(landscape.getTes(1).count(tes), 1u);
+
+        landscape.printToCsvFile("networks_generated", "tes_landscape.csv");
+        TS_ASSERT_THROWS_THIS(landscape.printToCsvFile("networks_generated", "tes_landscape.txt"),
+                "File path not valid. It must terminate with '.csv' extension.");
+    }
+
+	/*
+	 * == Random ATNs ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * At the values of random matrices and between them the TES must be
+	 * the terminal components of the pruned graph, if they cover all the
+	 * attractors and no row is empty.
+	 */
+    void testRandomLandscapes()
+    {
+        RandomNumberGenerator::Instance()->Reseed(0);
+        for (unsigned trial=0; trial<50; trial++)
+        {
+            unsigned size = 1 + RandomNumberGenerator::Instance()->randMod(25);
+            std::vector<std::map<unsigned,double> > rows(size);
+            for (unsigned i=0; i<size; i++)
+            {
+                for (unsigned k=0; k<3; k++)
+                {
+                    rows[i][RandomNumberGenerator::Instance()->randMod(size)] +=
+                            (1 + RandomNumberGenerator::Instance()->randMod(10)) / 10.0;
+                }
+            }
+            StochasticMatrix matrix(rows);
+            TesLandscape landscape(matrix);
+
+            std::vector<double> thresholds(matrix.getValues(), matrix.getValues() + matrix.getNonZerosNumber());
+            for (unsigned k=0; k<matrix.getNonZerosNumber(); k++)
+            {
+                thresholds.push_back(thresholds[k] - 0.05);
+            }
+            for (unsigned k=0; k<thresholds.size(); k++)
+            {
+                StronglyConnectedComponents components(size, matrix.getRowOffsets(), matrix.getColumns(),
+                        matrix.getValues(), thresholds[k]);
+                bool empty_row = false;
+                for (unsigned row=0; row<size; row++)
+                {
+                    bool kept = false;
+                    for (unsigned entry=matrix.getRowOffsets()[row]; entry<matrix.getRowOffsets()[row+1]; entry++)
+                    {
+                        kept = kept || matrix.getValues()[entry] > thresholds[k];
+                    }
+                    empty_row = empty_row || !kept;
+                }
+                std::set<std::set<unsigned> > tes;
+                if (!empty_row && components.getTerminalNodesNumber() == size)
+                {
+                    tes = components.getTerminalComponentSets();
+                }
+                TS_ASSERT(landscape.getTesAt(thresholds[k]) == tes);
+            }
+        }
+    }
+};
+
+#endif /* TESTTESLANDSCAPE_HPP_ */
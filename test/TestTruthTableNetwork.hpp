@@ -0,0 +1,195 @@
+#ifndef TESTTRUTHTABLENETWORK_HPP_
+#define TESTTRUTHTABLENETWORK_HPP_
+
+/*
+ * = Testing the class {{{TruthTableNetwork}}} =
+ *
+ * == Introduction ==
+ *
+ * EMPTYLINE
+ *
+ * This class is used to test that the class {{{TruthTableNetwork}}}, the
+ * explicit representation of a {{{RandomBooleanNetwork}}}, is implemented
+ * correctly.
+ *
+ * == Including header files ==
+ * We begin by including the necessary header files.
+*/
+
+#include <cxxtest/TestSuite.h>
+
+#include <vector>
+#include <stdint.h>
+
+#include "RandomBooleanNetwork.hpp"
+#include "TruthTableNetwork.hpp"
+#include "BitSlicedNetworkKernel.hpp"
+#include "RandomNumberGenerator.hpp"
+
+/* The next header includes the Buddy library. */
+#include <bdd.h>
+//This test is always run sequentially (never in parallel)
+#include "FakePetscSetup.hpp"
+
+class TestTruthTableNetwork : public CxxTest::TestSuite
+{
+public:
+
+	/*
+	 * == Building a network from explicit truth tables ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * We build a three-node network where node 0 is the NOT of node 2,
+	 * node 1 is the AND of nodes 0 and 2, and node 2 copies node 1.
+	 */
+    void testExplicitTruthTables()
+    {
+        std::vector<std::vector<unsigned> > inputs(3);
+        std::vector<std::vector<uint64_t> > truth_tables(3, std::vector<uint64_t>(1, 0));
+        inputs[0].push_back(2);
+        truth_tables[0][0] = 0x1; // row 0 (node 2 = 0) -> 1
+        inputs[1].push_back(0);
+        inputs[1].push_back(2);
+        truth_tables[1][0] = 0x8; // row 3 (both inputs = 1) -> 1
+        inputs[2].push_back(1);
+        truth_tables[2][0] = 0x2; // row 1 (node 1 = 1) -> 1
+
+        TruthTableNetwork network(inputs, truth_tables);
+        TS_ASSERT_EQUALS(network.getNodesNumber(), 3u);
+        TS_ASSERT_EQUALS(network.getWordsPerState(), 1u);
+        TS_ASSERT_EQUALS(network.getInputsNumber(1), 2u);
+
+        /* From 110 (node 0 and node 1 on) the next state is 101. */
+        uint64_t current = 0x3;
+        uint64_t next = 0;
+        network.update(&current, &next);
+        TS_ASSERT_EQUALS(next, (uint64_t) 0x5);
+        TS_ASSERT(TruthTableNetwork::getNodeValue(&next, 2));
+        TS_ASSERT(!network.evaluateNode(0, &next));
+
+        /* A truth table with a wrong number of words is refused. */
+        truth_tables[1].push_back(0);
+        TS_ASSERT_THROWS_THIS(TruthTableNetwork wrong_network(inputs, truth_tables),
+                "Truth table of node 2 has a wrong size.");
+    }
+
+	/*
+	 * == Building a network from a {{{RandomBooleanNetwork}}} ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * The 'fission_yeast.net' network has 13 fixed-point attractors, so
+	 * exactly 13 of its 1024 states are mapped to themselves.
+	 */
+    void testTruthTablesFromNetwork() throw (Exception)
+    {
+    	/* First of all we initialise Buddy. */
+        bdd_init(10000,1000);
+        try
+        {
+            RandomBooleanNetwork rbn("projects/CoGNaC/networks_samples/fission_yeast.net");
+            TruthTableNetwork network(rbn);
+            TS_ASSERT_EQUALS(network.getNodesNumber(), 10u);
+
+            unsigned fixed_points = 0;
+            for (uint64_t state=0; state<1024; state++)
+            {
+                uint64_t next = 0;
+                network.update(&state, &next);
+                if (next == state) fixed_points++;
+            }
+            TS_ASSERT_EQUALS(fixed_points, 13u);
+        }
+        catch (Exception& e)
+        {
+            TS_FAIL(e.GetMessage());
+            bdd_done();
+        }
+        /* We release Buddy. */
+        bdd_done();
+    }
+
+	/*
+	 * == Bit-sliced update of many trajectories ==
+	 *
+	 * EMPTYLINE
+	 *
+	 * We build a random network of 70 nodes (two words per packed state)
+	 * with up to ten inputs per node, so that both the multiplexer tree and
+	 * the fallback for large nodes are used. For every instruction set
+	 * supported by the CPU, 1000 random states are updated with the
+	 * {{{BitSlicedNetworkKernel}}} and compared with {{{TruthTableNetwork}}}.
+	 */
+    void testBitSlicedKernel()
+    {
+        RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+        p_gen->Reseed(7);
+        unsigned nodes_number = 70;
+        std::vector<std::vector<unsigned> > inputs(nodes_number);
+        std::vector<std::vector<uint64_t> > truth_tables(nodes_number);
+        for (unsigned node=0; node<nodes_number; node++)
+        {
+            unsigned inputs_number = p_gen->randMod(11);
+            for (unsigned j=0; j<inputs_number; j++)
+            {
+                inputs[node].push_back(p_gen->randMod(nodes_number));
+            }
+            unsigned rows = 1u << inputs_number;
+            truth_tables[node].assign(rows > 64 ? rows / 64 : 1, 0);
+            for (unsigned row=0; row<rows; row++)
+            {
+                if (p_gen->ranf() > 0.5)
+                {
+                    truth_tables[node][row >> 6] |= ((uint64_t) 1) << (row & 63);
+                }
+            }
+        }
+        TruthTableNetwork network(inputs, truth_tables);
+        BitSlicedNetworkKernel kernel(network);
+        TS_ASSERT_EQUALS(kernel.getInstructionSet(), BitSlicedNetworkKernel::getBestInstructionSet());
+
+        unsigned states_number = 1000;
+        unsigned words_per_state = network.getWordsPerState();
+        unsigned words_per_node = BitSlicedNetworkKernel::getWordsPerNode(states_number);
+        TS_ASSERT_EQUALS(words_per_node, 16u);
+
+        std::vector<uint64_t> states(states_number * words_per_state, 0);
+        std::vector<uint64_t> expected(states_number * words_per_state, 0);
+        for (unsigned state=0; state<states_number; state++)
+        {
+            for (unsigned node=0; node<nodes_number; node++)
+            {
+                TruthTableNetwork::setNodeValue(&states[state * words_per_state], node, p_gen->ranf() > 0.5);
+            }
+            network.update(&states[state * words_per_state], &expected[state * words_per_state]);
+        }
+
+        std::vector<uint64_t> current(nodes_number * words_per_node);
+        std::vector<uint64_t> next(nodes_number * words_per_node);
+        std::vector<uint64_t> result(states_number * words_per_state);
+        BitSlicedNetworkKernel::sliceStates(&states[0], states_number, words_per_state, nodes_number, &current[0], words_per_node);
+        BitSlicedNetworkKernel::unsliceStates(&current[0], words_per_node, nodes_number, &result[0], states_number, words_per_state);
+        TS_ASSERT(result == states);
+
+        for (unsigned set=BitSlicedNetworkKernel::SCALAR; set<=BitSlicedNetworkKernel::AVX512; set++)
+        {
+            BitSlicedNetworkKernel::InstructionSet instruction_set = (BitSlicedNetworkKernel::InstructionSet) set;
+            if (!BitSlicedNetworkKernel::isInstructionSetSupported(instruction_set))
+            {
+                TS_ASSERT_THROWS_ANYTHING(kernel.setInstructionSet(instruction_set));
+                continue;
+            }
+            kernel.setInstructionSet(instruction_set);
+            kernel.update(&current[0], &next[0], words_per_node);
+            BitSlicedNetworkKernel::unsliceStates(&next[0], words_per_node, nodes_number, &result[0], states_number, words_per_state);
+            TS_ASSERT(result == expected);
+        }
+
+        /* The number of words per node must be a multiple of the block. */
+        TS_ASSERT_THROWS_THIS(kernel.update(&current[0], &next[0], 4),
+                "The number of words per node must be a multiple of the block size.");
+    }
+};
+
+#endif /* TESTTRUTHTABLENETWORK_HPP_ */